@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+ * Minimal microbenchmark harness for sim_benchmarks.
+ *
+ * Each benchmark body runs `iters` operations per call. The iteration
+ * count is calibrated so that one repetition takes at least min_time_ms,
+ * then the body is repeated `reps` times and the per-op times are summarized
+ * by median, median absolute deviation and minimum, which are stable
+ * against the odd preempted repetition.
+ */
+struct BenchOptions {
+  std::string filter;
+  size_t reps = 15;
+  double min_time_ms = 20.0;
+};
+
+struct BenchResult {
+  std::string name;
+  double median_ns = 0.0;
+  double mad_ns = 0.0;
+  double min_ns = 0.0;
+  uint64_t iters = 0;
+};
+
+// Keeps the compiler from discarding a computed value
+template <typename T> inline void do_not_optimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+class BenchRunner {
+public:
+  explicit BenchRunner(const BenchOptions &options) : options(options) {
+    printf("%-40s %12s %10s %12s %12s\n", "Benchmark", "ns/op", "+/- MAD", "min ns/op",
+           "iters/rep");
+  }
+
+  /*
+   * body(iters) must perform `iters` operations
+   */
+  void run(const std::string &name, const std::function<void(uint64_t)> &body) {
+    if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {
+      return;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto time_ns = [&](uint64_t iters) {
+      auto start = Clock::now();
+      body(iters);
+      return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    };
+
+    // Calibrate (this also warms caches and the branch predictors)
+    uint64_t iters = 1;
+    while (time_ns(iters) < options.min_time_ms * 1e6 && iters < (1ULL << 40)) {
+      iters *= 2;
+    }
+
+    std::vector<double> samples;
+    for (size_t r = 0; r < options.reps; r++) {
+      samples.push_back(time_ns(iters) / iters);
+    }
+    std::sort(samples.begin(), samples.end());
+    BenchResult result;
+    result.name = name;
+    result.iters = iters;
+    result.min_ns = samples.front();
+    result.median_ns = median(samples);
+    std::vector<double> deviations;
+    for (double s : samples) {
+      deviations.push_back(std::fabs(s - result.median_ns));
+    }
+    std::sort(deviations.begin(), deviations.end());
+    result.mad_ns = median(deviations);
+
+    printf("%-40s %12.2f %10.2f %12.2f %12llu\n", name.c_str(), result.median_ns, result.mad_ns,
+           result.min_ns, static_cast<unsigned long long>(iters));
+    fflush(stdout);
+    results.push_back(result);
+  }
+
+  const std::vector<BenchResult> &get_results() const { return results; }
+
+private:
+  static double median(const std::vector<double> &sorted) {
+    size_t n = sorted.size();
+    if (n == 0) return 0.0;
+    return n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+  }
+
+  BenchOptions options;
+  std::vector<BenchResult> results;
+};
@@ -0,0 +1,177 @@
+#include "bench.hpp"
+#include "disassembler/llvm_disasm.hpp"
+#include "gpu/pipeline_warp_scheduler.hpp"
+#include "gpu/register_file.hpp"
+#include "mem/mem_coalesce.hpp"
+#include "mem/mem_data.hpp"
+#include "llvm/Support/TargetSelect.h"
+#include <cstring>
+#include <iostream>
+
+/*
+ * Microbenchmarks for the simulator's hot paths
+ *
+ * Usage: sim_benchmarks [filter] [--reps N] [--min-time-ms T]
+ */
+
+static constexpr uint64_t DRAM_BASE = 0x80000000;
+
+// Synthetic lane address patterns for one warp-wide 4-byte access
+static std::vector<uint64_t> lane_addresses(const std::string &pattern) {
+  std::vector<uint64_t> addrs(NUM_LANES);
+  uint32_t x = 0x2545F491;
+  for (size_t lane = 0; lane < NUM_LANES; lane++) {
+    if (pattern == "unit_stride") {
+      addrs[lane] = DRAM_BASE + 4 * lane;
+    } else if (pattern == "strided") {
+      addrs[lane] = DRAM_BASE + 128 * lane;
+    } else if (pattern == "random") {
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      addrs[lane] = DRAM_BASE + 4 * (x % (1 << 20));
+    } else {
+      addrs[lane] = DRAM_BASE + 0x40;  // broadcast
+    }
+  }
+  return addrs;
+}
+
+static void bench_coalescing(BenchRunner &runner) {
+  DataMemory memory;
+  CoalescingUnit cu(&memory);
+  for (const char *pattern : {"unit_stride", "strided", "random", "broadcast"}) {
+    std::vector<uint64_t> addrs = lane_addresses(pattern);
+    runner.run(std::string("coalesce/calculate_bursts/") + pattern, [&](uint64_t iters) {
+      for (uint64_t i = 0; i < iters; i++) {
+        do_not_optimize(cu.calculate_bursts(addrs, 4, false));
+      }
+    });
+    runner.run(std::string("coalesce/calculate_request_count/") + pattern, [&](uint64_t iters) {
+      for (uint64_t i = 0; i < iters; i++) {
+        do_not_optimize(cu.calculate_request_count(addrs, 4));
+      }
+    });
+  }
+}
+
+static void bench_data_memory(BenchRunner &runner) {
+  // A kernel-sized working set of 64K words
+  constexpr uint64_t WORDS = 1 << 16;
+  DataMemory memory;
+  for (uint64_t w = 0; w < WORDS; w++) {
+    memory.store(DRAM_BASE + 4 * w, 4, w);
+  }
+
+  runner.run("data_memory/load_word", [&](uint64_t iters) {
+    for (uint64_t i = 0; i < iters; i++) {
+      do_not_optimize(memory.load(DRAM_BASE + 4 * (i % WORDS), 4));
+    }
+  });
+  runner.run("data_memory/store_word", [&](uint64_t iters) {
+    for (uint64_t i = 0; i < iters; i++) {
+      memory.store(DRAM_BASE + 4 * (i % WORDS), 4, i);
+    }
+  });
+  runner.run("data_memory/load_byte", [&](uint64_t iters) {
+    for (uint64_t i = 0; i < iters; i++) {
+      do_not_optimize(memory.load(DRAM_BASE + (i % (4 * WORDS)), 1));
+    }
+  });
+}
+
+static void bench_register_file(BenchRunner &runner) {
+  // Registers are addressed by their LLVM register number
+  RegisterFile rf(NUM_REGISTERS, NUM_LANES);
+  runner.run("register_file/get_register", [&](uint64_t iters) {
+    for (uint64_t i = 0; i < iters; i++) {
+      do_not_optimize(rf.get_register(i % NUM_WARPS, i % NUM_LANES, llvm::RISCV::X1 + i % 31));
+    }
+  });
+  runner.run("register_file/set_register", [&](uint64_t iters) {
+    for (uint64_t i = 0; i < iters; i++) {
+      rf.set_register(i % NUM_WARPS, i % NUM_LANES, llvm::RISCV::X1 + i % 31,
+                      static_cast<int>(i));
+    }
+  });
+}
+
+static void bench_warp_scheduler(BenchRunner &runner) {
+  for (int ready : {1, 8, 64}) {
+    WarpScheduler scheduler(NUM_LANES, ready, DRAM_BASE, nullptr);
+    PipelineLatch input, output;
+    output.updated = false;
+    scheduler.set_latches(&input, &output);
+    scheduler.set_debug(false);
+
+    // One op is one scheduler cycle; issued warps come straight back
+    runner.run("warp_scheduler/execute/" + std::to_string(ready) + "_ready", [&](uint64_t iters) {
+      for (uint64_t i = 0; i < iters; i++) {
+        scheduler.execute();
+        if (output.updated) {
+          scheduler.insert_warp(output.warp);
+          output.updated = false;
+        }
+      }
+    });
+  }
+}
+
+static void bench_decode(BenchRunner &runner) {
+  LLVMDisassembler disasm("riscv64-unknown-elf", "generic-rv64", "+m,+a,+zfinx,+zbb");
+
+  // add, addi, lw, sw, beq, mul, slli, lui
+  const uint32_t words[] = {0x003100b3, 0x00108093, 0x00052283, 0x00552223,
+                            0x00208463, 0x025201b3, 0x00231313, 0x123453b7};
+  constexpr size_t COUNT = sizeof(words) / sizeof(words[0]);
+  uint8_t code[sizeof(words)];
+  memcpy(code, words, sizeof(words));
+
+  runner.run("decode/disasm_inst", [&](uint64_t iters) {
+    for (uint64_t i = 0; i < iters; i++) {
+      size_t offset = 4 * (i % COUNT);
+      llvm::ArrayRef<uint8_t> ref(code + offset, sizeof(code) - offset);
+      llvm::MCInst inst = disasm.disasm_inst(0, ref);
+      do_not_optimize(inst.getOpcode());
+    }
+  });
+  runner.run("decode/disasm_inst+getOpcodeName", [&](uint64_t iters) {
+    for (uint64_t i = 0; i < iters; i++) {
+      size_t offset = 4 * (i % COUNT);
+      llvm::ArrayRef<uint8_t> ref(code + offset, sizeof(code) - offset);
+      llvm::MCInst inst = disasm.disasm_inst(0, ref);
+      std::string name = disasm.getOpcodeName(inst.getOpcode());
+      do_not_optimize(name.size());
+    }
+  });
+}
+
+int main(int argc, char **argv) {
+  BenchOptions options;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--reps" && i + 1 < argc) {
+      options.reps = std::stoul(argv[++i]);
+    } else if (arg == "--min-time-ms" && i + 1 < argc) {
+      options.min_time_ms = std::stod(argv[++i]);
+    } else if (arg == "-h" || arg == "--help") {
+      std::cout << "Usage: sim_benchmarks [filter] [--reps N] [--min-time-ms T]" << std::endl;
+      return 0;
+    } else {
+      options.filter = arg;
+    }
+  }
+
+  LLVMInitializeRISCVTargetInfo();
+  LLVMInitializeRISCVTargetMC();
+  LLVMInitializeRISCVDisassembler();
+  Config::instance().setStatsOnly(true);
+
+  BenchRunner runner(options);
+  bench_coalescing(runner);
+  bench_data_memory(runner);
+  bench_register_file(runner);
+  bench_warp_scheduler(runner);
+  bench_decode(runner);
+  return 0;
+}
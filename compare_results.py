@@ -1,5 +1,19 @@
 #!/usr/bin/env python3
-"""Compare simulator results with SIMTight baseline."""
+"""Compare simulator results with SIMTight baseline.
+
+Usage:
+    python3 compare_results.py [REPORTS]
+
+REPORTS is a --stats-json report or a directory of them (run-samples.sh
+writes one per app to results/). Without it, the recorded results below
+are used for our simulator too.
+"""
+
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "python_utils"))
+from stats_report import read_stats_json
 
 data = [
     # (Kernel, SIMTight_Cycles, Our_Cycles, SIMTight_Instrs, Our_Instrs, SIMTight_Retries, Our_Retries, SIMTight_DRAM, Our_DRAM)
@@ -20,6 +34,23 @@ data = [
 ]
 
 
+if len(sys.argv) > 1:
+    # The SIMTight numbers are from each app's first kernel launch
+    ours = {
+        kernel.split("/", 1)[1][:-len(" (1)")]: stats
+        for kernel, stats in read_stats_json(sys.argv[1], expand_subkernels=True).items()
+        if kernel.endswith(" (1)")
+    }
+    missing = [row[0] for row in data if row[0] not in ours]
+    if missing:
+        print(f"No results for: {', '.join(missing)}", file=sys.stderr)
+    data = [
+        (name, sc, ours[name]["Cycles"], si, ours[name]["Instrs"],
+         sr, ours[name]["Retries"], sd, ours[name]["DRAMAccs"])
+        for (name, sc, _, si, _, sr, _, sd, _) in data if name in ours
+    ]
+
+
 def fmt_ratio(ours, baseline):
     """Format ratio as a percentage difference like '+12%' or '-5%'."""
     pct = (ours - baseline) / baseline * 100
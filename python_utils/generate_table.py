@@ -1,9 +1,13 @@
 #!/usr/bin/env python3
-"""Generate a LaTeX comparison table for any metric from trace logs."""
+"""Generate a LaTeX comparison table for any metric from trace logs.
+
+Simulator results may also be --stats-json reports (a .json file or a
+directory of them, as written by run-samples.sh).
+"""
 
 import argparse
 import sys
-from plot_stats import read_simtight_trace
+from plot_stats import read_simtight_trace, read_stats
 
 # InHouse alphabetical, then Samples alphabetical
 KERNEL_ORDER = [
@@ -32,7 +36,7 @@ def short_name(kernel):
 
 def generate_table(baseline_file, simulator_file, metric, label=None, caption=None):
     baseline = read_simtight_trace(baseline_file)
-    simulator = read_simtight_trace(simulator_file)
+    simulator = read_stats(simulator_file)
 
     if label is None:
         label = f"tab:{metric.lower()}"
@@ -83,8 +87,8 @@ def generate_table(baseline_file, simulator_file, metric, label=None, caption=No
 
 
 def generate_scheduler_table(fair_file, random_file, metric, label=None, caption=None):
-    fair = read_simtight_trace(fair_file)
-    random = read_simtight_trace(random_file)
+    fair = read_stats(fair_file)
+    random = read_stats(random_file)
 
     if label is None:
         label = f"tab:sched_{metric.lower()}"
@@ -141,14 +145,14 @@ def main():
     baseline_parser = subparsers.add_parser("baseline", help="Compare simulator vs SIMTight baseline")
     baseline_parser.add_argument("metric", choices=VALID_METRICS, help="Metric to compare")
     baseline_parser.add_argument("--baseline", default="trace_simtight.log", help="Baseline trace file")
-    baseline_parser.add_argument("--simulator", default="trace.log", help="Simulator trace file")
+    baseline_parser.add_argument("--simulator", default="trace.log", help="Simulator trace file or --stats-json reports")
     baseline_parser.add_argument("--label", help="LaTeX label (default: tab:<metric>)")
     baseline_parser.add_argument("--caption", help="Table caption")
 
     sched_parser = subparsers.add_parser("scheduler", help="Compare fair vs random warp scheduler")
     sched_parser.add_argument("metric", choices=VALID_METRICS, help="Metric to compare")
-    sched_parser.add_argument("--fair", default="trace.log", help="Fair scheduler trace file")
-    sched_parser.add_argument("--random", default="trace_random_scheduler.log", help="Random scheduler trace file")
+    sched_parser.add_argument("--fair", default="trace.log", help="Fair scheduler trace file or --stats-json reports")
+    sched_parser.add_argument("--random", default="trace_random_scheduler.log", help="Random scheduler trace file or --stats-json reports")
     sched_parser.add_argument("--label", help="LaTeX label (default: tab:sched_<metric>)")
     sched_parser.add_argument("--caption", help="Table caption")
 
@@ -1,6 +1,14 @@
+import csv
+import os
+import struct
+
 import plotly.graph_objects as go
 from plotly.subplots import make_subplots
 
+from stats_report import read_stats_json
+
+STATS_BINARY_MAGIC = b"RVGSTAT1"
+
 
 def _read_one_stat_block(f, first_line=None):
     """Read one stat block (Cycles through DRAMAccs), return (block_dict, last_line).
@@ -101,6 +109,13 @@ def read_simtight_trace(file, expand_subkernels=False):
     return data
 
 
+def read_stats(path, expand_subkernels=False):
+    """Read simulator results from --stats-json reports, or a stdout log."""
+    if os.path.isdir(path) or path.endswith(".json"):
+        return read_stats_json(path, expand_subkernels)
+    return read_simtight_trace(path, expand_subkernels)
+
+
 def _bar_fig(kernels, mine_vals, simtight_vals, ylabel, title):
     """Build a grouped bar chart comparing Mine vs SIMTight."""
     fig = go.Figure(
@@ -297,6 +312,56 @@ def plot_single_kernel(data, simtight, kernel_name, metric=None):
     fig.show()
 
 
+def read_stats_samples(file):
+    """Read a --stats-interval file (CSV or binary) into a list of row dicts."""
+    with open(file, "rb") as f:
+        if f.read(len(STATS_BINARY_MAGIC)) == STATS_BINARY_MAGIC:
+            (num_columns,) = struct.unpack("<I", f.read(4))
+            columns = []
+            for _ in range(num_columns):
+                columns.append(f.read(f.read(1)[0]).decode())
+            row_fmt = "<" + "d" * num_columns
+            row_size = struct.calcsize(row_fmt)
+            rows = []
+            while True:
+                raw = f.read(row_size)
+                if len(raw) < row_size:
+                    break
+                rows.append(dict(zip(columns, struct.unpack(row_fmt, raw))))
+            return rows
+
+    with open(file, newline="") as f:
+        return [{k: float(v) for k, v in row.items()} for row in csv.DictReader(f)]
+
+
+def plot_stats_timeseries(rows, title="GPU counters over time"):
+    """Plot IPC, occupancy and memory pressure per sample, one trace per launch."""
+    metrics = [
+        ("ipc", "IPC"),
+        ("active_lanes", "Active lanes / issue"),
+        ("dram_inflight", "DRAM inflight"),
+        ("cu_queue_depth", "CU queue depth"),
+        ("suspended_warps", "Suspended warps"),
+        ("barrier_warps", "Barrier warps"),
+    ]
+    fig = make_subplots(rows=len(metrics), cols=1, shared_xaxes=True,
+                        subplot_titles=[label for _, label in metrics])
+    launches = sorted({int(row["launch"]) for row in rows})
+    for launch in launches:
+        launch_rows = [row for row in rows if int(row["launch"]) == launch]
+        cycles = [row["cycle"] for row in launch_rows]
+        for idx, (key, _) in enumerate(metrics):
+            fig.add_trace(
+                go.Scatter(x=cycles, y=[row[key] for row in launch_rows],
+                           name=f"Launch {launch}", legendgroup=str(launch),
+                           showlegend=(idx == 0)),
+                row=idx + 1, col=1,
+            )
+    fig.update_xaxes(title_text="GPU cycle", row=len(metrics), col=1)
+    fig.update_layout(title_text=title, height=200 * len(metrics))
+    fig.show()
+
+
 if __name__ == "__main__":
     data = read_simtight_trace("trace_random_scheduler.log")
     simtight = read_simtight_trace("trace.log")
@@ -311,3 +376,6 @@ if __name__ == "__main__":
     # data_exp = read_simtight_trace("trace.log", expand_subkernels=True)
     # simtight_exp = read_simtight_trace("trace_simtight.log", expand_subkernels=True)
     # plot_gpu_cycles(data_exp, simtight_exp)  # BitonicSortLarge (1), (2), (3) as separate bars
+
+    # Phase behaviour from a --stats-interval run:
+    # plot_stats_timeseries(read_stats_samples("stats.csv"), "Samples/BitonicSortLarge")
@@ -0,0 +1,48 @@
+"""Readers for the simulator's --stats-json per-launch reports."""
+
+import glob
+import json
+import os
+
+
+def _kernel_name(program):
+    """Samples/VecAdd/app.elf -> Samples/VecAdd"""
+    parts = os.path.normpath(program).split(os.sep)
+    return "/".join(parts[-3:-1]) if len(parts) >= 3 else parts[0]
+
+
+def read_stats_json(path, expand_subkernels=False):
+    """Read --stats-json reports into the same dict as read_simtight_trace.
+
+    path is a report file or a directory of them. Launches of one program
+    are summed unless expand_subkernels is set, in which case each launch
+    gets its own "<kernel> (<n>)" entry. Reports of different simulator
+    configurations must not be mixed, which the config fingerprint checks.
+    """
+    files = sorted(glob.glob(os.path.join(path, "*.json"))) if os.path.isdir(path) else [path]
+    data = {}
+    fingerprint = None
+    for file in files:
+        with open(file) as f:
+            report = json.load(f)
+        if fingerprint is None:
+            fingerprint = report["config_fingerprint"]
+        elif report["config_fingerprint"] != fingerprint:
+            raise ValueError(f"{file}: config fingerprint {report['config_fingerprint']} "
+                             f"differs from {fingerprint}")
+
+        kernel_base = _kernel_name(report["program"])
+        for launch in report["launches"]:
+            kernel = f"{kernel_base} ({launch['index'] + 1})" if expand_subkernels else kernel_base
+            entry = data.setdefault(kernel, {
+                "Cycles": 0, "Instrs": 0, "Susps": 0, "Retries": 0, "DRAMAccs": 0,
+                "WallTime_ms": 0,
+            })
+            entry["Cycles"] += launch["cycles"]
+            entry["Instrs"] += launch["instrs"]
+            entry["Susps"] += launch["susps"]
+            entry["Retries"] += launch["retries"]
+            entry["DRAMAccs"] += launch["dram_accs"]
+            entry["WallTime_ms"] += int(launch["wall_time_ms"])
+            entry["IPC"] = float(entry["Instrs"]) / entry["Cycles"] if entry["Cycles"] else 0.0
+    return data
@@ -19,11 +19,12 @@ APPS=(
 )
 
 make
+mkdir -p results
 
 for APP in ${APPS[@]}; do
     echo "Running kernel: $APP"
     START_NS=$(date +%s%N)
-    ./build/RISCVGpuSim $APP/app.elf -s --warp-scheduler=random
+    ./build/RISCVGpuSim $APP/app.elf -s --warp-scheduler=random --stats-json=results/${APP//\//_}.json
     END_NS=$(date +%s%N)
     ELAPSED_MS=$(( (END_NS - START_NS) / 1000000 ))
     echo "WallTime_ms: $ELAPSED_MS"
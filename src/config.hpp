@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 
 // GPU Simulator Configuration - Copied/derived from SIMTight defaults in SIMTight Config.h
 constexpr size_t DRAM_BEAT_BYTES = 64;
@@ -11,6 +12,15 @@ constexpr size_t SIM_DRAM_RESP_OVERHEAD = 8;
 constexpr size_t SIM_MUL_LATENCY = 3;
 constexpr size_t SIM_DIV_LATENCY = 32;
 constexpr size_t SIM_REM_LATENCY = 32;
+
+// Zfinx single-precision FPU. FDIV and FSQRT are iterative, the rest pipelined.
+constexpr size_t SIM_FADD_LATENCY = 4;   // FADD, FSUB, FMIN, FMAX
+constexpr size_t SIM_FMUL_LATENCY = 4;
+constexpr size_t SIM_FMA_LATENCY = 5;    // FMADD, FMSUB, FNMADD, FNMSUB
+constexpr size_t SIM_FCMP_LATENCY = 2;   // FEQ, FLT, FLE, FSGNJ*, FCLASS
+constexpr size_t SIM_FCVT_LATENCY = 2;
+constexpr size_t SIM_FDIV_LATENCY = 16;
+constexpr size_t SIM_FSQRT_LATENCY = 16;
 constexpr size_t MEM_REQ_QUEUE_CAPACITY = 32;
 
 constexpr size_t SIM_SHARED_SRAM_BASE = 0xBFFF0000;
@@ -32,7 +42,90 @@ constexpr size_t NUM_REGISTERS = 32;
 // For my warp scheduling extensibility verification
 enum WarpSchedulerConfig {
   BASELINE,
-  RANDOM
+  RANDOM,
+  GTO,        // Greedy-then-oldest
+  TWO_LEVEL,  // Active pool plus pending pool
+  LRR         // Loose round-robin
+};
+
+// Name used on the command line (--warp-scheduler) and in stats reports
+inline const char *warp_scheduler_name(WarpSchedulerConfig scheduler) {
+  switch (scheduler) {
+  case RANDOM: return "random";
+  case GTO: return "gto";
+  case TWO_LEVEL: return "two-level";
+  case LRR: return "lrr";
+  default: return "baseline";
+  }
+}
+
+// How diverged lanes of a warp find each other again
+enum ReconvergenceConfig {
+  RECONVERGE_NESTING,  // NoCL push/pop nesting levels, as in SIMTight
+  RECONVERGE_IPDOM     // Immediate post-dominator stack
+};
+
+// What a store does in the L1 data cache
+enum L1WritePolicy {
+  L1_WRITE_THROUGH,  // No allocate: a hit line is updated, the store always goes to DRAM
+  L1_WRITE_BACK      // Allocate and dirty the line; DRAM only sees evictions and flushes
+};
+
+inline const char *l1_write_policy_name(L1WritePolicy policy) {
+  return policy == L1_WRITE_BACK ? "write-back" : "write-through";
+}
+
+// Optional L1 data cache between the coalescing unit and DRAM
+struct L1CacheConfig {
+  size_t size_bytes = 0;  // 0 disables the cache
+  size_t ways = 4;
+  size_t line_bytes = DRAM_BEAT_BYTES;
+  size_t mshrs = 32;      // Line fills in flight
+  L1WritePolicy write_policy = L1_WRITE_THROUGH;
+};
+
+// Which DRAM timing model serves the coalescing unit
+enum DramModelConfig {
+  DRAM_FIXED,  // SIM_DRAM_LATENCY plus the queued beats, as in SIMTight's simulator
+  DRAM_BANKED  // Channels and banks with open rows and tRCD/tRP/tCAS timings
+};
+
+enum DramPagePolicy {
+  DRAM_OPEN_PAGE,   // A row stays open until another row of the bank is needed
+  DRAM_CLOSED_PAGE  // Every access precharges its bank afterwards
+};
+
+// Banked DRAM parameters; timings are in GPU cycles
+struct DramConfig {
+  DramModelConfig model = DRAM_FIXED;
+  size_t channels = 1;
+  size_t banks = 8;
+  size_t row_bytes = 2048;
+  DramPagePolicy page_policy = DRAM_OPEN_PAGE;
+  size_t t_rcd = 8;  // Activate to column command
+  size_t t_rp = 8;   // Precharge
+  size_t t_cas = 8;  // Column command to data
+  size_t t_wtr = 4;  // End of a write burst to the next read on the channel
+};
+
+// How shared SRAM words are spread over the banks
+enum SramBankHash {
+  SRAM_HASH_WORD,  // bank = word % banks, as in SIMTight
+  SRAM_HASH_XOR    // The word's row is XORed into the bank bits, so column walks spread out
+};
+
+inline const char *sram_bank_hash_name(SramBankHash hash) {
+  return hash == SRAM_HASH_XOR ? "xor" : "word";
+}
+
+// Shared SRAM banking; the defaults are SIMTight's
+struct SramConfig {
+  size_t banks = 16;
+  SramBankHash hash = SRAM_HASH_WORD;
+  size_t queue_depth = 2;  // Accesses waiting for the banks before the coalescer stalls
+  size_t latency = 10;     // Cycles from the banks to the warp, on top of the queueing
+
+  bool operator==(const SramConfig &other) const = default;
 };
 
 // For command line options that I pass
@@ -61,6 +154,44 @@ public:
   void setWarpScheduler(WarpSchedulerConfig value) {scheduler = value;}
   WarpSchedulerConfig warpScheduler() { return scheduler;}
 
+  void setSeed(uint64_t value) { rngSeed = value; }
+  uint64_t seed() { return rngSeed; }
+
+  void setTwoLevelActiveWarps(unsigned value) { twoLevelActive = value; }
+  unsigned twoLevelActiveWarps() { return twoLevelActive; }
+
+  void setReconvergence(ReconvergenceConfig value) { reconvergenceModel = value; }
+  ReconvergenceConfig reconvergence() { return reconvergenceModel; }
+
+  void setL1Cache(const L1CacheConfig &value) { l1 = value; }
+  const L1CacheConfig &l1Cache() { return l1; }
+
+  void setDram(const DramConfig &value) { dram = value; }
+  const DramConfig &dramConfig() { return dram; }
+
+  void setSram(const SramConfig &value) { sram = value; }
+  const SramConfig &sramConfig() { return sram; }
+
+  // Outstanding loads per GPU warp; 0 keeps SIMTight's blocking loads
+  void setLoadScoreboard(size_t value) { loadScoreboardDepth = value; }
+  size_t loadScoreboard() { return loadScoreboardDepth; }
+
+  // Execute ALU ops on uniform registers once per warp instead of per lane
+  void setScalarize(bool value) { scalarize = value; }
+  bool isScalarize() { return scalarize; }
+
+  // Merge the same-address lanes of an atomic into one read-modify-write
+  void setAtomicCombining(bool value) { atomicCombining = value; }
+  bool isAtomicCombining() { return atomicCombining; }
+
+  // Beats the GPU store write-combining buffer holds; 0 sends every store straight to DRAM
+  void setWriteCombining(size_t value) { writeCombiningEntries = value; }
+  size_t writeCombining() { return writeCombiningEntries; }
+
+  // Kernel launches the host can queue behind a running one; 0 allows one launch at a time
+  void setLaunchQueue(size_t value) { launchQueueDepth = value; }
+  size_t launchQueue() { return launchQueueDepth; }
+
 private:
   bool debug = false;
   bool regDump = false;
@@ -68,5 +199,16 @@ private:
   bool statsOnly = false;
   bool quick = false;
   WarpSchedulerConfig scheduler = BASELINE;
+  uint64_t rngSeed = 1;
+  unsigned twoLevelActive = 8;
+  ReconvergenceConfig reconvergenceModel = RECONVERGE_NESTING;
+  L1CacheConfig l1;
+  DramConfig dram;
+  SramConfig sram;
+  size_t loadScoreboardDepth = 0;
+  bool scalarize = false;
+  bool atomicCombining = false;
+  size_t writeCombiningEntries = 0;
+  size_t launchQueueDepth = 0;
   Config() = default;
 };
\ No newline at end of file
@@ -85,18 +85,27 @@ public:
         }
       } else if (buf_substr == "00000000:08 00") {
         in.setOpcode(0xFD);
-        // TODO: Implement cache line flush
-        // The GPU has no cache so probably unnecessary to model
+        // The line address is in rs1
+        unsigned rs1 = (data[offset + 2] & 0xF) << 1 | data[offset + 1] >> 7;
+        in.addOperand(MCOperand::createReg(RISCV::X0 + rs1));
       }
     }
     return in;
   }
 
   void print(const MCInst &inst, uint64_t offset) {
+    std::cout << to_string(inst, offset) << std::endl;
+  }
+
+  std::string to_string(const MCInst &inst, uint64_t offset) {
+    // The NoCL pseudo-opcodes are not known to the LLVM printer
+    if (inst.getOpcode() >= 0xFD && inst.getOpcode() <= 0xFF) {
+      return getOpcodeName(inst.getOpcode());
+    }
     std::string buf;
     raw_string_ostream out(buf);
     ip->printInst(&inst, offset, "", *si, out);
-    std::cout << buf << std::endl;
+    return out.str();
   }
 
   std::string getOpcodeName(unsigned int opcode) {
@@ -0,0 +1,92 @@
+#include "block_dispatcher.hpp"
+#include "stats/stats.hpp"
+#include <algorithm>
+
+uint32_t BlockDispatcher::grid_x(uint64_t dims) {
+  return std::max<uint32_t>(1, dims & 0xFFFF);
+}
+
+uint32_t BlockDispatcher::grid_y(uint64_t dims) {
+  return std::max<uint32_t>(1, (dims >> 16) & 0xFFFF);
+}
+
+std::vector<size_t> BlockDispatcher::begin_grid(uint64_t dims, size_t num_warps,
+                                                unsigned warps_per_block) {
+  width = grid_x(dims);
+  total_blocks = width * grid_y(dims);
+  next_block = 0;
+  warps_per_slot = warps_per_block == 0 ? num_warps : std::min<size_t>(warps_per_block, num_warps);
+  slots.assign(num_warps / warps_per_slot, Slot());
+  running_slots = 0;
+  waiting_slots = 0;
+  now = 0;
+  GPUStatisticsManager::instance().add_blocks(BLOCK_SLOTS, slots.size());
+
+  std::vector<size_t> started;
+  for (size_t s = 0; s < slots.size() && next_block < total_blocks; s++) {
+    start_block(slots[s], next_block++);
+    started.push_back(s);
+  }
+  return started;
+}
+
+void BlockDispatcher::start_block(Slot &slot, uint32_t block) {
+  slot.block = block;
+  slot.live_warps = warps_per_slot;
+  slot.waiting = false;
+  running_slots++;
+  GPUStatisticsManager::instance().add_blocks(BLOCK_DISPATCHED, 1);
+}
+
+bool BlockDispatcher::warp_retired(size_t warp_id) {
+  size_t s = warp_id / std::max<size_t>(warps_per_slot, 1);
+  if (s >= slots.size() || slots[s].live_warps == 0) {
+    return false;
+  }
+  Slot &slot = slots[s];
+  if (--slot.live_warps > 0) {
+    return false;
+  }
+  running_slots--;
+  if (next_block < total_blocks) {
+    // The block is claimed now, so blocks start in order
+    slot.block = next_block++;
+    slot.waiting = true;
+    slot.dispatch_tick = now + DISPATCH_LATENCY;
+    waiting_slots++;
+  }
+  return !is_active();
+}
+
+std::vector<size_t> BlockDispatcher::tick() {
+  std::vector<size_t> started;
+  if (!is_active()) {
+    return started;
+  }
+  now++;
+  for (size_t s = 0; s < slots.size(); s++) {
+    if (slots[s].waiting && slots[s].dispatch_tick <= now) {
+      waiting_slots--;
+      start_block(slots[s], slots[s].block);
+      started.push_back(s);
+    }
+  }
+
+  // The tail: every block has gone out, but some slots have run dry
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+  stats.add_blocks(BLOCK_CYCLES, 1);
+  stats.add_blocks(BLOCK_BUSY_SLOT_CYCLES, running_slots);
+  if (next_block == total_blocks && running_slots < slots.size()) {
+    stats.add_blocks(BLOCK_TAIL_CYCLES, 1);
+  }
+  return started;
+}
+
+uint32_t BlockDispatcher::block_index(size_t warp_id) const {
+  size_t s = warp_id / std::max<size_t>(warps_per_slot, 1);
+  if (s >= slots.size()) {
+    return 0;
+  }
+  uint32_t block = slots[s].block;
+  return ((block / width) << 16) | (block % width);
+}
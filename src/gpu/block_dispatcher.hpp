@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/*
+ * Hardware block dispatcher for kernels launched with grid dimensions
+ * (SIMTSetGridDims, CSR 0x829).
+ *
+ * The GPU's warps are split into slots of warps_per_block warps, and each
+ * slot runs one block at a time. The first wave fills every slot. After
+ * that a slot starts the next block DISPATCH_LATENCY cycles after the last
+ * warp of its block retires, so a grid larger than the GPU runs without
+ * the runtime looping over blocks. Warps read the index of their block
+ * from SIMTBlockIdx (CSR 0x832).
+ *
+ * Blocks go to slots rather than to warps, so the slots of several SMs
+ * could share one dispatcher.
+ */
+class BlockDispatcher {
+public:
+  // Cycles from a block's last warp retiring until its slot starts the next
+  static constexpr size_t DISPATCH_LATENCY = 4;
+
+  // SIMTSetGridDims packs x into the low and y into the high 16 bits; 0 counts as 1
+  static uint32_t grid_x(uint64_t dims);
+  static uint32_t grid_y(uint64_t dims);
+
+  /*
+   * Starts a grid of grid_x(dims) * grid_y(dims) blocks on num_warps
+   * warps, warps_per_block (0: all of them) to a slot. Returns the slots
+   * of the first wave; the warps of the other slots stay idle.
+   */
+  std::vector<size_t> begin_grid(uint64_t dims, size_t num_warps, unsigned warps_per_block);
+
+  // A warp has terminated. Returns true when that finished the grid.
+  bool warp_retired(size_t warp_id);
+
+  // Advances one cycle. Returns the slots whose next block starts now.
+  std::vector<size_t> tick();
+
+  // Blocks running or waiting for their slot
+  bool is_active() const { return running_slots > 0 || waiting_slots > 0; }
+  size_t slot_warps() const { return warps_per_slot; }
+  // (blockIdx.y << 16) | blockIdx.x of the block the warp runs
+  uint32_t block_index(size_t warp_id) const;
+
+private:
+  struct Slot {
+    uint32_t block = 0;
+    size_t live_warps = 0;
+    bool waiting = false;
+    size_t dispatch_tick = 0;
+  };
+
+  void start_block(Slot &slot, uint32_t block);
+
+  uint32_t width = 1;
+  uint32_t total_blocks = 0;
+  uint32_t next_block = 0;
+  size_t warps_per_slot = 0;
+  std::vector<Slot> slots;
+  size_t running_slots = 0;
+  size_t waiting_slots = 0;
+  size_t now = 0;
+};
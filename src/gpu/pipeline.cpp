@@ -1,12 +1,36 @@
 #include "pipeline.hpp"
+#include "../stats/self_profiler.hpp"
+#include <cxxabi.h>
+#include <typeinfo>
 
 void Pipeline::execute() {
+    if (!self_profile_sections.empty()) {
+        SelfProfiler &profiler = SelfProfiler::instance();
+        for (size_t i = stages.size(); i-- > 0;) {
+            stages[i]->execute();
+            profiler.lap(self_profile_sections[i]);
+        }
+        return;
+    }
+
     // Execute backwards to avoid overwriting latches prematurely
     for (auto it = stages.rbegin(); it != stages.rend(); it++) {
         (*it)->execute();
     }
 }
 
+void Pipeline::enable_self_profile(const std::string &prefix) {
+    self_profile_sections.clear();
+    for (auto &stage : stages) {
+        const char *mangled = typeid(*stage).name();
+        int status = 0;
+        char *demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+        std::string name = status == 0 ? demangled : mangled;
+        free(demangled);
+        self_profile_sections.push_back(SelfProfiler::instance().add_section(prefix + "." + name));
+    }
+}
+
 bool Pipeline::has_active_stages() {
     for (auto &stage: stages) {
         if (stage->is_active()) return true;
@@ -3,6 +3,15 @@
 #include "utils.hpp"
 #include "config.hpp"
 
+/*
+ * A divergent path on a warp's IPDOM reconvergence stack: its lanes run
+ * until they all reach rpc (see gpu/reconvergence.hpp)
+ */
+struct ReconvergenceEntry {
+  uint64_t rpc;
+  uint64_t lanes;
+};
+
 /*
  * An individual warp. This maintains the per-warp state
  */
@@ -16,6 +25,8 @@ public:
   std::vector<bool> retrying;
   bool suspended;
   bool in_barrier;
+  // Only used with --reconvergence=ipdom; innermost path last
+  std::vector<ReconvergenceEntry> reconvergence_stack;
   Warp(uint64_t warp_id, size_t size, uint64_t start_pc, bool is_cpu)
       : warp_id(warp_id), size(size), is_cpu(is_cpu), suspended(false),
         in_barrier(false),
@@ -23,10 +34,31 @@ public:
         retrying(size, false) {
   };
 
+  // Back to the state of a new warp, so a kernel launch can reuse it
+  void reset(uint64_t start_pc) {
+    std::fill(pc.begin(), pc.end(), start_pc);
+    std::fill(nesting_level.begin(), nesting_level.end(), 0);
+    std::fill(finished.begin(), finished.end(), false);
+    std::fill(retrying.begin(), retrying.end(), false);
+    suspended = false;
+    in_barrier = false;
+    reconvergence_stack.clear();
+  }
+
   bool is_cpu;
   ~Warp() {};
 };
 
+/*
+ * Orders warps by pipeline and warp id instead of by address, so maps
+ * keyed on Warp * are iterated in the same order on every run
+ */
+struct WarpIdLess {
+  bool operator()(const Warp *a, const Warp *b) const {
+    return a->is_cpu != b->is_cpu ? a->is_cpu : a->warp_id < b->warp_id;
+  }
+};
+
 /*
  * A latch between each pipeline stage that defines
  * the input/output interface between stages
@@ -117,6 +149,9 @@ public:
     }
   }
 
+  // The block dispatcher's warps run several blocks, so it ends the kernel itself
+  void finish_kernel() { pipeline_deactivating = true; }
+
   void apply_deferred_deactivation() {
     if (pipeline_deactivating) {
       pipeline_active = false;
@@ -130,8 +165,15 @@ public:
     }
   }
 
+  /*
+   * Charge the host time of each stage to its own --self-profile
+   * section, named "<prefix>.<stage class>"
+   */
+  void enable_self_profile(const std::string &prefix);
+
 private:
   std::vector<std::shared_ptr<PipelineStage>> stages;
+  std::vector<size_t> self_profile_sections;
   bool pipeline_active = false;
   size_t completed_warps = 0;
   bool pipeline_deactivating = false;
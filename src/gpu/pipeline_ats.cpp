@@ -1,5 +1,6 @@
 #include "pipeline_ats.hpp"
 #include "config.hpp"
+#include "stats/profiler.hpp"
 #include <string>
 #include <vector>
 #include <sstream>
@@ -35,12 +36,21 @@ void ActiveThreadSelection::execute() {
   }
 
   Warp *warp = PipelineStage::input_latch->warp;
+
+  // Lanes allowed to issue; the nesting level only counts without IPDOM
+  uint64_t eligible = UINT64_MAX;
+  bool use_nesting = true;
+  if (reconvergence && !warp->is_cpu) {
+    eligible = reconvergence->select_lanes(warp);
+    use_nesting = false;
+  }
   
   int leader_idx = -1;
   uint64_t leader_value = 0;
   for (int i = 0; i < warp->size; i++) {
-    if (warp->finished[i]) continue;
-    uint64_t value = (warp->nesting_level[i] << 1) | (warp->retrying[i] ? 1 : 0);
+    if (warp->finished[i] || !((eligible >> i) & 1)) continue;
+    uint64_t nesting = use_nesting ? warp->nesting_level[i] : 0;
+    uint64_t value = (nesting << 1) | (warp->retrying[i] ? 1 : 0);
     if (leader_idx == -1 || value >= leader_value) {
       leader_idx = i;
       leader_value = value;
@@ -63,12 +73,16 @@ void ActiveThreadSelection::execute() {
   uint64_t leader_nesting = warp->nesting_level[leader_idx];
   bool leader_retry = warp->retrying[leader_idx];
 
+  if (!warp->is_cpu && PCProfiler::instance().is_enabled()) {
+    PCProfiler::instance().record_issue(warp->warp_id, leader_pc);
+  }
+
   std::vector<uint64_t> active_threads;  
   for (int i = 0; i < warp->size; i++) {
-    if (warp->finished[i])
+    if (warp->finished[i] || !((eligible >> i) & 1))
       continue;
     bool state_matches = (warp->pc[i] == leader_pc) &&
-                         (warp->nesting_level[i] == leader_nesting) &&
+                         (!use_nesting || warp->nesting_level[i] == leader_nesting) &&
                          (warp->retrying[i] == leader_retry);
     if (state_matches) {
       active_threads.emplace_back(i);
@@ -1,9 +1,12 @@
 #include "utils.hpp"
 #include "pipeline.hpp"
+#include "reconvergence.hpp"
 
 /*
  * The Active Thread Selection unit finds the threads in a warp with
  * the deepest nesting level and the same PC and 
+ * With an IPDOM reconvergence table, only the lanes on top of the warp's
+ * reconvergence stack are considered and nesting levels are ignored.
  */
 class ActiveThreadSelection : public PipelineStage {
 public:
@@ -13,6 +16,9 @@ public:
      */
     void execute() override;
     bool is_active() override;
+    void set_reconvergence(std::shared_ptr<const ReconvergenceTable> table) {
+        reconvergence = std::move(table);
+    }
     ~ActiveThreadSelection() {}
 
 private:
@@ -23,4 +29,5 @@ private:
         BufferData() : warp(nullptr), valid(false) {}
     };
     BufferData stage_buffer;
+    std::shared_ptr<const ReconvergenceTable> reconvergence;
 };
\ No newline at end of file
@@ -1,9 +1,16 @@
 #include "pipeline_execute.hpp"
 #include "../disassembler/llvm_disasm.hpp"
 #include "../stats/stats.hpp"
+#include "../stats/profiler.hpp"
 #include "../config.hpp"
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <climits>
+#include <cmath>
+#include <cstring>
+#include <optional>
+#include <set>
 #include <sstream>
 #include <iomanip>
 
@@ -11,17 +18,354 @@
 // I prolly shouldn't be puting this here but I might clean up if I have time
 #define WORD_SIZE 4
 
+// The AMO a mnemonic performs, ignoring its acquire/release bits
+static std::optional<AtomicOp> amo_op(std::string mnemonic) {
+  static const std::map<std::string, AtomicOp> ops = {
+      {"AMOADD_W", AMO_ADD}, {"AMOSWAP_W", AMO_SWAP}, {"AMOAND_W", AMO_AND},
+      {"AMOOR_W", AMO_OR},   {"AMOXOR_W", AMO_XOR},   {"AMOMIN_W", AMO_MIN},
+      {"AMOMAX_W", AMO_MAX}, {"AMOMINU_W", AMO_MINU}, {"AMOMAXU_W", AMO_MAXU}};
+  if (mnemonic.compare(0, 3, "AMO") != 0) return std::nullopt;
+  for (const char *suffix : {"_AQ_RL", "_AQ", "_RL"}) {
+    size_t len = strlen(suffix);
+    if (mnemonic.size() > len && mnemonic.compare(mnemonic.size() - len, len, suffix) == 0) {
+      mnemonic.resize(mnemonic.size() - len);
+      break;
+    }
+  }
+  auto it = ops.find(mnemonic);
+  if (it == ops.end()) return std::nullopt;
+  return it->second;
+}
+
+static std::optional<FpOp> fp_op(const std::string &mnemonic) {
+  static const std::map<std::string, FpOp> ops = {
+      {"FADD_S_INX", FP_ADD},        {"FSUB_S_INX", FP_SUB},
+      {"FMUL_S_INX", FP_MUL},        {"FDIV_S_INX", FP_DIV},
+      {"FSQRT_S_INX", FP_SQRT},      {"FMIN_S_INX", FP_MIN},
+      {"FMAX_S_INX", FP_MAX},        {"FMADD_S_INX", FP_MADD},
+      {"FMSUB_S_INX", FP_MSUB},      {"FNMADD_S_INX", FP_NMADD},
+      {"FNMSUB_S_INX", FP_NMSUB},    {"FSGNJ_S_INX", FP_SGNJ},
+      {"FSGNJN_S_INX", FP_SGNJN},    {"FSGNJX_S_INX", FP_SGNJX},
+      {"FEQ_S_INX", FP_EQ},          {"FLT_S_INX", FP_LT},
+      {"FLE_S_INX", FP_LE},          {"FCLASS_S_INX", FP_CLASS},
+      {"FCVT_W_S_INX", FP_CVT_W_S},  {"FCVT_WU_S_INX", FP_CVT_WU_S},
+      {"FCVT_S_W_INX", FP_CVT_S_W},  {"FCVT_S_WU_INX", FP_CVT_S_WU}};
+  auto it = ops.find(mnemonic);
+  if (it == ops.end()) return std::nullopt;
+  return it->second;
+}
+
+/*
+ * The simulator decodes RV64, so the RV32 encodings of zext.h and rev8
+ * (which are RV64 instructions there) do not decode; both names are
+ * accepted for builds that decode RV32.
+ */
+static std::optional<BitOp> bit_op(const std::string &mnemonic) {
+  static const std::map<std::string, BitOp> ops = {
+      {"CLZ", BIT_CLZ},          {"CTZ", BIT_CTZ},
+      {"CPOP", BIT_CPOP},        {"SEXT_B", BIT_SEXT_B},
+      {"SEXT_H", BIT_SEXT_H},    {"ZEXT_H_RV32", BIT_ZEXT_H},
+      {"ZEXT_H_RV64", BIT_ZEXT_H}, {"REV8_RV32", BIT_REV8},
+      {"REV8_RV64", BIT_REV8},   {"ORC_B", BIT_ORC_B},
+      {"MIN", BIT_MIN},          {"MINU", BIT_MINU},
+      {"MAX", BIT_MAX},          {"MAXU", BIT_MAXU},
+      {"ANDN", BIT_ANDN},        {"ORN", BIT_ORN},
+      {"XNOR", BIT_XNOR},        {"ROL", BIT_ROL},
+      {"ROR", BIT_ROR},          {"RORI", BIT_RORI}};
+  auto it = ops.find(mnemonic);
+  if (it == ops.end()) return std::nullopt;
+  return it->second;
+}
+
+// Computes one Zbb op on 32-bit values for n lanes, a flat loop per op like fp_kernel
+static void bit_kernel(BitOp op, const uint32_t *a, const uint32_t *b, uint32_t *out, size_t n) {
+  auto s = [](uint32_t v) { return static_cast<int32_t>(v); };
+  switch (op) {
+  case BIT_CLZ:
+    for (size_t i = 0; i < n; i++) out[i] = std::countl_zero(a[i]);
+    break;
+  case BIT_CTZ:
+    for (size_t i = 0; i < n; i++) out[i] = std::countr_zero(a[i]);
+    break;
+  case BIT_CPOP:
+    for (size_t i = 0; i < n; i++) out[i] = std::popcount(a[i]);
+    break;
+  case BIT_SEXT_B:
+    for (size_t i = 0; i < n; i++) out[i] = static_cast<uint32_t>(static_cast<int8_t>(a[i]));
+    break;
+  case BIT_SEXT_H:
+    for (size_t i = 0; i < n; i++) out[i] = static_cast<uint32_t>(static_cast<int16_t>(a[i]));
+    break;
+  case BIT_ZEXT_H:
+    for (size_t i = 0; i < n; i++) out[i] = a[i] & 0xFFFF;
+    break;
+  case BIT_REV8:
+    for (size_t i = 0; i < n; i++) {
+      out[i] = (a[i] >> 24) | ((a[i] >> 8) & 0xFF00) | ((a[i] << 8) & 0xFF0000) | (a[i] << 24);
+    }
+    break;
+  case BIT_ORC_B:
+    for (size_t i = 0; i < n; i++) {
+      uint32_t r = 0;
+      for (int byte = 0; byte < 4; byte++) {
+        if ((a[i] >> (8 * byte)) & 0xFF) r |= 0xFFu << (8 * byte);
+      }
+      out[i] = r;
+    }
+    break;
+  case BIT_MIN:
+    for (size_t i = 0; i < n; i++) out[i] = s(a[i]) < s(b[i]) ? a[i] : b[i];
+    break;
+  case BIT_MINU:
+    for (size_t i = 0; i < n; i++) out[i] = std::min(a[i], b[i]);
+    break;
+  case BIT_MAX:
+    for (size_t i = 0; i < n; i++) out[i] = s(a[i]) > s(b[i]) ? a[i] : b[i];
+    break;
+  case BIT_MAXU:
+    for (size_t i = 0; i < n; i++) out[i] = std::max(a[i], b[i]);
+    break;
+  case BIT_ANDN:
+    for (size_t i = 0; i < n; i++) out[i] = a[i] & ~b[i];
+    break;
+  case BIT_ORN:
+    for (size_t i = 0; i < n; i++) out[i] = a[i] | ~b[i];
+    break;
+  case BIT_XNOR:
+    for (size_t i = 0; i < n; i++) out[i] = ~(a[i] ^ b[i]);
+    break;
+  case BIT_ROL:
+    for (size_t i = 0; i < n; i++) out[i] = std::rotl(a[i], static_cast<int>(b[i] & 31));
+    break;
+  case BIT_ROR:
+  case BIT_RORI:
+    for (size_t i = 0; i < n; i++) out[i] = std::rotr(a[i], static_cast<int>(b[i] & 31));
+    break;
+  }
+}
+
+static size_t fp_latency(FpOp op) {
+  switch (op) {
+  case FP_ADD: case FP_SUB: case FP_MIN: case FP_MAX: return SIM_FADD_LATENCY;
+  case FP_MUL: return SIM_FMUL_LATENCY;
+  case FP_DIV: return SIM_FDIV_LATENCY;
+  case FP_SQRT: return SIM_FSQRT_LATENCY;
+  case FP_MADD: case FP_MSUB: case FP_NMADD: case FP_NMSUB: return SIM_FMA_LATENCY;
+  case FP_CVT_W_S: case FP_CVT_WU_S: case FP_CVT_S_W: case FP_CVT_S_WU: return SIM_FCVT_LATENCY;
+  default: return SIM_FCMP_LATENCY;
+  }
+}
+
+// RISC-V returns the canonical NaN rather than propagating payloads
+static constexpr uint32_t FP_CANONICAL_NAN = 0x7FC00000;
+static constexpr uint32_t FP_SIGN = 0x80000000;
+
+static uint32_t fp_bits(float f) {
+  return std::isnan(f) ? FP_CANONICAL_NAN : std::bit_cast<uint32_t>(f);
+}
+
+static uint32_t fp_min_max(uint32_t a, uint32_t b, bool is_max) {
+  float fa = std::bit_cast<float>(a), fb = std::bit_cast<float>(b);
+  if (std::isnan(fa) && std::isnan(fb)) return FP_CANONICAL_NAN;
+  if (std::isnan(fa)) return b;
+  if (std::isnan(fb)) return a;
+  if (fa == fb) {
+    // -0.0 orders below +0.0
+    return is_max ? (a & b) : (a | b);
+  }
+  return (fa < fb) != is_max ? a : b;
+}
+
+static uint32_t fp_class(uint32_t a) {
+  float f = std::bit_cast<float>(a);
+  bool neg = a & FP_SIGN;
+  switch (std::fpclassify(f)) {
+  case FP_INFINITE: return neg ? 1u << 0 : 1u << 7;
+  case FP_NORMAL: return neg ? 1u << 1 : 1u << 6;
+  case FP_SUBNORMAL: return neg ? 1u << 2 : 1u << 5;
+  case FP_ZERO: return neg ? 1u << 3 : 1u << 4;
+  default: return (a & 0x00400000) ? 1u << 9 : 1u << 8;  // Quiet or signalling NaN
+  }
+}
+
+// Rounds to an integer with a static rounding mode; the dynamic mode (7) is RNE
+static float fp_round(float f, int64_t rm) {
+  switch (rm) {
+  case 1: return std::trunc(f);
+  case 2: return std::floor(f);
+  case 3: return std::ceil(f);
+  case 4: return std::round(f);
+  default: return std::nearbyint(f);
+  }
+}
+
+static uint32_t fp_to_int(uint32_t a, int64_t rm, bool is_unsigned) {
+  float f = std::bit_cast<float>(a);
+  if (std::isnan(f)) return is_unsigned ? UINT32_MAX : INT32_MAX;
+  double r = fp_round(f, rm);
+  if (is_unsigned) {
+    if (r <= 0.0) return 0;
+    return r >= 4294967296.0 ? UINT32_MAX : static_cast<uint32_t>(r);
+  }
+  if (r >= 2147483648.0) return INT32_MAX;
+  if (r < -2147483648.0) return static_cast<uint32_t>(INT32_MIN);
+  return static_cast<uint32_t>(static_cast<int32_t>(r));
+}
+
+/*
+ * Computes one Zfinx op for n lanes. Each op is a flat loop over the
+ * gathered operands so the host compiler can vectorize it. Arithmetic
+ * rounds to nearest even; only the conversions to integer honour a
+ * static rounding mode.
+ */
+static void fp_kernel(FpOp op, int64_t rm, const uint32_t *a, const uint32_t *b,
+                      const uint32_t *c, uint32_t *out, size_t n) {
+  auto f = [](uint32_t bits) { return std::bit_cast<float>(bits); };
+  switch (op) {
+  case FP_ADD:
+    for (size_t i = 0; i < n; i++) out[i] = fp_bits(f(a[i]) + f(b[i]));
+    break;
+  case FP_SUB:
+    for (size_t i = 0; i < n; i++) out[i] = fp_bits(f(a[i]) - f(b[i]));
+    break;
+  case FP_MUL:
+    for (size_t i = 0; i < n; i++) out[i] = fp_bits(f(a[i]) * f(b[i]));
+    break;
+  case FP_DIV:
+    for (size_t i = 0; i < n; i++) out[i] = fp_bits(f(a[i]) / f(b[i]));
+    break;
+  case FP_SQRT:
+    for (size_t i = 0; i < n; i++) out[i] = fp_bits(std::sqrt(f(a[i])));
+    break;
+  case FP_MIN:
+  case FP_MAX:
+    for (size_t i = 0; i < n; i++) out[i] = fp_min_max(a[i], b[i], op == FP_MAX);
+    break;
+  case FP_MADD:
+    for (size_t i = 0; i < n; i++) out[i] = fp_bits(std::fma(f(a[i]), f(b[i]), f(c[i])));
+    break;
+  case FP_MSUB:
+    for (size_t i = 0; i < n; i++) out[i] = fp_bits(std::fma(f(a[i]), f(b[i]), -f(c[i])));
+    break;
+  case FP_NMADD:
+    for (size_t i = 0; i < n; i++) out[i] = fp_bits(std::fma(-f(a[i]), f(b[i]), -f(c[i])));
+    break;
+  case FP_NMSUB:
+    for (size_t i = 0; i < n; i++) out[i] = fp_bits(std::fma(-f(a[i]), f(b[i]), f(c[i])));
+    break;
+  case FP_SGNJ:
+    for (size_t i = 0; i < n; i++) out[i] = (a[i] & ~FP_SIGN) | (b[i] & FP_SIGN);
+    break;
+  case FP_SGNJN:
+    for (size_t i = 0; i < n; i++) out[i] = (a[i] & ~FP_SIGN) | (~b[i] & FP_SIGN);
+    break;
+  case FP_SGNJX:
+    for (size_t i = 0; i < n; i++) out[i] = a[i] ^ (b[i] & FP_SIGN);
+    break;
+  case FP_EQ:
+    for (size_t i = 0; i < n; i++) out[i] = f(a[i]) == f(b[i]);
+    break;
+  case FP_LT:
+    for (size_t i = 0; i < n; i++) out[i] = f(a[i]) < f(b[i]);
+    break;
+  case FP_LE:
+    for (size_t i = 0; i < n; i++) out[i] = f(a[i]) <= f(b[i]);
+    break;
+  case FP_CLASS:
+    for (size_t i = 0; i < n; i++) out[i] = fp_class(a[i]);
+    break;
+  case FP_CVT_W_S:
+  case FP_CVT_WU_S:
+    for (size_t i = 0; i < n; i++) out[i] = fp_to_int(a[i], rm, op == FP_CVT_WU_S);
+    break;
+  case FP_CVT_S_W:
+    for (size_t i = 0; i < n; i++) out[i] = std::bit_cast<uint32_t>(static_cast<float>(static_cast<int32_t>(a[i])));
+    break;
+  case FP_CVT_S_WU:
+    for (size_t i = 0; i < n; i++) out[i] = std::bit_cast<uint32_t>(static_cast<float>(a[i]));
+    break;
+  }
+}
+
 ExecutionUnit::ExecutionUnit(CoalescingUnit *cu, RegisterFile *rf,
                              LLVMDisassembler *disasm,
                              HostGPUControl *gpu_controller)
-    : cu(cu), rf(rf), disasm(disasm), gpu_controller(gpu_controller) {}
+    : cu(cu), rf(rf), disasm(disasm), gpu_controller(gpu_controller),
+      scalarize(Config::instance().isScalarize()) {}
+
+// Instructions that only compute rd from registers, immediates and the PC
+static bool is_scalar_alu(const std::string &mnemonic) {
+  static const std::set<std::string> ops = {
+      "ADD", "ADDI", "SUB", "AND", "ANDI", "OR", "ORI", "XOR", "XORI",
+      "SLL", "SLLI", "SRL", "SRLI", "SRA", "SRAI", "LUI", "AUIPC",
+      "SLT", "SLTI", "SLTIU", "SLTU",
+      "CLZ", "CTZ", "CPOP", "SEXT_B", "SEXT_H", "ZEXT_H_RV32", "ZEXT_H_RV64",
+      "REV8_RV32", "REV8_RV64", "ORC_B", "MIN", "MINU", "MAX", "MAXU",
+      "ANDN", "ORN", "XNOR", "ROL", "ROR", "RORI"};
+  return ops.count(mnemonic) > 0;
+}
+
+// Bytes accessed by a load or store, 0 for anything else
+static size_t access_bytes(const std::string &mnemonic) {
+  if (mnemonic == "LW" || mnemonic == "SW") return WORD_SIZE;
+  if (mnemonic == "LH" || mnemonic == "LHU" || mnemonic == "SH") return WORD_SIZE / 2;
+  if (mnemonic == "LB" || mnemonic == "LBU" || mnemonic == "SB") return 1;
+  return 0;
+}
+
+ExecutionUnit::ScalarInfo ExecutionUnit::classify_operands(Warp *warp,
+                                                           const std::string &mnemonic,
+                                                           MCInst &inst) {
+  ScalarInfo info;
+  static const std::set<std::string> no_rd = {"SW", "SH", "SB", "BEQ", "BNE", "BLT",
+                                               "BLTU", "BGE", "BGEU", "CACHE_LINE_FLUSH"};
+  bool writes_rd = no_rd.count(mnemonic) == 0;
+  info.uniform = true;
+  for (unsigned i = writes_rd ? 1 : 0; i < inst.getNumOperands(); i++) {
+    const MCOperand &op = inst.getOperand(i);
+    if (op.isReg() && rf->get_shape(warp->warp_id, op.getReg()).tag != REG_UNIFORM) {
+      info.uniform = false;
+      break;
+    }
+  }
+  size_t bytes = access_bytes(mnemonic);
+  if (bytes > 0) {
+    RegisterShape base = rf->get_shape(warp->warp_id, inst.getOperand(1).getReg());
+    info.affine_access = base.tag == REG_AFFINE && base.stride == static_cast<int>(bytes);
+  }
+  info.execute_once = info.uniform && is_scalar_alu(mnemonic);
+  return info;
+}
+
+void ExecutionUnit::broadcast(Warp *warp, const std::vector<size_t> &lanes, MCInst &inst) {
+  unsigned int rd = inst.getOperand(0).getReg();
+  int value = rf->get_register(warp->warp_id, lanes[0], rd, warp->is_cpu);
+  for (size_t i = 1; i < lanes.size(); i++) {
+    rf->set_register(warp->warp_id, lanes[i], rd, value, warp->is_cpu);
+    warp->pc[lanes[i]] = warp->pc[lanes[0]];
+  }
+}
 
 execute_result ExecutionUnit::execute(Warp *warp,
                                       std::vector<size_t> active_threads,
                                       MCInst &inst) {
   execute_result res{true, false, true};
+  retry_reason = STALL_RETRY;
+  load_issued = false;
 
   std::string mnemonic = disasm->getOpcodeName(inst.getOpcode());
+
+  // With --scalarize, an ALU op on uniform registers is computed by one lane
+  ScalarInfo scalar;
+  std::vector<size_t> lanes;
+  if (scalarize && !warp->is_cpu) {
+    scalar = classify_operands(warp, mnemonic, inst);
+    if (scalar.execute_once && active_threads.size() > 1) {
+      lanes = std::move(active_threads);
+      active_threads = {lanes[0]};
+    }
+  }
+
   if (mnemonic == "ADDI") {
     res.write_required = addi(warp, active_threads, &inst);
   } else if (mnemonic == "ADD") {
@@ -89,31 +433,31 @@ execute_result ExecutionUnit::execute(Warp *warp,
     res.write_required = auipc(warp, active_threads, &inst);
   } else if (mnemonic == "LW") {
     res.write_required = lw(warp, active_threads, &inst);
-    if (!res.write_required && !warp->suspended) {
+    if (!res.write_required && !load_issued) {
       res.success = false;
       res.counted = false;
     }
   } else if (mnemonic == "LH") {
     res.write_required = lh(warp, active_threads, &inst);
-    if (!res.write_required && !warp->suspended) {
+    if (!res.write_required && !load_issued) {
       res.success = false;
       res.counted = false;
     }
   } else if (mnemonic == "LHU") {
     res.write_required = lhu(warp, active_threads, &inst);
-    if (!res.write_required && !warp->suspended) {
+    if (!res.write_required && !load_issued) {
       res.success = false;
       res.counted = false;
     }
   } else if (mnemonic == "LB") {
     res.write_required = lb(warp, active_threads, &inst);
-    if (!res.write_required && !warp->suspended) {
+    if (!res.write_required && !load_issued) {
       res.success = false;
       res.counted = false;
     }
   } else if (mnemonic == "LBU") {
     res.write_required = lbu(warp, active_threads, &inst);
-    if (!res.write_required && !warp->suspended) {
+    if (!res.write_required && !load_issued) {
       res.success = false;
       res.counted = false;
     }
@@ -135,8 +479,8 @@ execute_result ExecutionUnit::execute(Warp *warp,
       res.counted = false;
     }
     res.write_required = false;
-  } else if (mnemonic == "AMOADD_W") {
-    res.write_required = amoadd_w(warp, active_threads, &inst);
+  } else if (std::optional<AtomicOp> op = amo_op(mnemonic)) {
+    res.write_required = amo(warp, active_threads, &inst, *op);
     if (!res.write_required && !warp->suspended) {
       res.success = false;
       res.counted = false;
@@ -213,6 +557,20 @@ execute_result ExecutionUnit::execute(Warp *warp,
     res.write_required = noclpop(warp, active_threads, &inst);
   } else if (mnemonic == "CACHE_LINE_FLUSH") {
     res.write_required = cache_line_flush(warp, active_threads, &inst);
+  } else if (mnemonic == "MULH" || mnemonic == "MULHSU" || mnemonic == "MULHU") {
+    res.write_required = mulh(warp, active_threads, &inst, mnemonic != "MULHU", mnemonic == "MULH");
+    if (!res.write_required && !warp->suspended) {
+      res.success = false;
+      res.counted = false;
+    }
+  } else if (std::optional<BitOp> op = bit_op(mnemonic)) {
+    res.write_required = bitmanip(warp, active_threads, &inst, *op);
+  } else if (std::optional<FpOp> op = fp_op(mnemonic)) {
+    res.write_required = fpu(warp, active_threads, &inst, *op);
+    if (!res.write_required && !warp->suspended) {
+      res.success = false;
+      res.counted = false;
+    }
   } else {
     // Default to skip instruction
     for (auto thread : active_threads) {
@@ -223,6 +581,23 @@ execute_result ExecutionUnit::execute(Warp *warp,
     if (!Config::instance().isStatsOnly())
       std::cout << "[WARNING] Unknown instruction " << mnemonic << std::endl;
   }
+
+  if (!lanes.empty()) {
+    broadcast(warp, lanes, inst);
+  }
+  if (scalarize && !warp->is_cpu && res.success && res.counted) {
+    GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+    stats.increment_scalar(SCALAR_WARP_INSTRS);
+    if (scalar.uniform) {
+      stats.increment_scalar(SCALAR_UNIFORM_INSTRS);
+    }
+    if (scalar.execute_once) {
+      stats.increment_scalar(SCALAR_EXECUTED_ONCE);
+    }
+    if (scalar.affine_access) {
+      stats.increment_scalar(SCALAR_AFFINE_ACCESSES);
+    }
+  }
   return res;
 }
 
@@ -294,6 +669,7 @@ bool ExecutionUnit::mul(Warp *warp, std::vector<size_t> active_threads,
   }
 
   if (!cu->can_use_multiplier()) {
+    retry_reason = STALL_MULTIPLIER_FULL;
     return false;
   }
   cu->acquire_multiplier(warp);
@@ -308,6 +684,69 @@ bool ExecutionUnit::mul(Warp *warp, std::vector<size_t> active_threads,
   cu->suspend_for_func_unit(warp, SIM_MUL_LATENCY, rd, results);
   return false;
 }
+bool ExecutionUnit::mulh(Warp *warp, std::vector<size_t> active_threads,
+                         MCInst *in, bool rs1_signed, bool rs2_signed) {
+  assert(in->getNumOperands() == 3);
+  unsigned int rd = in->getOperand(0).getReg();
+  auto high_word = [&](size_t thread) {
+    int rs1 = rf->get_register(warp->warp_id, thread, in->getOperand(1).getReg(), warp->is_cpu);
+    int rs2 = rf->get_register(warp->warp_id, thread, in->getOperand(2).getReg(), warp->is_cpu);
+    int64_t a = rs1_signed ? static_cast<int64_t>(rs1) : static_cast<int64_t>(static_cast<uint32_t>(rs1));
+    int64_t b = rs2_signed ? static_cast<int64_t>(rs2) : static_cast<int64_t>(static_cast<uint32_t>(rs2));
+    // Exact in 64 bits for every sign combination, so the upper word is right
+    uint64_t product = static_cast<uint64_t>(a) * static_cast<uint64_t>(b);
+    return static_cast<int>(product >> 32);
+  };
+
+  if (warp->is_cpu) {
+    for (auto thread : active_threads) {
+      rf->set_register(warp->warp_id, thread, rd, high_word(thread), warp->is_cpu);
+      warp->pc[thread] += 4;
+    }
+    return active_threads.size() > 0;
+  }
+
+  if (!cu->can_use_multiplier()) {
+    retry_reason = STALL_MULTIPLIER_FULL;
+    return false;
+  }
+  cu->acquire_multiplier(warp);
+
+  std::map<size_t, int> results;
+  for (auto thread : active_threads) {
+    results[thread] = high_word(thread);
+    warp->pc[thread] += 4;
+  }
+  cu->suspend_for_func_unit(warp, SIM_MUL_LATENCY, rd, results);
+  return false;
+}
+
+bool ExecutionUnit::bitmanip(Warp *warp, std::vector<size_t> active_threads,
+                             MCInst *in, BitOp op) {
+  assert(active_threads.size() <= NUM_LANES);
+  unsigned int rd = in->getOperand(0).getReg();
+  unsigned int rs1_reg = in->getOperand(1).getReg();
+  std::array<uint32_t, NUM_LANES> a{}, b{}, out{};
+  size_t n = active_threads.size();
+  for (size_t i = 0; i < n; i++) {
+    a[i] = static_cast<uint32_t>(rf->get_register(warp->warp_id, active_threads[i], rs1_reg, warp->is_cpu));
+  }
+  if (in->getNumOperands() > 2) {
+    const MCOperand &rs2 = in->getOperand(2);
+    for (size_t i = 0; i < n; i++) {
+      b[i] = rs2.isImm() ? static_cast<uint32_t>(rs2.getImm())
+                         : static_cast<uint32_t>(rf->get_register(warp->warp_id, active_threads[i],
+                                                                  rs2.getReg(), warp->is_cpu));
+    }
+  }
+  bit_kernel(op, a.data(), b.data(), out.data(), n);
+  for (size_t i = 0; i < n; i++) {
+    rf->set_register(warp->warp_id, active_threads[i], rd, static_cast<int>(out[i]), warp->is_cpu);
+    warp->pc[active_threads[i]] += 4;
+  }
+  return true;
+}
+
 bool ExecutionUnit::and_(Warp *warp, std::vector<size_t> active_threads,
                          MCInst *in) {
   assert(in->getNumOperands() == 3);
@@ -513,6 +952,7 @@ bool ExecutionUnit::lw(Warp *warp, std::vector<size_t> active_threads,
   assert(in->getNumOperands() == 3);
   // If queue is full, return false to trigger retry (PC should NOT advance)
   if (!cu->can_put()) {
+    retry_reason = STALL_CU_QUEUE_FULL;
     return false;
   }
 
@@ -532,6 +972,7 @@ bool ExecutionUnit::lw(Warp *warp, std::vector<size_t> active_threads,
   }
 
   cu->load(warp, addresses, WORD_SIZE, rd, valid_threads, false);
+  load_issued = true;
   for (auto thread : valid_threads) {
     warp->pc[thread] += 4;
   }
@@ -544,6 +985,7 @@ bool ExecutionUnit::lh(Warp *warp, std::vector<size_t> active_threads,
   assert(in->getNumOperands() == 3);
 
   if (!cu->can_put()) {
+    retry_reason = STALL_CU_QUEUE_FULL;
     return false;
   }
 
@@ -563,6 +1005,7 @@ bool ExecutionUnit::lh(Warp *warp, std::vector<size_t> active_threads,
   }
 
   cu->load(warp, addresses, WORD_SIZE / 2, rd, valid_threads, false);
+  load_issued = true;
   for (auto thread : valid_threads) {
     warp->pc[thread] += 4;
   }
@@ -575,6 +1018,7 @@ bool ExecutionUnit::lhu(Warp *warp, std::vector<size_t> active_threads,
   assert(in->getNumOperands() == 3);
 
   if (!cu->can_put()) {
+    retry_reason = STALL_CU_QUEUE_FULL;
     return false;
   }
 
@@ -594,6 +1038,7 @@ bool ExecutionUnit::lhu(Warp *warp, std::vector<size_t> active_threads,
   }
 
   cu->load(warp, addresses, WORD_SIZE / 2, rd, valid_threads, true);
+  load_issued = true;
   for (auto thread : valid_threads) {
     warp->pc[thread] += 4;
   }
@@ -606,6 +1051,7 @@ bool ExecutionUnit::lb(Warp *warp, std::vector<size_t> active_threads,
   assert(in->getNumOperands() == 3);
 
   if (!cu->can_put()) {
+    retry_reason = STALL_CU_QUEUE_FULL;
     return false;
   }
 
@@ -624,6 +1070,7 @@ bool ExecutionUnit::lb(Warp *warp, std::vector<size_t> active_threads,
   }
   
   cu->load(warp, addresses, 1, rd, valid_threads, false);
+  load_issued = true;
   for (auto thread : valid_threads) {
     warp->pc[thread] += 4;
   }
@@ -636,6 +1083,7 @@ bool ExecutionUnit::lbu(Warp *warp, std::vector<size_t> active_threads,
   assert(in->getNumOperands() == 3);
 
   if (!cu->can_put()) {
+    retry_reason = STALL_CU_QUEUE_FULL;
     return false;
   }
 
@@ -654,6 +1102,7 @@ bool ExecutionUnit::lbu(Warp *warp, std::vector<size_t> active_threads,
   }
 
   cu->load(warp, addresses, 1, rd, valid_threads, true);
+  load_issued = true;
   for (auto thread : valid_threads) {
     warp->pc[thread] += 4;
   }
@@ -666,6 +1115,7 @@ bool ExecutionUnit::sw(Warp *warp, std::vector<size_t> active_threads,
   assert(in->getNumOperands() == 3);
 
   if (!cu->can_put()) {
+    retry_reason = STALL_CU_QUEUE_FULL;
     return false;
   }
 
@@ -698,6 +1148,7 @@ bool ExecutionUnit::sh(Warp *warp, std::vector<size_t> active_threads,
   assert(in->getNumOperands() == 3);
 
   if (!cu->can_put()) {
+    retry_reason = STALL_CU_QUEUE_FULL;
     return false;
   }
 
@@ -730,6 +1181,7 @@ bool ExecutionUnit::sb(Warp *warp, std::vector<size_t> active_threads,
   assert(in->getNumOperands() == 3);
 
   if (!cu->can_put()) {
+    retry_reason = STALL_CU_QUEUE_FULL;
     return false;
   }
 
@@ -757,22 +1209,24 @@ bool ExecutionUnit::sb(Warp *warp, std::vector<size_t> active_threads,
   return true;
 }
 
-bool ExecutionUnit::amoadd_w(Warp *warp, std::vector<size_t> active_threads,
-                              MCInst *in) {
+bool ExecutionUnit::amo(Warp *warp, std::vector<size_t> active_threads,
+                        MCInst *in, AtomicOp op) {
   // my previous comment seemed to think that amoadd doesn't happen on memory
   // clearly i was somewhat confused
   assert(in->getNumOperands() >= 3);
 
   if (!cu->can_put()) {
+    retry_reason = STALL_CU_QUEUE_FULL;
     return false;
   }
 
   std::vector<uint64_t> addresses;
-  std::vector<int> add_values;
+  std::vector<int> operands;
   std::vector<size_t> valid_threads;
+  // The MCInst holds rd, rs1 (the address), rs2, unlike the assembly order
   unsigned int rd = in->getOperand(0).getReg();
-  unsigned int rs2_reg = in->getOperand(1).getReg();
-  unsigned int rs1_reg = in->getOperand(2).getReg();
+  unsigned int rs1_reg = in->getOperand(1).getReg();
+  unsigned int rs2_reg = in->getOperand(2).getReg();
   int64_t offset = 0;
   if (in->getNumOperands() >= 4) {
     offset = in->getOperand(3).getImm();
@@ -784,11 +1238,11 @@ bool ExecutionUnit::amoadd_w(Warp *warp, std::vector<size_t> active_threads,
     uint64_t rs1_64 = static_cast<uint32_t>(rs1);
     uint64_t addr = rs1_64 + static_cast<uint64_t>(static_cast<int64_t>(offset));
     addresses.push_back(addr);
-    add_values.push_back(rs2);
+    operands.push_back(rs2);
     valid_threads.push_back(thread);
   }
 
-  cu->atomic_add(warp, addresses, WORD_SIZE, rd, add_values, valid_threads);
+  cu->atomic(warp, addresses, WORD_SIZE, rd, op, operands, valid_threads);
   for (auto thread : valid_threads) {
     warp->pc[thread] += 4;
   }
@@ -1028,6 +1482,7 @@ bool ExecutionUnit::remu(Warp *warp, std::vector<size_t> active_threads,
   }
 
   if (!cu->can_use_divider()) {
+    retry_reason = STALL_DIVIDER_BUSY;
     return false;
   }
   cu->acquire_divider(warp);
@@ -1064,6 +1519,7 @@ bool ExecutionUnit::divu(Warp *warp, std::vector<size_t> active_threads,
   }
 
   if (!cu->can_use_divider()) {
+    retry_reason = STALL_DIVIDER_BUSY;
     return false;
   }
   cu->acquire_divider(warp);
@@ -1105,6 +1561,7 @@ bool ExecutionUnit::div_(Warp *warp, std::vector<size_t> active_threads,
   }
 
   if (!cu->can_use_divider()) {
+    retry_reason = STALL_DIVIDER_BUSY;
     return false;
   }
   cu->acquire_divider(warp);
@@ -1152,6 +1609,7 @@ bool ExecutionUnit::rem_(Warp *warp, std::vector<size_t> active_threads,
   }
 
   if (!cu->can_use_divider()) {
+    retry_reason = STALL_DIVIDER_BUSY;
     return false;
   }
   cu->acquire_divider(warp);
@@ -1175,10 +1633,66 @@ bool ExecutionUnit::rem_(Warp *warp, std::vector<size_t> active_threads,
   return false;
 }
 
+bool ExecutionUnit::fpu(Warp *warp, std::vector<size_t> active_threads,
+                        MCInst *in, FpOp op) {
+  unsigned int rd = in->getOperand(0).getReg();
+  // Register sources follow rd; a trailing immediate is the rounding mode
+  std::vector<unsigned int> srcs;
+  int64_t rm = 7;
+  for (unsigned i = 1; i < in->getNumOperands(); i++) {
+    const MCOperand &operand = in->getOperand(i);
+    if (operand.isReg()) {
+      srcs.push_back(operand.getReg());
+    } else if (operand.isImm()) {
+      rm = operand.getImm();
+    }
+  }
+  assert(!srcs.empty() && active_threads.size() <= NUM_LANES);
+
+  bool iterative = op == FP_DIV || op == FP_SQRT;
+  if (!warp->is_cpu && !(iterative ? cu->can_use_fp_divider() : cu->can_use_fpu())) {
+    retry_reason = STALL_FPU_BUSY;
+    return false;
+  }
+
+  std::array<uint32_t, NUM_LANES> a{}, b{}, c{}, out{};
+  std::array<uint32_t, NUM_LANES> *operands[] = {&a, &b, &c};
+  size_t n = active_threads.size();
+  for (size_t s = 0; s < srcs.size() && s < 3; s++) {
+    for (size_t i = 0; i < n; i++) {
+      (*operands[s])[i] = static_cast<uint32_t>(
+          rf->get_register(warp->warp_id, active_threads[i], srcs[s], warp->is_cpu));
+    }
+  }
+  fp_kernel(op, rm, a.data(), b.data(), c.data(), out.data(), n);
+
+  if (warp->is_cpu) {
+    for (size_t i = 0; i < n; i++) {
+      rf->set_register(warp->warp_id, active_threads[i], rd, static_cast<int>(out[i]), warp->is_cpu);
+      warp->pc[active_threads[i]] += 4;
+    }
+    return n > 0;
+  }
+
+  if (iterative) {
+    cu->acquire_fp_divider(warp);
+  } else {
+    cu->acquire_fpu(warp);
+  }
+  std::map<size_t, int> results;
+  for (size_t i = 0; i < n; i++) {
+    results[active_threads[i]] = static_cast<int>(out[i]);
+    warp->pc[active_threads[i]] += 4;
+  }
+  cu->suspend_for_func_unit(warp, fp_latency(op), rd, results);
+  return false;
+}
+
 bool ExecutionUnit::fence(Warp *warp, std::vector<size_t> active_threads,
                           MCInst *in) {
   // check canPut before accepting memory fence request
   if (!cu->can_put()) {
+    retry_reason = STALL_CU_QUEUE_FULL;
     return false;
   }
 
@@ -1285,9 +1799,9 @@ bool ExecutionUnit::csrrw(Warp *warp, std::vector<size_t> active_threads,
     } break;
     case 0x820: {
       // SIMTCanPut: Read-only CSR, returns 1 if can put (queue not full), 0 if can't put
-      // If the GPU is inactive, then the CPU can issue a new SIMT request
-      bool active = gpu_controller->is_gpu_active();
-      int can_put = active ? 0 : 1;
+      // The CPU can issue a new SIMT request if the GPU is inactive or,
+      // with --launch-queue, the launch queue has room
+      int can_put = gpu_controller->can_put() ? 1 : 0;
       rf->set_register(warp->warp_id, thread, rd_reg, can_put, warp->is_cpu);
     } break;
     case 0x821: {
@@ -1304,7 +1818,10 @@ bool ExecutionUnit::csrrw(Warp *warp, std::vector<size_t> active_threads,
       // launch kernel is the big one
       if (rs1_val != 0) {
         gpu_controller->set_pc(rs1_val);
-        gpu_controller->launch_kernel();
+        if (!gpu_controller->launch_kernel()) {
+          // The launch queue is full: the pc stays put, so the CSR is retried
+          continue;
+        }
       }
 
       rf->set_register(warp->warp_id, thread, rd_reg, 0, warp->is_cpu);
@@ -1361,6 +1878,12 @@ bool ExecutionUnit::csrrw(Warp *warp, std::vector<size_t> active_threads,
       gpu_controller->set_stat_value(stat_val);
       rf->set_register(warp->warp_id, thread, rd_reg, 0, warp->is_cpu);
     } break;
+    case 0x829: {
+      // SIMTSetGridDims: Write-only CSR, (gridDim.y << 16) | gridDim.x for the
+      // hardware block dispatcher; 0 leaves the blocks to the runtime
+      gpu_controller->set_dims(static_cast<uint32_t>(rs1_val));
+      rf->set_register(warp->warp_id, thread, rd_reg, 0, warp->is_cpu);
+    } break;
     case 0x830: {
       // CSR 0x830: SIMT barrier/termination command
       std::optional<int> old_csr_val = rf->get_csr(warp->warp_id, thread, 0x830);
@@ -1412,6 +1935,11 @@ bool ExecutionUnit::csrrw(Warp *warp, std::vector<size_t> active_threads,
       int args_32 = static_cast<int>(args_u32);
       rf->set_register(warp->warp_id, thread, rd_reg, args_32, warp->is_cpu);
     } break;
+    case 0x832: {
+      // SIMTBlockIdx: Read-only CSR, (blockIdx.y << 16) | blockIdx.x of the warp's block
+      uint32_t block = gpu_controller->get_block_index(warp->warp_id);
+      rf->set_register(warp->warp_id, thread, rd_reg, static_cast<int>(block), warp->is_cpu);
+    } break;
     case 0xc00: {
       // Cycle: Read-only CSR, cycle count (lower 32 bits)
       uint64_t cycles = GPUStatisticsManager::instance().get_gpu_cycles();
@@ -1468,8 +1996,17 @@ bool ExecutionUnit::noclpop(Warp *warp, std::vector<size_t> active_threads,
 bool ExecutionUnit::cache_line_flush(Warp *warp,
                                      std::vector<size_t> active_threads,
                                      MCInst *in) {
+  // Only the L1 data cache holds lines; without it this is a no-op
+  if (in->getNumOperands() == 1) {
+    unsigned int base = in->getOperand(0).getReg();
+    std::vector<uint64_t> addresses;
+    for (auto thread : active_threads) {
+      int rs1 = rf->get_register(warp->warp_id, thread, base, warp->is_cpu);
+      addresses.push_back(static_cast<uint32_t>(rs1));
+    }
+    cu->flush_lines(warp, addresses, active_threads);
+  }
   for (auto thread : active_threads) {
-    // TODO: Implement this function
     warp->pc[thread] += 4;
   }
   return false;
@@ -1483,6 +2020,22 @@ ExecuteSuspend::ExecuteSuspend(CoalescingUnit *cu, RegisterFile *rf,
   log("Execute/Suspend", "Initializing execute/suspend pipeline stage");
 }
 
+// Registers an instruction reads or writes, for the load scoreboard
+static std::vector<unsigned int> register_operands(const MCInst &inst) {
+  std::vector<unsigned int> regs;
+  for (const MCOperand &op : inst) {
+    if (op.isReg() && op.getReg() != RISCV::X0) {
+      regs.push_back(op.getReg());
+    }
+  }
+  return regs;
+}
+
+static bool is_load(const std::string &mnemonic) {
+  return mnemonic == "LW" || mnemonic == "LH" || mnemonic == "LHU" || mnemonic == "LB" ||
+         mnemonic == "LBU";
+}
+
 void ExecuteSuspend::execute() {
   // Check if we have a warp to process (either new or retrying)
   if (!PipelineStage::input_latch->updated)
@@ -1493,22 +2046,63 @@ void ExecuteSuspend::execute() {
   std::vector<size_t> active_threads =
       PipelineStage::input_latch->active_threads;
 
+  PCProfiler &profiler = PCProfiler::instance();
+  bool profiling = profiler.is_enabled() && !warp->is_cpu;
+  uint64_t inst_pc = 0;
+  if (profiling || reconvergence) {
+    inst_pc = active_threads.empty() ? warp->pc[0] : warp->pc[active_threads[0]];
+  }
+
   // suspension bubble when a suspended warp reaches the execute stage
+  bool was_suspended = warp->suspended;
   if (warp->suspended && !warp->is_cpu) {
     GPUStatisticsManager::instance().increment_gpu_susps();
+    if (profiling) {
+      profiler.record_suspension_bubble(warp->warp_id);
+    }
   }
 
   bool was_terminated_before = warp->finished[0];
 
-  execute_result result = eu->execute(warp, active_threads, inst);
+  // With --load-scoreboard the instruction may have to wait for a load
+  bool scoreboard_stall = false;
+  size_t outstanding_loads = 0;
+  if (!was_suspended && cu && cu->uses_scoreboard(warp)) {
+    outstanding_loads = cu->outstanding_loads(warp);
+    scoreboard_stall = cu->wait_for_scoreboard(
+        warp, register_operands(inst), is_load(disasm->getOpcodeName(inst.getOpcode())));
+  }
+
+  execute_result result = scoreboard_stall ? execute_result{false, false, false}
+                                           : eu->execute(warp, active_threads, inst);
 
   if (!was_terminated_before && warp->finished[0] &&
       notify_warp_terminated && !warp->is_cpu) {
-    notify_warp_terminated();
+    notify_warp_terminated(warp);
+  }
+
+  if (profiling && !was_suspended && (warp->suspended || warp->in_barrier)) {
+    profiler.record_stall(warp->warp_id, inst_pc);
+  }
+
+  if (!warp->is_cpu) {
+    // A suspension bubble is charged to what the warp is waiting for
+    StallReason outcome = STALL_NONE;
+    if (was_suspended) {
+      outcome = cu && cu->is_waiting_for_func_unit(warp) ? STALL_FUNC_UNIT : STALL_MEMORY;
+    } else if (scoreboard_stall) {
+      outcome = STALL_MEMORY;
+    } else if (!result.success && !warp->suspended) {
+      outcome = eu->get_retry_reason();
+    }
+    GPUStatisticsManager::instance().set_execute_slot(warp->warp_id, outcome);
   }
 
   if (!result.success && !warp->suspended && !warp->is_cpu) {
     GPUStatisticsManager::instance().increment_gpu_retries();
+    if (profiling) {
+      profiler.record_retry(inst_pc);
+    }
     if (instr_tracer) {
       TraceEvent event;
       event.cycle = GPUStatisticsManager::instance().get_gpu_cycles();
@@ -1531,7 +2125,11 @@ void ExecuteSuspend::execute() {
     }
   }
 
-  if (instr_tracer && !warp->is_cpu) {
+  if (reconvergence && !warp->is_cpu && !was_suspended && !scoreboard_stall) {
+    reconvergence->diverge(warp, inst_pc, active_threads);
+  }
+
+  if (instr_tracer && !warp->is_cpu && !scoreboard_stall) {
     uint64_t cycle = GPUStatisticsManager::instance().get_gpu_cycles();
     for (size_t tid : active_threads) {
       if (tid < warp->pc.size()) {
@@ -1549,6 +2147,12 @@ void ExecuteSuspend::execute() {
   if (result.success && result.counted) {
     if (!warp->is_cpu) {
       GPUStatisticsManager::instance().increment_gpu_instrs(active_threads.size());
+      if (outstanding_loads > 0) {
+        GPUStatisticsManager::instance().increment_scoreboard(SB_OVERLAPPED_INSTRS);
+      }
+      if (profiling) {
+        profiler.record_instr(inst_pc);
+      }
     } else {
       GPUStatisticsManager::instance().increment_cpu_instrs();
     }
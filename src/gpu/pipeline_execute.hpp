@@ -5,6 +5,7 @@
 #include "trace/trace.hpp"
 #include "stats/stats.hpp"
 #include "pipeline_warp_scheduler.hpp"
+#include "reconvergence.hpp"
 #include "register_file.hpp"
 #include "utils.hpp"
 
@@ -14,6 +15,21 @@ typedef struct execute_result {
   bool counted;
 } execute_result;
 
+// Zfinx single-precision ops, which read and write the integer registers
+enum FpOp {
+  FP_ADD, FP_SUB, FP_MUL, FP_DIV, FP_SQRT, FP_MIN, FP_MAX,
+  FP_MADD, FP_MSUB, FP_NMADD, FP_NMSUB,
+  FP_SGNJ, FP_SGNJN, FP_SGNJX, FP_EQ, FP_LT, FP_LE, FP_CLASS,
+  FP_CVT_W_S, FP_CVT_WU_S, FP_CVT_S_W, FP_CVT_S_WU
+};
+
+// Zbb bit-manipulation ops, all single-cycle on the ALU
+enum BitOp {
+  BIT_CLZ, BIT_CTZ, BIT_CPOP, BIT_SEXT_B, BIT_SEXT_H, BIT_ZEXT_H, BIT_REV8, BIT_ORC_B,
+  BIT_MIN, BIT_MINU, BIT_MAX, BIT_MAXU, BIT_ANDN, BIT_ORN, BIT_XNOR,
+  BIT_ROL, BIT_ROR, BIT_RORI
+};
+
 /*
  * The Execution Unit is the unit that handles the actual
  * computation and production of side-effects of instructions
@@ -32,16 +48,36 @@ public:
       ::log(name, message);
   }
 
+  // Why the last execute() asked for a retry
+  StallReason get_retry_reason() const { return retry_reason; }
+
 private:
   CoalescingUnit *cu;
   RegisterFile *rf;
   LLVMDisassembler *disasm;
   HostGPUControl *gpu_controller;
   bool debug_enabled = true;
+  StallReason retry_reason = STALL_RETRY;
+  // The last execute() sent a load to the coalescing unit
+  bool load_issued = false;
+  bool scalarize;
+
+  struct ScalarInfo {
+    bool uniform = false;        // Every register source is uniform across the warp
+    bool execute_once = false;   // A uniform ALU op, computed by one lane
+    bool affine_access = false;  // The base register strides by the access size
+  };
+  ScalarInfo classify_operands(Warp *warp, const std::string &mnemonic, MCInst &inst);
+  // Copies rd and the PC of lanes[0] to the other lanes
+  void broadcast(Warp *warp, const std::vector<size_t> &lanes, MCInst &inst);
   bool add(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in);
   bool addi(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in);
   bool sub(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in);
   bool mul(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in);
+  // MULH, MULHSU and MULHU: the upper word of the 64-bit product, on the multiplier
+  bool mulh(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in,
+            bool rs1_signed, bool rs2_signed);
+  bool bitmanip(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in, BitOp op);
   bool and_(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in);
   bool andi(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in);
   bool or_(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in);
@@ -64,7 +100,7 @@ private:
   bool sw(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in);
   bool sh(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in);
   bool sb(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in);
-  bool amoadd_w(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in);
+  bool amo(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in, AtomicOp op);
   bool jal(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in);
   bool jalr(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in);
   bool beq(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in);
@@ -81,6 +117,8 @@ private:
   bool divu(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in);
   bool div_(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in);
   bool rem_(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in);
+  // Every Zfinx op goes through the FPU model
+  bool fpu(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in, FpOp op);
   bool fence(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in);
   bool ecall(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in);
   bool ebreak(Warp *warp, std::vector<size_t> active_threads, llvm::MCInst *in);
@@ -105,7 +143,7 @@ class ExecuteSuspend : public PipelineStage {
 public:
   std::function<void(Warp *warp)> insert_warp;
   std::function<void(Warp *warp)> insert_warp_retry;
-  std::function<void()> notify_warp_terminated;
+  std::function<void(Warp *warp)> notify_warp_terminated;
   ExecuteSuspend(CoalescingUnit *cu, RegisterFile *rf, uint64_t max_addr,
                  LLVMDisassembler *disasm, HostGPUControl *gpu_controller);
   void execute() override;
@@ -116,6 +154,9 @@ public:
   bool is_active() override;
   ExecutionUnit *get_execution_unit() { return eu; }
   void set_instr_tracer(Tracer *t) { instr_tracer = t; }
+  void set_reconvergence(std::shared_ptr<const ReconvergenceTable> table) {
+    reconvergence = std::move(table);
+  }
   ~ExecuteSuspend();
 
 private:
@@ -124,4 +165,5 @@ private:
   LLVMDisassembler *disasm;
   uint64_t max_addr;
   Tracer *instr_tracer = nullptr;
+  std::shared_ptr<const ReconvergenceTable> reconvergence;
 };
\ No newline at end of file
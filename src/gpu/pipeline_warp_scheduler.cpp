@@ -5,9 +5,10 @@
 
 WarpScheduler::WarpScheduler(int warp_size, int warp_count, uint64_t start_pc,
                              CoalescingUnit *cu, bool start_active)
-    : warp_size(warp_size), warp_count(warp_count), cu(cu), warps_per_block(0),
+    : warp_size(warp_size), warp_count(warp_count),
+      policy(make_warp_policy(Config::instance().warpScheduler())), warps_per_block(0),
       barrier_release_state(0), barrier_shift_reg(0), release_warp_id(0),
-      release_warp_count(0), release_success(false), barrier_bits(0) {
+      release_warp_count(0), release_success(false), barrier_bits(0), cu(cu) {
   log("Warp Scheduler", "Initializing warp scheduling pipeline stage");
   if (start_active) {
     for (int i = 0; i < warp_count; i++) {
@@ -30,34 +31,6 @@ void WarpScheduler::flush_new_warps() {
   }
 }
 
-uint64_t WarpScheduler::firstHot(uint64_t x) {
-  return x & (~x + 1);
-}
-
-std::pair<uint64_t, uint64_t> WarpScheduler::fair_scheduler(uint64_t hist, uint64_t avail) {
-  uint64_t first = firstHot(avail & ~hist);
-  
-  if (first != 0) {
-    // Found an available warp not in history. add to history and choose it
-    return std::make_pair(hist | first, first);
-  } else {
-    // All available warps are in history. choose first available and reset history
-    uint64_t second = firstHot(avail);
-    return std::make_pair(second, second);
-  }
-}
-
-uint64_t WarpScheduler::random_scheduler(uint64_t avail) {
-  std::vector<int> free_warps;
-  for (int i = 0; i < 64; i++) {
-    if (avail & 1) free_warps.push_back(i);
-    avail >>= 1;
-  }
-  // Apparently, this might be kind of dodgy since rand() is poor quality on simple impls
-  int choice = rand() % free_warps.size();
-  return (uint64_t) 1 << free_warps[choice];
-}
-
 void WarpScheduler::execute() {
   warp_issued_this_cycle = false;
 
@@ -90,11 +63,23 @@ void WarpScheduler::execute() {
   retry_extra_ready.swap(retry_extra_delay_queue);
 
   barrier_bits = 0;
+  uint64_t stalled = 0;
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
   for (const auto& [warp_id, warp] : all_warps) {
-    if (!warp->is_cpu && !warp->finished[0] && warp->in_barrier) {
+    if (warp->is_cpu || warp->finished[0]) {
+      continue;
+    }
+    if (warp->in_barrier) {
       if (warp_id < 64) {
         barrier_bits |= (1ULL << warp_id);
       }
+      stats.set_warp_state(warp_id, STALL_BARRIER);
+    } else if (warp->suspended) {
+      stalled |= 1ULL << warp_id;
+      bool func_unit = cu && cu->is_waiting_for_func_unit(warp);
+      stats.set_warp_state(warp_id, func_unit ? STALL_FUNC_UNIT : STALL_MEMORY);
+    } else {
+      stats.set_warp_state(warp_id, STALL_PIPELINE);
     }
   }
   
@@ -124,14 +109,7 @@ void WarpScheduler::execute() {
   if (chosen_warp_buffer == nullptr) {
     uint64_t chosen_bitmask = 0;
     if (avail != 0) {
-      WarpSchedulerConfig scheduler_choice = Config::instance().warpScheduler();
-      if (scheduler_choice == BASELINE) {
-        std::pair<uint64_t, uint64_t> result = fair_scheduler(sched_history, avail);
-        sched_history = result.first;
-        chosen_bitmask = result.second;
-      } else if (scheduler_choice == RANDOM) {
-        chosen_bitmask = random_scheduler(avail);
-      }
+      chosen_bitmask = policy->choose(avail, stalled | barrier_bits);
     }
 
     Warp *chosen_warp = nullptr;
@@ -154,8 +132,10 @@ void WarpScheduler::execute() {
 
     if (chosen_warp != nullptr) {
       chosen_warp_buffer = chosen_warp;
+      policy->issued(chosen_warp->warp_id);
       log("Warp Scheduler",
-          "Warp " + std::to_string(chosen_warp->warp_id) + " chosen (substage 1, fair scheduler)");
+          "Warp " + std::to_string(chosen_warp->warp_id) + " chosen (substage 1, " +
+              warp_scheduler_name(Config::instance().warpScheduler()) + " scheduler)");
     }
   }
 }
@@ -287,8 +267,11 @@ void WarpScheduler::set_warps_per_block(unsigned n) {
 WarpScheduler::~WarpScheduler() {
   flush_new_warps();
 
+  // GPU warps belong to the HostGPUControl warp pool
   while (warp_queue.size() > 0) {
-    delete warp_queue.front();
+    if (warp_queue.front()->is_cpu) {
+      delete warp_queue.front();
+    }
     warp_queue.pop();
   }
   while (reinsert_delay_queue.size() > 0) reinsert_delay_queue.pop();
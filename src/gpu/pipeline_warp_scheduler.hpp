@@ -2,13 +2,15 @@
 
 #include "pipeline.hpp"
 #include "utils.hpp"
+#include "warp_policy.hpp"
 
 // Forward declaration
 class CoalescingUnit;
 
 /*
  * Represents the warp scheduler unit in the pipeline
- * It will use a Fair Scheduler to initially match SIMTight's
+ * By default it uses a Fair Scheduler to match SIMTight's; see
+ * warp_policy.hpp for the alternatives
  */
 class WarpScheduler : public PipelineStage {
 public:
@@ -42,9 +44,8 @@ private:
   // 2nd substage: Output chosen warp
   Warp *chosen_warp_buffer = nullptr;  // Buffer between substage 1 and 2
 
-  // Fair scheduler state
-  // History bitmask: bit i set means warp i was recently scheduled
-  uint64_t sched_history = 0;
+  // Picks among the ready warps; chosen by Config::warpScheduler()
+  std::unique_ptr<WarpSchedulingPolicy> policy;
 
   // Barrier release unit state
   unsigned warps_per_block = 0;
@@ -58,9 +59,6 @@ private:
 
   CoalescingUnit *cu;
 
-  static uint64_t firstHot(uint64_t x);
-  std::pair<uint64_t, uint64_t> fair_scheduler(uint64_t hist, uint64_t avail);
-  uint64_t random_scheduler(uint64_t avail);
   void flush_new_warps();
   void barrier_release_unit();
 };
\ No newline at end of file
@@ -88,6 +88,17 @@ void WritebackResume::execute() {
       rf->pretty_print(warp->warp_id);
     return;
   }
+
+  // Otherwise the write port takes the data of a non-blocking load
+  auto completed = cu->pop_completed_load(is_cpu_pipeline);
+  if (completed) {
+    for (const auto &[thread_id, value] : completed->results) {
+      rf->set_register(completed->warp->warp_id, thread_id, completed->rd_reg, value,
+                       completed->warp->is_cpu);
+    }
+    log("Writeback/Resume", "Warp " + std::to_string(completed->warp->warp_id) +
+                                " load data written back");
+  }
 };
 
 bool WritebackResume::is_active() {
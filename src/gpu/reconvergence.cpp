@@ -0,0 +1,184 @@
+#include "reconvergence.hpp"
+#include "disassembler/llvm_disasm.hpp"
+#include "mem/mem_instr.hpp"
+#include <map>
+
+ReconvergenceTable::ReconvergenceTable(InstructionMemory *im, LLVMDisassembler *disasm)
+    : base_addr(im->get_base_addr()) {
+  uint64_t max_addr = im->get_max_addr();
+  size_t count = (max_addr - base_addr) / 4 + 1;
+  std::vector<std::vector<int64_t>> succs(count);
+
+  auto index = [&](uint64_t target) -> int64_t {
+    if (target < base_addr || target > max_addr || (target - base_addr) % 4) return -1;
+    return (target - base_addr) / 4;
+  };
+  for (size_t i = 0; i < count; i++) {
+    uint64_t pc = base_addr + i * 4;
+    llvm::ArrayRef<uint8_t> code_ref(im->get_instruction(pc), 4);
+    llvm::MCInst inst = disasm->disasm_inst(0, code_ref);
+    std::string mnemonic = disasm->getOpcodeName(inst.getOpcode());
+
+    if (mnemonic == "BEQ" || mnemonic == "BNE" || mnemonic == "BLT" || mnemonic == "BLTU" ||
+        mnemonic == "BGE" || mnemonic == "BGEU") {
+      succs[i] = {index(pc + 4), index(pc + inst.getOperand(2).getImm())};
+    } else if (mnemonic == "JAL" && inst.getOperand(0).getReg() == llvm::RISCV::X0) {
+      succs[i] = {index(pc + inst.getOperand(1).getImm())};
+    } else if (mnemonic == "JALR" && inst.getOperand(0).getReg() == llvm::RISCV::X0) {
+      succs[i] = {-1};
+    } else {
+      // Calls return to the next instruction
+      succs[i] = {index(pc + 4)};
+    }
+  }
+  reconvergence_pc = compute(base_addr, succs, &block_count);
+  debug_log("IPDOM reconvergence: " + std::to_string(block_count) + " basic blocks");
+}
+
+std::vector<uint64_t> ReconvergenceTable::compute(uint64_t base_addr,
+                                                  const std::vector<std::vector<int64_t>> &succs,
+                                                  size_t *block_count) {
+  size_t count = succs.size();
+
+  // Basic blocks: start at the entry, at jump targets and after anything
+  // that does not just fall through
+  std::vector<bool> leader(count, false);
+  if (count) leader[0] = true;
+  for (size_t i = 0; i < count; i++) {
+    bool falls_through = succs[i].size() == 1 && succs[i][0] == static_cast<int64_t>(i + 1);
+    if (falls_through) continue;
+    for (int64_t s : succs[i]) {
+      if (s >= 0) leader[s] = true;
+    }
+    if (i + 1 < count) leader[i + 1] = true;
+  }
+  std::vector<size_t> block_of(count);
+  std::vector<size_t> block_start;
+  for (size_t i = 0; i < count; i++) {
+    if (leader[i]) block_start.push_back(i);
+    block_of[i] = block_start.size() - 1;
+  }
+  size_t blocks = block_start.size();
+  size_t exit = blocks;
+  if (block_count) *block_count = blocks;
+
+  // Reverse CFG with a virtual exit node: preds[b] are b's successors
+  std::vector<std::vector<size_t>> rev_succs(blocks + 1), rev_preds(blocks + 1);
+  for (size_t b = 0; b < blocks; b++) {
+    size_t last = (b + 1 < blocks ? block_start[b + 1] : count) - 1;
+    for (int64_t s : succs[last]) {
+      size_t to = s >= 0 ? block_of[s] : exit;
+      rev_succs[to].push_back(b);
+      rev_preds[b].push_back(to);
+    }
+  }
+
+  // Postorder of the reverse CFG from the exit (iterative DFS)
+  std::vector<int64_t> po_num(blocks + 1, -1);
+  std::vector<size_t> postorder;
+  std::vector<bool> visited(blocks + 1, false);
+  std::vector<std::pair<size_t, size_t>> stack = {{exit, 0}};
+  visited[exit] = true;
+  while (!stack.empty()) {
+    auto &[node, next] = stack.back();
+    if (next < rev_succs[node].size()) {
+      size_t child = rev_succs[node][next++];
+      if (!visited[child]) {
+        visited[child] = true;
+        stack.push_back({child, 0});
+      }
+    } else {
+      po_num[node] = postorder.size();
+      postorder.push_back(node);
+      stack.pop_back();
+    }
+  }
+
+  // Cooper, Harvey and Kennedy's iterative dominator algorithm
+  std::vector<int64_t> ipdom(blocks + 1, -1);
+  ipdom[exit] = exit;
+  auto intersect = [&](int64_t a, int64_t b) {
+    while (a != b) {
+      while (po_num[a] < po_num[b]) a = ipdom[a];
+      while (po_num[b] < po_num[a]) b = ipdom[b];
+    }
+    return a;
+  };
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t k = postorder.size(); k-- > 0;) {
+      size_t b = postorder[k];
+      if (b == exit) continue;
+      int64_t new_ipdom = -1;
+      for (size_t p : rev_preds[b]) {
+        if (ipdom[p] < 0) continue;
+        new_ipdom = new_ipdom < 0 ? p : intersect(p, new_ipdom);
+      }
+      if (new_ipdom != ipdom[b]) {
+        ipdom[b] = new_ipdom;
+        changed = true;
+      }
+    }
+  }
+
+  // Within a block lanes can only split on a retry, and meet again at
+  // the next instruction
+  std::vector<uint64_t> result(count);
+  for (size_t i = 0; i < count; i++) {
+    size_t b = block_of[i];
+    bool last = i + 1 == count || leader[i + 1];
+    if (!last) {
+      result[i] = base_addr + (i + 1) * 4;
+    } else if (ipdom[b] < 0 || static_cast<size_t>(ipdom[b]) == exit) {
+      result[i] = NO_RECONVERGENCE;
+    } else {
+      result[i] = base_addr + block_start[ipdom[b]] * 4;
+    }
+  }
+  return result;
+}
+
+uint64_t ReconvergenceTable::get_reconvergence_pc(uint64_t pc) const {
+  uint64_t i = (pc - base_addr) / 4;
+  if (pc < base_addr || i >= reconvergence_pc.size()) return NO_RECONVERGENCE;
+  return reconvergence_pc[i];
+}
+
+uint64_t ReconvergenceTable::select_lanes(Warp *warp) const {
+  auto &stack = warp->reconvergence_stack;
+  while (!stack.empty()) {
+    const ReconvergenceEntry &top = stack.back();
+    uint64_t running = 0;
+    for (uint64_t mask = top.lanes; mask; mask &= mask - 1) {
+      size_t lane = __builtin_ctzll(mask);
+      if (!warp->finished[lane] && warp->pc[lane] != top.rpc) {
+        running |= 1ULL << lane;
+      }
+    }
+    if (running) return running;
+    stack.pop_back();
+  }
+  return warp->size >= 64 ? UINT64_MAX : (1ULL << warp->size) - 1;
+}
+
+void ReconvergenceTable::diverge(Warp *warp, uint64_t pc,
+                                 const std::vector<size_t> &active_threads) const {
+  // Lanes grouped by where they went, lowest PC first
+  std::map<uint64_t, uint64_t> paths;
+  for (size_t lane : active_threads) {
+    if (!warp->finished[lane]) {
+      paths[warp->pc[lane]] |= 1ULL << lane;
+    }
+  }
+  if (paths.size() < 2) return;
+
+  // Lanes already at the reconvergence PC wait in the enclosing entry;
+  // the lowest PC is pushed last so it runs first
+  uint64_t rpc = get_reconvergence_pc(pc);
+  for (auto it = paths.rbegin(); it != paths.rend(); ++it) {
+    if (it->first != rpc) {
+      warp->reconvergence_stack.push_back({rpc, it->second});
+    }
+  }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "pipeline.hpp"
+
+class InstructionMemory;
+class LLVMDisassembler;
+
+/*
+ * Immediate post-dominator (IPDOM) reconvergence, the alternative to
+ * NoCL's nesting levels (--reconvergence=ipdom).
+ *
+ * A control flow graph is built once from the kernel code. Branches and
+ * JAL x0 end a basic block, calls fall through, and JALR x0 (returns,
+ * indirect jumps) leads to the exit. The immediate post-dominator of each
+ * block is where lanes that diverged at its last instruction meet again.
+ *
+ * When lanes of a warp end up at different PCs after an instruction, each
+ * group that is not already at the reconvergence PC gets an entry on the
+ * warp's reconvergence stack. Only the lanes of the top entry may issue,
+ * and the entry is popped once they have all reached its reconvergence PC
+ * (or finished).
+ */
+class ReconvergenceTable {
+public:
+  // Diverged at a branch that no block post-dominates (e.g. multiple
+  // returns): the paths only reconverge when their lanes finish
+  static constexpr uint64_t NO_RECONVERGENCE = UINT64_MAX;
+
+  ReconvergenceTable(InstructionMemory *im, LLVMDisassembler *disasm);
+
+  uint64_t get_reconvergence_pc(uint64_t pc) const;
+  size_t get_block_count() const { return block_count; }
+
+  // Pops paths that have reached their reconvergence PC and returns the
+  // lanes (bitmask) of the warp that may issue
+  uint64_t select_lanes(Warp *warp) const;
+  // Called after active_threads executed the instruction at pc
+  void diverge(Warp *warp, uint64_t pc, const std::vector<size_t> &active_threads) const;
+
+  /*
+   * Computes the reconvergence PC of every instruction from its
+   * successors (index into the code, -1 for leaving the kernel code).
+   * Exposed separately so it can be tested without an ELF.
+   */
+  static std::vector<uint64_t> compute(uint64_t base_addr,
+                                       const std::vector<std::vector<int64_t>> &succs,
+                                       size_t *block_count = nullptr);
+
+private:
+  uint64_t base_addr;
+  std::vector<uint64_t> reconvergence_pc;
+  size_t block_count = 0;
+};
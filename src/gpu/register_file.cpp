@@ -1,5 +1,6 @@
 #include "register_file.hpp"
 #include "config.hpp"
+#include "stats/stats.hpp"
 
 RegisterFile::RegisterFile(size_t register_count, size_t thread_count): 
     registers_per_warp(register_count), thread_count(thread_count) {
@@ -13,11 +14,84 @@ int get_register_idx(llvm::MCRegister reg) {
 
 void RegisterFile::ensure_warp_initialized(uint64_t warp_id) {
     if (warp_id_to_registers.find(warp_id) == warp_id_to_registers.end()) {
+        // Every register starts out as a uniform zero
         warp_id_to_registers[warp_id].resize(registers_per_warp);
-        for (auto &reg_vec : warp_id_to_registers[warp_id]) {
-            reg_vec.resize(thread_count, 0);
+        stored += registers_per_warp;
+        note_footprint();
+    }
+}
+
+/*
+ * The shape of a full vector of lanes. Unsigned arithmetic so strides
+ * wrap like the 32-bit registers do.
+ */
+static RegisterShape shape_of(const std::vector<int> &lanes) {
+    RegisterShape shape;
+    uint32_t base = static_cast<uint32_t>(lanes[0]);
+    uint32_t stride = lanes.size() > 1 ? static_cast<uint32_t>(lanes[1]) - base : 0;
+    for (size_t i = 2; i < lanes.size(); i++) {
+        if (static_cast<uint32_t>(lanes[i]) != base + static_cast<uint32_t>(i) * stride) {
+            return shape;
         }
     }
+    shape.tag = stride == 0 ? REG_UNIFORM : REG_AFFINE;
+    shape.base = static_cast<int>(base);
+    shape.stride = static_cast<int>(stride);
+    return shape;
+}
+
+int RegisterFile::lane_value(const VectorRegister &vreg, int thread) const {
+    switch (vreg.shape.tag) {
+    case REG_UNIFORM:
+        return vreg.shape.base;
+    case REG_AFFINE:
+        return static_cast<int>(static_cast<uint32_t>(vreg.shape.base) +
+                                static_cast<uint32_t>(thread) * static_cast<uint32_t>(vreg.shape.stride));
+    default:
+        return vreg.lanes[thread];
+    }
+}
+
+size_t RegisterFile::words(const VectorRegister &vreg) const {
+    switch (vreg.shape.tag) {
+    case REG_UNIFORM: return 1;
+    case REG_AFFINE: return 2;
+    default: return thread_count;
+    }
+}
+
+void RegisterFile::note_footprint() const {
+    if (!counting) return;
+    GPUStatisticsManager::instance().note_regfile_words(stored, full_words());
+}
+
+void RegisterFile::expand(VectorRegister &vreg) {
+    stored -= words(vreg);
+    vreg.lanes.resize(thread_count);
+    for (size_t i = 0; i < thread_count; i++) {
+        vreg.lanes[i] = lane_value(vreg, static_cast<int>(i));
+    }
+    vreg.shape = RegisterShape();
+    stored += thread_count;
+    if (counting && GPUStatisticsManager::instance().is_gpu_pipeline_active()) {
+        GPUStatisticsManager::instance().increment_regfile(RF_EXPANSIONS);
+    }
+    note_footprint();
+}
+
+void RegisterFile::compress(VectorRegister &vreg) {
+    RegisterShape shape = shape_of(vreg.lanes);
+    if (shape.tag == REG_VARYING) {
+        return;
+    }
+    vreg.shape = shape;
+    vreg.lanes.clear();
+    stored -= thread_count;
+    stored += words(vreg);
+    if (counting && GPUStatisticsManager::instance().is_gpu_pipeline_active()) {
+        GPUStatisticsManager::instance().increment_regfile(RF_COMPRESSIONS);
+    }
+    note_footprint();
 }
 
 int RegisterFile::get_register(uint64_t warp_id, int thread, int reg, bool is_cpu) {
@@ -25,7 +99,14 @@ int RegisterFile::get_register(uint64_t warp_id, int thread, int reg, bool is_cp
 
     if (reg == llvm::RISCV::X0) return 0;
     ensure_warp_initialized(warp_id);
-    return warp_id_to_registers[warp_id][get_register_idx(reg)][thread];
+    const VectorRegister &vreg = warp_id_to_registers[warp_id][get_register_idx(reg)];
+    if (counting && GPUStatisticsManager::instance().is_gpu_pipeline_active()) {
+        GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+        stats.increment_regfile(vreg.shape.tag == REG_UNIFORM  ? RF_UNIFORM_READS
+                                : vreg.shape.tag == REG_AFFINE ? RF_AFFINE_READS
+                                                               : RF_VARYING_READS);
+    }
+    return lane_value(vreg, thread);
 }
 
 void RegisterFile::set_register(uint64_t warp_id, int thread, int reg, int value, bool is_cpu) {
@@ -37,8 +118,30 @@ void RegisterFile::set_register(uint64_t warp_id, int thread, int reg, int value
     int reg_idx = get_register_idx(reg);
     if (reg_idx >= 0 && reg_idx < static_cast<int>(registers_per_warp) && 
         thread >= 0 && thread < static_cast<int>(thread_count)) {
-        warp_id_to_registers[warp_id][reg_idx][thread] = value;
+        VectorRegister &vreg = warp_id_to_registers[warp_id][reg_idx];
+        if (vreg.shape.tag != REG_VARYING) {
+            if (lane_value(vreg, thread) == value) return;
+            expand(vreg);
+        }
+        vreg.lanes[thread] = value;
+        // Lanes are written in order, so the last one completes a full-warp write
+        if (thread == static_cast<int>(thread_count) - 1) {
+            compress(vreg);
+        }
+    }
+}
+
+RegisterShape RegisterFile::get_shape(uint64_t warp_id, int reg) {
+    if (reg == llvm::RISCV::X0) {
+        return RegisterShape{REG_UNIFORM, 0, 0};
+    }
+    ensure_warp_initialized(warp_id);
+    VectorRegister &vreg = warp_id_to_registers[warp_id][get_register_idx(reg)];
+    if (vreg.shape.tag == REG_VARYING) {
+        // A divergent write may have left it expanded though it no longer varies
+        compress(vreg);
     }
+    return vreg.shape;
 }
 
 std::optional<int> RegisterFile::get_csr(uint64_t warp_id, int thread, int csr) {
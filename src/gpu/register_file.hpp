@@ -2,11 +2,35 @@
 
 #include "utils.hpp"
 
+// How a GPU register's value varies across the lanes of its warp
+enum RegisterTag {
+    REG_VARYING,
+    REG_UNIFORM,  // Every lane holds base
+    REG_AFFINE    // Lane i holds base + i * stride
+};
+
+struct RegisterShape {
+    RegisterTag tag = REG_VARYING;
+    int base = 0;
+    int stride = 0;
+};
+
+/*
+ * A GPU vector register as the backing store keeps it. Uniform and affine
+ * registers only hold their shape; the lanes are expanded when a write
+ * leaves them varying, and compressed again once a write to the last lane
+ * makes them uniform or affine.
+ */
+struct VectorRegister {
+    RegisterShape shape{REG_UNIFORM, 0, 0};
+    std::vector<int> lanes;  // Empty unless shape.tag is REG_VARYING
+};
+
 class RegisterFile {
 public:
     // This data structure represents a mapping from warp ID
-    // to a registers_per_warp wide vector of the register value in each thread
-    std::map<uint64_t, std::vector<std::vector<int>>> warp_id_to_registers;
+    // to a registers_per_warp wide vector of (compressed) vector registers
+    std::map<uint64_t, std::vector<VectorRegister>> warp_id_to_registers;
     std::map<uint64_t, std::vector<std::map<uint64_t, int>>> warp_id_to_csr;
     RegisterFile(size_t register_count, size_t thread_count);
     virtual int get_register(uint64_t warp_id, int thread, int reg, bool is_cpu = false);
@@ -14,9 +38,24 @@ public:
     virtual std::optional<int> get_csr(uint64_t warp_id, int thread, int csr);
     virtual void set_csr(uint64_t warp_id, int thread, int csr, int value);
     virtual void pretty_print(uint64_t warp_id);
+    // Classifies all lanes of a GPU register, like SIMTight's register compression
+    RegisterShape get_shape(uint64_t warp_id, int reg);
+    // Words the compressed registers take: 1 if uniform, 2 if affine, one per lane if varying
+    size_t stored_words() const { return stored; }
+    // Words the same registers take with every lane stored
+    size_t full_words() const { return warp_id_to_registers.size() * registers_per_warp * thread_count; }
+    // Counts the RF_* stats (--regfile-stats, --stats-json); off keeps lane accesses free of them
+    void set_stats(bool enabled) { counting = enabled; }
     ~RegisterFile();
 private:
     uint64_t registers_per_warp;
     size_t thread_count;
+    size_t stored = 0;
+    bool counting = false;
     void ensure_warp_initialized(uint64_t warp_id);
+    int lane_value(const VectorRegister &vreg, int thread) const;
+    void expand(VectorRegister &vreg);
+    void compress(VectorRegister &vreg);
+    size_t words(const VectorRegister &vreg) const;
+    void note_footprint() const;
 };
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "warp_policy.hpp"
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+uint64_t WarpSchedulingPolicy::nthHot(uint64_t x, unsigned n) {
+#ifdef __BMI2__
+  return _pdep_u64(1ULL << n, x);
+#else
+  for (unsigned i = 0; i < n; i++) {
+    x &= x - 1;
+  }
+  return firstHot(x);
+#endif
+}
+
+uint64_t WarpSchedulingPolicy::firstHotFrom(uint64_t x, unsigned start) {
+  uint64_t upper = start < 64 ? x & (~0ULL << start) : 0;
+  return firstHot(upper ? upper : x);
+}
+
+uint64_t FairPolicy::choose(uint64_t ready, uint64_t /*stalled*/) {
+  uint64_t first = firstHot(ready & ~history);
+  if (first != 0) {
+    // Found an available warp not in history. add to history and choose it
+    history |= first;
+    return first;
+  }
+  // All available warps are in history. choose first available and reset history
+  history = firstHot(ready);
+  return history;
+}
+
+uint64_t RandomPolicy::choose(uint64_t ready, uint64_t /*stalled*/) {
+  return nthHot(ready, rng.below(__builtin_popcountll(ready)));
+}
+
+uint64_t GreedyThenOldestPolicy::choose(uint64_t ready, uint64_t /*stalled*/) {
+  if (greedy_warp >= 0 && (ready >> greedy_warp) & 1) {
+    return 1ULL << greedy_warp;
+  }
+  return firstHot(ready);
+}
+
+uint64_t LooseRoundRobinPolicy::choose(uint64_t ready, uint64_t /*stalled*/) {
+  return firstHotFrom(ready, next_warp);
+}
+
+uint64_t TwoLevelPolicy::choose(uint64_t ready, uint64_t stalled) {
+  active &= ~stalled;
+  if ((ready & active) == 0) {
+    // Nothing in the pool can issue: what is left has finished or is still
+    // in the pipeline, so refill the pool from the ready warps
+    active = 0;
+  }
+  uint64_t pending = ready & ~active;
+  while (pending && static_cast<unsigned>(__builtin_popcountll(active)) < active_size) {
+    uint64_t promoted = firstHotFrom(pending, next_promote);
+    active |= promoted;
+    pending &= ~promoted;
+    next_promote = (__builtin_ctzll(promoted) + 1) % 64;
+  }
+  return firstHotFrom(ready & active, next_active);
+}
+
+std::unique_ptr<WarpSchedulingPolicy> make_warp_policy(WarpSchedulerConfig config) {
+  Config &cfg = Config::instance();
+  switch (config) {
+  case RANDOM:
+    return std::make_unique<RandomPolicy>(cfg.seed());
+  case GTO:
+    return std::make_unique<GreedyThenOldestPolicy>();
+  case LRR:
+    return std::make_unique<LooseRoundRobinPolicy>();
+  case TWO_LEVEL:
+    return std::make_unique<TwoLevelPolicy>(cfg.twoLevelActiveWarps());
+  case BASELINE:
+  default:
+    return std::make_unique<FairPolicy>();
+  }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include "config.hpp"
+#include "xoshiro.hpp"
+
+/*
+ * Decides which ready warp the warp scheduler issues next. Warps are
+ * passed as bitmasks (bit i is warp i):
+ *   ready   - may issue this cycle
+ *   stalled - suspended on memory/a functional unit or in a barrier
+ * Policies keep whatever per-warp history they need between calls.
+ */
+class WarpSchedulingPolicy {
+public:
+  virtual ~WarpSchedulingPolicy() = default;
+  // One-hot mask of the chosen warp; ready is never 0
+  virtual uint64_t choose(uint64_t ready, uint64_t stalled) = 0;
+  // The chosen warp left the scheduler for the pipeline
+  virtual void issued(unsigned /*warp_id*/) {}
+
+  static uint64_t firstHot(uint64_t x) { return x & (~x + 1); }
+  // One-hot mask of the n-th (from 0) set bit of x; n must be below popcount(x)
+  static uint64_t nthHot(uint64_t x, unsigned n);
+  // First set bit of x at or after position start, wrapping around
+  static uint64_t firstHotFrom(uint64_t x, unsigned start);
+};
+
+/*
+ * SIMTight's fair scheduler: the first ready warp that has not issued
+ * since the history was last cleared
+ */
+class FairPolicy : public WarpSchedulingPolicy {
+public:
+  uint64_t choose(uint64_t ready, uint64_t stalled) override;
+
+private:
+  // Bit i set means warp i was recently scheduled
+  uint64_t history = 0;
+};
+
+/*
+ * Uniformly random ready warp
+ */
+class RandomPolicy : public WarpSchedulingPolicy {
+public:
+  explicit RandomPolicy(uint64_t seed) : rng(seed) {}
+  uint64_t choose(uint64_t ready, uint64_t stalled) override;
+
+private:
+  Xoshiro256 rng;
+};
+
+/*
+ * Greedy-then-oldest: keep issuing the last warp while it is ready,
+ * otherwise the oldest ready one. All warps of a launch start together
+ * in warp id order, so the oldest is the lowest warp id.
+ */
+class GreedyThenOldestPolicy : public WarpSchedulingPolicy {
+public:
+  uint64_t choose(uint64_t ready, uint64_t stalled) override;
+  void issued(unsigned warp_id) override { greedy_warp = warp_id; }
+
+private:
+  int greedy_warp = -1;
+};
+
+/*
+ * Loose round-robin: the first ready warp after the last one issued
+ */
+class LooseRoundRobinPolicy : public WarpSchedulingPolicy {
+public:
+  uint64_t choose(uint64_t ready, uint64_t stalled) override;
+  void issued(unsigned warp_id) override { next_warp = (warp_id + 1) % 64; }
+
+private:
+  unsigned next_warp = 0;
+};
+
+/*
+ * Two-level scheduling: only warps in a small active pool can issue,
+ * round-robin among themselves. A warp that stalls is moved to the
+ * pending pool, and pending warps are promoted round-robin as the active
+ * pool frees up.
+ */
+class TwoLevelPolicy : public WarpSchedulingPolicy {
+public:
+  explicit TwoLevelPolicy(unsigned active_size) : active_size(active_size) {}
+  uint64_t choose(uint64_t ready, uint64_t stalled) override;
+  void issued(unsigned warp_id) override { next_active = (warp_id + 1) % 64; }
+  uint64_t get_active_pool() const { return active; }
+
+private:
+  unsigned active_size;
+  uint64_t active = 0;
+  unsigned next_active = 0;
+  unsigned next_promote = 0;
+};
+
+std::unique_ptr<WarpSchedulingPolicy> make_warp_policy(WarpSchedulerConfig config);
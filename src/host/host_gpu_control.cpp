@@ -1,39 +1,106 @@
 #include "host_gpu_control.hpp"
 #include "../stats/stats.hpp"
+#include "../stats/launch_report.hpp"
 #include "../mem/mem_coalesce.hpp"
 #include "config.hpp"
 
-HostGPUControl::HostGPUControl()
-    : kernel_pc(0), arg_ptr(0), dims(0), gpu_active(false), buf(""), stat_value(0U) {}
+HostGPUControl::HostGPUControl() : gpu_active(false), buf(""), stat_value(0U) {}
 
 void HostGPUControl::set_scheduler(std::shared_ptr<WarpScheduler> scheduler) {
   this->scheduler = scheduler;
 }
 
-void HostGPUControl::set_pc(uint64_t pc) { kernel_pc = pc; }
-void HostGPUControl::set_arg_ptr(uint64_t arg_ptr) { this->arg_ptr = arg_ptr; }
-void HostGPUControl::set_dims(uint64_t dims) { this->dims = dims; }
-void HostGPUControl::set_warps_per_block(unsigned n) {
-  if (scheduler) scheduler->set_warps_per_block(n);
+void HostGPUControl::set_pc(uint64_t pc) { next.pc = pc; }
+void HostGPUControl::set_arg_ptr(uint64_t arg_ptr) { next.arg_ptr = arg_ptr; }
+void HostGPUControl::set_dims(uint64_t dims) { next.dims = dims; }
+void HostGPUControl::set_warps_per_block(unsigned n) { next.warps_per_block = n; }
+// The running kernel's, so staging the next launch does not change it
+uint64_t HostGPUControl::get_arg_ptr() { return launched ? running.arg_ptr : next.arg_ptr; }
+uint32_t HostGPUControl::get_block_index(uint64_t warp_id) {
+  return dispatching_blocks ? dispatcher.block_index(warp_id) : 0;
 }
-uint64_t HostGPUControl::get_arg_ptr() { return arg_ptr; }
 
-void HostGPUControl::launch_kernel() {
-  // Reset statistics
+bool HostGPUControl::launch_kernel() {
+  size_t depth = Config::instance().launchQueue();
+  if (depth == 0 || (!is_gpu_active() && !(pipeline && pipeline->is_pipeline_active()))) {
+    start_kernel(next);
+    return true;
+  }
+  if (launch_queue.size() >= depth) {
+    return false;
+  }
+  launch_queue.push(next);
+  if (!Config::instance().isStatsOnly()) {
+    std::cout << "[HostGPUControl] Queued kernel (" << launch_queue.size() << " waiting)"
+              << std::endl;
+  }
+  return true;
+}
+
+void HostGPUControl::tick() {
+  if (dispatching_blocks) {
+    for (size_t slot : dispatcher.tick()) {
+      start_slot(slot);
+    }
+  }
+  // The pipeline is inactive once the launch before has been closed
+  if (!launch_queue.empty() && !kernel_running() &&
+      !(pipeline && pipeline->is_pipeline_active())) {
+    KernelLaunch launch = launch_queue.front();
+    launch_queue.pop();
+    start_kernel(launch);
+  }
+}
+
+void HostGPUControl::start_kernel(const KernelLaunch &launch) {
+  running = launch;
+  launched = true;
+  scheduler->set_warps_per_block(launch.warps_per_block);
+
+  // Keep the previous launch's counters, then reset statistics
+  LaunchReport::instance().begin_launch(launch.pc);
   GPUStatisticsManager::instance().reset_gpu_cycles();
   GPUStatisticsManager::instance().reset_gpu_instrs();
   GPUStatisticsManager::instance().reset_gpu_dram_accs();
   GPUStatisticsManager::instance().reset_gpu_retries();
   GPUStatisticsManager::instance().reset_gpu_susps();
   GPUStatisticsManager::instance().reset_gpu_active_cpu_dram_accs();
+  GPUStatisticsManager::instance().reset_gpu_stalls();
+  GPUStatisticsManager::instance().reset_l1();
+  GPUStatisticsManager::instance().reset_dram();
+  GPUStatisticsManager::instance().reset_sram();
+  GPUStatisticsManager::instance().reset_scoreboard();
+  GPUStatisticsManager::instance().reset_scalar();
+  GPUStatisticsManager::instance().reset_regfile();
+  GPUStatisticsManager::instance().reset_atomics();
+  GPUStatisticsManager::instance().reset_write_combining();
+  GPUStatisticsManager::instance().reset_blocks();
 
   if (coalescing_unit) {
     coalescing_unit->reset_dram_state();
   }
 
-  for (int i = 0; i < NUM_WARPS; i++) {
-    Warp *warp = new Warp(i, NUM_LANES, kernel_pc, false);
-    scheduler->insert_warp_immediate(warp);
+  // Every warp of the last kernel has finished, so the pool can be reused
+  if (warp_pool.empty()) {
+    for (int i = 0; i < NUM_WARPS; i++) {
+      warp_pool.push_back(std::make_unique<Warp>(i, NUM_LANES, launch.pc, false));
+    }
+  }
+  dispatching_blocks = launch.dims != 0;
+  if (dispatching_blocks) {
+    // Warps outside the first wave wait, finished, for a block of their own
+    for (auto &warp : warp_pool) {
+      std::fill(warp->finished.begin(), warp->finished.end(), true);
+    }
+    for (size_t slot : dispatcher.begin_grid(launch.dims, warp_pool.size(),
+                                             launch.warps_per_block)) {
+      start_slot(slot);
+    }
+  } else {
+    for (auto &warp : warp_pool) {
+      warp->reset(launch.pc);
+      scheduler->insert_warp_immediate(warp.get());
+    }
   }
 
   gpu_active = true;
@@ -47,10 +114,35 @@ void HostGPUControl::launch_kernel() {
   }
 }
 
+void HostGPUControl::start_slot(size_t slot) {
+  size_t first = slot * dispatcher.slot_warps();
+  for (size_t w = first; w < first + dispatcher.slot_warps(); w++) {
+    warp_pool[w]->reset(running.pc);
+    scheduler->insert_warp_immediate(warp_pool[w].get());
+  }
+}
+
+void HostGPUControl::warp_terminated(Warp *warp) {
+  if (dispatcher.warp_retired(warp->warp_id) && pipeline) {
+    pipeline->finish_kernel();
+  }
+}
+
 bool HostGPUControl::is_gpu_active() {
-  bool cu_busy = coalescing_unit && coalescing_unit->is_busy_for_pipeline(false);
+  return kernel_running() || !launch_queue.empty();
+}
+
+bool HostGPUControl::can_put() {
+  return !is_gpu_active() || launch_queue.size() < Config::instance().launchQueue();
+}
+
+bool HostGPUControl::kernel_running() {
+  // Buffered stores have to reach DRAM before the kernel is done
+  bool cu_busy = coalescing_unit && (coalescing_unit->is_busy_for_pipeline(false) ||
+                                     coalescing_unit->has_buffered_writes());
   bool pipeline_busy = pipeline && pipeline->has_active_stages();
-  return gpu_active && (scheduler->is_active() || cu_busy || pipeline_busy);
+  bool blocks_left = dispatching_blocks && dispatcher.is_active();
+  return gpu_active && (scheduler->is_active() || cu_busy || pipeline_busy || blocks_left);
 }
 
 void HostGPUControl::buffer_data(char val) { 
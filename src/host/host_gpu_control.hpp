@@ -1,8 +1,25 @@
+#pragma once
+
+#include "gpu/block_dispatcher.hpp"
 #include "gpu/pipeline_warp_scheduler.hpp"
 #include "utils.hpp"
 
 class CoalescingUnit;
 
+/*
+ * Launches kernels on the GPU pipeline for the host's SIMT CSRs.
+ *
+ * The setters stage the next launch. With --launch-queue=N the host can
+ * launch up to N kernels while one is running; each starts with the pc,
+ * arg ptr and warps per block staged when it was launched, as soon as
+ * the previous kernel's last warp has retired. A launch into a full queue
+ * is refused, so the host retries it. The GPU warps come from a
+ * pool that every launch resets instead of allocating new ones.
+ *
+ * A launch with grid dimensions (set_dims) hands its blocks to the
+ * BlockDispatcher, which restarts the warps of a finished block on the
+ * next one until the grid is done.
+ */
 class HostGPUControl {
 public:
   HostGPUControl();
@@ -17,10 +34,23 @@ public:
 
   // GPU-side accessors
   uint64_t get_arg_ptr();
+  // SIMTBlockIdx; 0 unless the running launch has grid dimensions
+  uint32_t get_block_index(uint64_t warp_id);
 
   // Control
-  void launch_kernel();
+  // False if the launch queue is full and the launch was not taken
+  bool launch_kernel();
+  // Running a kernel or holding queued launches
   bool is_gpu_active();
+  // SIMTCanPut: the GPU is idle or the launch queue has room
+  bool can_put();
+  bool has_queued_launches() const { return !launch_queue.empty(); }
+  size_t queued_launches() const { return launch_queue.size(); }
+  // Starts blocks, then the next queued launch once the running kernel is done
+  void tick();
+  bool is_dispatching_blocks() const { return dispatching_blocks; }
+  // A GPU warp terminated while the block dispatcher runs the kernel
+  void warp_terminated(Warp *warp);
   void set_pipeline(Pipeline *p) { pipeline = p; }
 
   // I/O
@@ -32,12 +62,29 @@ public:
   unsigned get_stat_value();
 
 private:
+  struct KernelLaunch {
+    uint64_t pc = 0;
+    uint64_t arg_ptr = 0;
+    uint64_t dims = 0;
+    unsigned warps_per_block = 0;
+  };
+
+  void start_kernel(const KernelLaunch &launch);
+  // Resets the warps of a dispatcher slot and hands them to the scheduler
+  void start_slot(size_t slot);
+  bool kernel_running();
+
+  // Declared before the scheduler, which still holds pointers to its warps
+  std::vector<std::unique_ptr<Warp>> warp_pool;
   std::shared_ptr<WarpScheduler> scheduler;
   Pipeline *pipeline = nullptr;
   CoalescingUnit *coalescing_unit = nullptr;
-  uint64_t kernel_pc;
-  uint64_t arg_ptr;
-  uint64_t dims;
+  KernelLaunch next;
+  KernelLaunch running;
+  std::queue<KernelLaunch> launch_queue;
+  bool launched = false;
+  BlockDispatcher dispatcher;
+  bool dispatching_blocks = false;
   bool gpu_active;
 
   std::string buf;
@@ -4,95 +4,23 @@
 #include "cxxopts.hpp"
 #include "disassembler/llvm_disasm.hpp"
 #include "gpu/pipeline.hpp"
-#include "gpu/pipeline_ats.hpp"
 #include "gpu/pipeline_execute.hpp"
-#include "gpu/pipeline_instr_fetch.hpp"
-#include "gpu/pipeline_op_fetch.hpp"
-#include "gpu/pipeline_op_latch.hpp"
 #include "gpu/pipeline_warp_scheduler.hpp"
-#include "gpu/pipeline_writeback.hpp"
 #include "host/host_register_file.hpp"
 #include "images/bmp.hpp"
 #include "mem/mem_coalesce.hpp"
 #include "mem/mem_data.hpp"
 #include "mem/mem_instr.hpp"
+#include "stats/launch_report.hpp"
+#include "stats/profiler.hpp"
+#include "stats/self_profiler.hpp"
+#include "stats/stats_sampler.hpp"
 #include "trace/trace.hpp"
+#include "simulator.hpp"
+#include "trace/trace_compare.hpp"
 #include "utils.hpp"
 
-// Initialize pipeline (CPU is modelled as 1x1 GPU for simplicity)
-Pipeline *initialize_pipeline(InstructionMemory *im, CoalescingUnit *cu,
-                              RegisterFile *rf, LLVMDisassembler *disasm,
-                              HostGPUControl *gpu_controller, bool is_cpu,
-                              Tracer *instr_tracer = nullptr) {
-  Pipeline *p = new Pipeline();
-
-  if (is_cpu) {
-    p->add_stage<WarpScheduler>(1, 1, im->get_base_addr(), cu);
-  } else {
-    p->add_stage<WarpScheduler>(NUM_LANES, NUM_WARPS, im->get_base_addr(), cu, false);
-  }
-  p->add_stage<ActiveThreadSelection>();
-  p->add_stage<InstructionFetch>(im, disasm);
-  p->add_stage<OperandFetch>();
-  p->add_stage<OperandLatch>();
-  p->add_stage<ExecuteSuspend>(cu, rf, im->get_max_addr(), disasm,
-                               gpu_controller);
-  p->add_stage<WritebackResume>(cu, rf, is_cpu);
-
-  std::shared_ptr<WarpScheduler> warp_scheduler_stage =
-      std::dynamic_pointer_cast<WarpScheduler>(p->get_stage(0));
-  std::shared_ptr<ExecuteSuspend> execute_stage =
-      std::dynamic_pointer_cast<ExecuteSuspend>(p->get_stage(5));
-  std::shared_ptr<WritebackResume> writeback_stage =
-      std::dynamic_pointer_cast<WritebackResume>(p->get_stage(6));
-
-  if (instr_tracer) {
-    execute_stage->set_instr_tracer(instr_tracer);
-    writeback_stage->set_instr_tracer(instr_tracer);
-  }
-  
-  auto insert_warp_callback = [ws = warp_scheduler_stage](Warp *warp) {
-    ws->insert_warp(warp);
-  };
-  execute_stage->insert_warp = insert_warp_callback;
-
-  execute_stage->insert_warp_retry = [ws = warp_scheduler_stage](Warp *warp) {
-    ws->insert_warp_retry(warp);
-  };
-
-  if (!is_cpu) {
-    execute_stage->notify_warp_terminated = [pipeline = p]() {
-      pipeline->notify_warp_terminated();
-    };
-  }
-
-  writeback_stage->insert_warp = insert_warp_callback;
-
-  writeback_stage->insert_warp_with_susp_delay = [ws = warp_scheduler_stage](Warp *warp) {
-    ws->insert_warp_retry(warp);
-  };
-
-  // Initialize latches (7 stages = 7 latches)
-  PipelineLatch *latches[7];
-  for (int i = 0; i < 7; i++) {
-    latches[i] = new PipelineLatch();
-  }
-
-  // Connect latches in a circular pattern (stage N output -> stage N+1 input)
-  p->get_stage(0)->set_latches(latches[6], latches[0]);
-  p->get_stage(1)->set_latches(latches[0], latches[1]);
-  p->get_stage(2)->set_latches(latches[1], latches[2]);
-  p->get_stage(3)->set_latches(latches[2], latches[3]);
-  p->get_stage(4)->set_latches(latches[3], latches[4]);
-  p->get_stage(5)->set_latches(latches[4], latches[5]);
-  p->get_stage(6)->set_latches(latches[5], latches[6]);
-
-  return p;
-}
-
 int main(int argc, char *argv[]) {
-  srand((unsigned) time(NULL));
-
   cxxopts::Options options("RISCVGpuSim",
                            "A software simulator for a RISC-V GPU");
 
@@ -117,9 +45,87 @@ int main(int argc, char *argv[]) {
                             cxxopts::value<std::string>())(
       "dram-trace-file", "Trace DRAM/SRAM accesses exiting CU pipeline (specify filename, e.g. --dram-trace-file=dram.log)",
                             cxxopts::value<std::string>())(
+      "trace-format", "Format for the trace files: 'csv', 'bin' or 'compact' (convert with trace_tool)",
+                            cxxopts::value<std::string>()->default_value("csv"))(
+      "compare-trace", "Stream the instruction trace against a reference trace (CSV, e.g. from SIMTight) and report the first divergence",
+                            cxxopts::value<std::string>())(
+      "compare-stop", "Stop the simulation at the first --compare-trace divergence")(
+      "compare-all-events", "Compare all warp-level events, not just INSTR_EXEC")(
+      "compare-cycles", "Also require event cycles to match the reference")(
+      "profile", "Write a per-PC GPU hotspot profile (cycles, instructions, retries, stalls) to a file",
+                            cxxopts::value<std::string>())(
+      "stall-breakdown", "Print why the GPU issue slot was idle each cycle (memory, barrier, functional units, retries), in total and per warp, for the last kernel launch")(
+      "stats-interval", "Sample the GPU counters every N GPU cycles into --stats-file (IPC, DRAM inflight, CU queue depth, suspended/barrier warps, active lanes)",
+                            cxxopts::value<uint64_t>())(
+      "stats-file", "Output file for --stats-interval samples",
+                            cxxopts::value<std::string>()->default_value("stats.csv"))(
+      "stats-format", "Format for --stats-file: 'csv' or 'bin'",
+                            cxxopts::value<std::string>()->default_value("csv"))(
+      "stats-json", "Write the counters of every kernel launch, with wall time, host MIPS and a config fingerprint, as JSON to a file",
+                            cxxopts::value<std::string>())(
+      "self-profile", "Report the host time spent per pipeline stage, in the coalescing unit and in stats bookkeeping, and the simulation speed")(
       "q,quick", "Disable buffering for outputting earlier than simulation end")(
-      "warp-scheduler", "Choose a warp scheduler from 'baseline' or 'random'",
+      "warp-scheduler", "Choose a warp scheduler from 'baseline' (fair), 'random', 'gto' (greedy-then-oldest), 'two-level' or 'lrr' (loose round-robin)",
                             cxxopts::value<std::string>())(
+      "two-level-active", "Size of the two-level scheduler's active warp pool",
+                            cxxopts::value<unsigned>()->default_value("8"))(
+      "reconvergence", "Divergence model: 'nesting' (NoCL push/pop, as SIMTight) or 'ipdom' (immediate post-dominator stack)",
+                            cxxopts::value<std::string>()->default_value("nesting"))(
+      "lanes-histogram", "Report the active lanes per issued warp instruction of the last kernel launch")(
+      "l1-size", "Size in bytes of the GPU's L1 data cache in front of DRAM; 0 disables it",
+                            cxxopts::value<size_t>()->default_value("0"))(
+      "l1-ways", "Associativity of the L1 data cache",
+                            cxxopts::value<size_t>()->default_value("4"))(
+      "l1-line", "Line size in bytes of the L1 data cache",
+                            cxxopts::value<size_t>()->default_value(std::to_string(DRAM_BEAT_BYTES)))(
+      "l1-mshrs", "Line fills the L1 data cache can have in flight",
+                            cxxopts::value<size_t>()->default_value("32"))(
+      "l1-write-policy", "L1 store handling: 'write-through' (no allocate) or 'write-back' (allocate)",
+                            cxxopts::value<std::string>()->default_value("write-through"))(
+      "l1-stats", "Report the L1 data cache hits, misses and MSHR stalls of the last kernel launch")(
+      "dram-model", "DRAM timing: 'fixed' (constant latency, as SIMTight) or 'banked' (channels, banks and row buffers)",
+                            cxxopts::value<std::string>()->default_value("fixed"))(
+      "dram-channels", "Channels of the banked DRAM",
+                            cxxopts::value<size_t>()->default_value("1"))(
+      "dram-banks", "Banks per channel of the banked DRAM",
+                            cxxopts::value<size_t>()->default_value("8"))(
+      "dram-row-bytes", "Row buffer size in bytes of the banked DRAM",
+                            cxxopts::value<size_t>()->default_value("2048"))(
+      "dram-page-policy", "Banked DRAM row policy: 'open' or 'closed' (precharge after every access)",
+                            cxxopts::value<std::string>()->default_value("open"))(
+      "dram-trcd", "Banked DRAM activate to column command, in cycles",
+                            cxxopts::value<size_t>()->default_value("8"))(
+      "dram-trp", "Banked DRAM precharge time, in cycles",
+                            cxxopts::value<size_t>()->default_value("8"))(
+      "dram-tcas", "Banked DRAM column command to data, in cycles",
+                            cxxopts::value<size_t>()->default_value("8"))(
+      "dram-twtr", "Banked DRAM write to read turnaround, in cycles",
+                            cxxopts::value<size_t>()->default_value("4"))(
+      "dram-stats", "Report the banked DRAM row hit rate and per-bank utilization of the last kernel launch")(
+      "sram-banks", "Shared SRAM banks (a power of two)", cxxopts::value<size_t>()->default_value("16"))(
+      "sram-hash", "Shared SRAM bank of a word: 'word' (word % banks, as SIMTight) or 'xor' (row XORed into the bank bits)",
+                            cxxopts::value<std::string>()->default_value("word"))(
+      "sram-queue-depth", "Shared SRAM accesses queued for the banks before the coalescing unit stalls",
+                            cxxopts::value<size_t>()->default_value("2"))(
+      "sram-latency", "Shared SRAM cycles from the banks back to the warp",
+                            cxxopts::value<size_t>()->default_value("10"))(
+      "sram-stats", "Report the shared SRAM bank conflict degrees of the last kernel launch, overall and per PC")(
+      "load-scoreboard", "Non-blocking GPU loads: outstanding loads per warp, stalling only on a register hazard; 0 blocks on every load as SIMTight",
+                            cxxopts::value<size_t>()->default_value("0"))(
+      "scoreboard-stats", "Report the non-blocking load overlap and scoreboard stalls of the last kernel launch")(
+      "scalarize", "Compute GPU ALU ops whose register sources are uniform across the warp once, and count scalarizable instructions")(
+      "scalar-stats", "Report the uniform and affine operands of the last kernel launch (with --scalarize)")(
+      "regfile-stats", "Report the compressed register reads and the register file SRAM saved in the last kernel launch")(
+      "atomic-combining", "Merge the lanes of a GPU atomic that hit the same word into one read-modify-write")(
+      "atomic-stats", "Report the atomic lane operations and read-modify-writes of the last kernel launch")(
+      "write-combining", "Entries of the GPU store write-combining buffer, each merging the stores to one DRAM beat; 0 disables it",
+                            cxxopts::value<size_t>()->default_value("0"))(
+      "write-combining-stats", "Report the write-combining merges and buffer occupancy of the last kernel launch")(
+      "launch-queue", "Kernel launches the host can queue while the GPU is busy; the GPU starts the next as soon as the last warp retires",
+                            cxxopts::value<size_t>()->default_value("0"))(
+      "block-stats", "Report the blocks, slot occupancy and tail cycles of the block dispatcher in the last kernel launch")(
+      "seed", "Seed for the random warp scheduler; runs with the same seed are identical",
+                            cxxopts::value<uint64_t>()->default_value("1"))(
       "h,help", "Show help");
   options.parse_positional({"filename"});
   options.positional_help("<Input File>");
@@ -138,13 +144,199 @@ int main(int argc, char *argv[]) {
   config.setQuick(result.count("quick") > 0);
   if (result.count("warp-scheduler") > 0) {
     std::string value = result["warp-scheduler"].as<std::string>();
-    if (value == "random") {
-      config.setWarpScheduler(RANDOM);
+    bool found = false;
+    for (WarpSchedulerConfig scheduler : {BASELINE, RANDOM, GTO, TWO_LEVEL, LRR}) {
+      if (value == warp_scheduler_name(scheduler)) {
+        config.setWarpScheduler(scheduler);
+        found = true;
+      }
+    }
+    if (!found) {
+      std::cout << "Unknown warp scheduler: " << value << std::endl;
+      return 1;
     }
   }
+  unsigned two_level_active = result["two-level-active"].as<unsigned>();
+  if (two_level_active < 1 || two_level_active > NUM_WARPS) {
+    std::cout << "--two-level-active must be between 1 and " << NUM_WARPS << std::endl;
+    return 1;
+  }
+  config.setTwoLevelActiveWarps(two_level_active);
+  std::string reconvergence = result["reconvergence"].as<std::string>();
+  if (reconvergence == "ipdom") {
+    config.setReconvergence(RECONVERGE_IPDOM);
+  } else if (reconvergence != "nesting") {
+    std::cout << "Unknown reconvergence model: " << reconvergence << std::endl;
+    return 1;
+  }
+  config.setSeed(result["seed"].as<uint64_t>());
+  L1CacheConfig l1_config;
+  l1_config.size_bytes = result["l1-size"].as<size_t>();
+  l1_config.ways = result["l1-ways"].as<size_t>();
+  l1_config.line_bytes = result["l1-line"].as<size_t>();
+  l1_config.mshrs = result["l1-mshrs"].as<size_t>();
+  std::string l1_write_policy = result["l1-write-policy"].as<std::string>();
+  if (l1_write_policy == "write-back") {
+    l1_config.write_policy = L1_WRITE_BACK;
+  } else if (l1_write_policy != "write-through") {
+    std::cout << "Unknown L1 write policy: " << l1_write_policy << std::endl;
+    return 1;
+  }
+  if (l1_config.size_bytes > 0) {
+    std::string error = L1Cache::config_error(l1_config);
+    if (!error.empty()) {
+      std::cout << "Invalid L1 cache: " << error << std::endl;
+      return 1;
+    }
+  }
+  config.setL1Cache(l1_config);
+  DramConfig dram_config;
+  std::string dram_model = result["dram-model"].as<std::string>();
+  if (dram_model == "banked") {
+    dram_config.model = DRAM_BANKED;
+  } else if (dram_model != "fixed") {
+    std::cout << "Unknown DRAM model: " << dram_model << std::endl;
+    return 1;
+  }
+  dram_config.channels = result["dram-channels"].as<size_t>();
+  dram_config.banks = result["dram-banks"].as<size_t>();
+  dram_config.row_bytes = result["dram-row-bytes"].as<size_t>();
+  std::string page_policy = result["dram-page-policy"].as<std::string>();
+  if (page_policy == "closed") {
+    dram_config.page_policy = DRAM_CLOSED_PAGE;
+  } else if (page_policy != "open") {
+    std::cout << "Unknown DRAM page policy: " << page_policy << std::endl;
+    return 1;
+  }
+  dram_config.t_rcd = result["dram-trcd"].as<size_t>();
+  dram_config.t_rp = result["dram-trp"].as<size_t>();
+  dram_config.t_cas = result["dram-tcas"].as<size_t>();
+  dram_config.t_wtr = result["dram-twtr"].as<size_t>();
+  if (dram_config.model == DRAM_BANKED) {
+    std::string error = BankedDram::config_error(dram_config);
+    if (!error.empty()) {
+      std::cout << "Invalid DRAM configuration: " << error << std::endl;
+      return 1;
+    }
+  }
+  config.setDram(dram_config);
+  SramConfig sram_config;
+  sram_config.banks = result["sram-banks"].as<size_t>();
+  std::string sram_hash = result["sram-hash"].as<std::string>();
+  if (sram_hash == "xor") {
+    sram_config.hash = SRAM_HASH_XOR;
+  } else if (sram_hash != "word") {
+    std::cout << "Unknown SRAM bank hash: " << sram_hash << std::endl;
+    return 1;
+  }
+  sram_config.queue_depth = result["sram-queue-depth"].as<size_t>();
+  sram_config.latency = result["sram-latency"].as<size_t>();
+  std::string sram_error = CoalescingUnit::sram_config_error(sram_config);
+  if (!sram_error.empty()) {
+    std::cout << "Invalid shared SRAM: " << sram_error << std::endl;
+    return 1;
+  }
+  config.setSram(sram_config);
+  config.setLoadScoreboard(result["load-scoreboard"].as<size_t>());
+  config.setScalarize(result.count("scalarize") > 0);
+  config.setAtomicCombining(result.count("atomic-combining") > 0);
+  config.setWriteCombining(result["write-combining"].as<size_t>());
+  config.setLaunchQueue(result["launch-queue"].as<size_t>());
 
   std::string filename = result["filename"].as<std::string>();
 
+  // Everything that changes the simulated timing goes into the fingerprint
+  LaunchReport &launch_report = LaunchReport::instance();
+  launch_report.set_config("warp_scheduler", warp_scheduler_name(config.warpScheduler()));
+  if (config.warpScheduler() == RANDOM) {
+    launch_report.set_config("seed", config.seed());
+  }
+  if (config.warpScheduler() == TWO_LEVEL) {
+    launch_report.set_config("two_level_active", config.twoLevelActiveWarps());
+  }
+  launch_report.set_config("reconvergence", reconvergence);
+  if (l1_config.size_bytes > 0) {
+    launch_report.set_config("l1_size", l1_config.size_bytes);
+    launch_report.set_config("l1_ways", l1_config.ways);
+    launch_report.set_config("l1_line", l1_config.line_bytes);
+    launch_report.set_config("l1_mshrs", l1_config.mshrs);
+    launch_report.set_config("l1_write_policy", l1_write_policy_name(l1_config.write_policy));
+  }
+  launch_report.set_config("num_warps", NUM_WARPS);
+  launch_report.set_config("num_lanes", NUM_LANES);
+  launch_report.set_config("num_registers", NUM_REGISTERS);
+  launch_report.set_config("dram_latency", SIM_DRAM_LATENCY);
+  if (dram_config.model == DRAM_BANKED) {
+    launch_report.set_config("dram_model", dram_model);
+    launch_report.set_config("dram_channels", dram_config.channels);
+    launch_report.set_config("dram_banks", dram_config.banks);
+    launch_report.set_config("dram_row_bytes", dram_config.row_bytes);
+    launch_report.set_config("dram_page_policy", page_policy);
+    launch_report.set_config("dram_trcd", dram_config.t_rcd);
+    launch_report.set_config("dram_trp", dram_config.t_rp);
+    launch_report.set_config("dram_tcas", dram_config.t_cas);
+    launch_report.set_config("dram_twtr", dram_config.t_wtr);
+  }
+  if (!(sram_config == SramConfig())) {
+    launch_report.set_config("sram_banks", sram_config.banks);
+    launch_report.set_config("sram_hash", sram_bank_hash_name(sram_config.hash));
+    launch_report.set_config("sram_queue_depth", sram_config.queue_depth);
+    launch_report.set_config("sram_latency", sram_config.latency);
+  }
+  if (config.loadScoreboard() > 0) {
+    launch_report.set_config("load_scoreboard", config.loadScoreboard());
+  }
+  if (config.isAtomicCombining()) {
+    launch_report.set_config("atomic_combining", 1);
+  }
+  if (config.writeCombining() > 0) {
+    launch_report.set_config("write_combining", config.writeCombining());
+  }
+  if (config.launchQueue() > 0) {
+    launch_report.set_config("launch_queue", config.launchQueue());
+  }
+  launch_report.set_config("dram_resp_overhead", SIM_DRAM_RESP_OVERHEAD);
+  launch_report.set_config("dram_max_inflight", CoalescingUnit::DRAM_MAX_INFLIGHT);
+  launch_report.set_config("mem_req_queue_capacity", MEM_REQ_QUEUE_CAPACITY);
+  launch_report.set_config("mul_latency", SIM_MUL_LATENCY);
+  launch_report.set_config("div_latency", SIM_DIV_LATENCY);
+  launch_report.set_config("rem_latency", SIM_REM_LATENCY);
+  launch_report.set_config("fadd_latency", SIM_FADD_LATENCY);
+  launch_report.set_config("fmul_latency", SIM_FMUL_LATENCY);
+  launch_report.set_config("fma_latency", SIM_FMA_LATENCY);
+  launch_report.set_config("fcmp_latency", SIM_FCMP_LATENCY);
+  launch_report.set_config("fcvt_latency", SIM_FCVT_LATENCY);
+  launch_report.set_config("fdiv_latency", SIM_FDIV_LATENCY);
+  launch_report.set_config("fsqrt_latency", SIM_FSQRT_LATENCY);
+  launch_report.set_config("fpu_pipeline_capacity", CoalescingUnit::FPU_PIPELINE_CAPACITY);
+
+  TraceFormat trace_format = TRACE_CSV;
+  std::string trace_format_str = result["trace-format"].as<std::string>();
+  if (trace_format_str == "bin") {
+    trace_format = TRACE_BINARY;
+  } else if (trace_format_str == "compact") {
+    trace_format = TRACE_COMPACT;
+  } else if (trace_format_str != "csv") {
+    std::cout << "Unknown trace format: " << trace_format_str << std::endl;
+    return 1;
+  }
+
+  std::unique_ptr<StatsSampler> sampler;
+  if (result.count("stats-interval")) {
+    std::string stats_format_str = result["stats-format"].as<std::string>();
+    if (stats_format_str != "csv" && stats_format_str != "bin") {
+      std::cout << "Unknown stats format: " << stats_format_str << std::endl;
+      return 1;
+    }
+    if (result["stats-interval"].as<uint64_t>() == 0) {
+      std::cout << "--stats-interval must be at least 1" << std::endl;
+      return 1;
+    }
+    sampler = std::make_unique<StatsSampler>(
+        result["stats-file"].as<std::string>(), result["stats-interval"].as<uint64_t>(),
+        stats_format_str == "bin" ? STATS_SAMPLE_BINARY : STATS_SAMPLE_CSV);
+  }
+
   // Initialize LLVM machine code decoding (RISC-V only)
   LLVMInitializeRISCVTargetInfo();
   LLVMInitializeRISCVTargetMC();
@@ -152,7 +344,7 @@ int main(int argc, char *argv[]) {
 
   std::string target_id = "riscv64-unknown-elf";
   std::string cpu = "generic-rv64";
-  std::string features = "+m,+a,+zfinx";
+  std::string features = "+m,+a,+zfinx,+zbb";
   LLVMDisassembler disasm(target_id, cpu, features);
 
   debug_log("Loading ELF file...");
@@ -168,20 +360,15 @@ int main(int argc, char *argv[]) {
   debug_log("Instruction memory has base_addr " +
             std::to_string(tcim.get_base_addr()));
 
+  PCProfiler &profiler = PCProfiler::instance();
+  if (result.count("profile")) {
+    profiler.enable(tcim.get_base_addr(), tcim.get_max_addr());
+  }
+
   DataMemory scratchpad_mem;
   
   // Initialize data memory with sections from ELF file (rodata, data, etc.)
-  for (const auto& section : out.data_sections) {
-    uint64_t addr = section.first;
-    const std::vector<uint8_t>& data = section.second;
-    for (size_t i = 0; i < data.size(); i++) {
-      // Store each byte individually (store function handles little-endian, but for 1 byte it's fine)
-      scratchpad_mem.store(addr + i, 1, static_cast<uint64_t>(data[i]));
-    }
-    debug_log("Loaded data section at 0x" + 
-              std::to_string(addr) + " (" + 
-              std::to_string(data.size()) + " bytes)");
-  }
+  load_data_sections(out, &scratchpad_mem);
   
   debug_log("Instantiated memory scratchpad for the SM");
   
@@ -196,26 +383,43 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  std::unique_ptr<TraceComparator> comparator;
+  if (result.count("compare-trace")) {
+    TraceCompareOptions compare_options;
+    compare_options.all_events = result.count("compare-all-events") > 0;
+    compare_options.compare_cycles = result.count("compare-cycles") > 0;
+    comparator = std::make_unique<TraceComparator>(compare_options);
+    std::string reference = result["compare-trace"].as<std::string>();
+    if (!comparator->open(reference)) {
+      std::cout << "Cannot open reference trace: " << reference << std::endl;
+      return 1;
+    }
+  }
+  bool compare_stop = comparator && result.count("compare-stop") > 0;
+
   std::unique_ptr<Tracer> instr_tracer;
-  if (result.count("instr-trace-file")) {
-    instr_tracer = std::make_unique<Tracer>(result["instr-trace-file"].as<std::string>());
+  if (result.count("instr-trace-file") || comparator) {
+    std::string instr_trace_file =
+        result.count("instr-trace-file") ? result["instr-trace-file"].as<std::string>() : "";
+    instr_tracer = std::make_unique<Tracer>(instr_trace_file, trace_format, comparator.get());
     debug_log("Instruction tracing (warp 1 thread 1) enabled");
   }
   
-  CoalescingUnit cu(&scratchpad_mem, trace_file_ptr);
+  CoalescingUnit cu(&scratchpad_mem, trace_file_ptr, trace_format);
   if (instr_tracer) {
     cu.set_instr_tracer(instr_tracer.get());
   }
-  std::unique_ptr<std::ofstream> dram_trace_file;
+  std::unique_ptr<Tracer> dram_tracer;
   if (result.count("dram-trace-file")) {
-    dram_trace_file = std::make_unique<std::ofstream>(result["dram-trace-file"].as<std::string>());
-    *dram_trace_file << "cycle,warp,type,beats,groups,dest,addr\n";
-    cu.set_dram_trace(dram_trace_file.get());
+    dram_tracer = std::make_unique<Tracer>(result["dram-trace-file"].as<std::string>(),
+                                           trace_format);
+    cu.set_dram_trace(dram_tracer.get());
     debug_log("DRAM trace enabled");
   }
   debug_log("Instantiated memory coalescing unit");
 
   RegisterFile rf(NUM_REGISTERS, NUM_LANES);
+  rf.set_stats(result.count("regfile-stats") > 0 || result.count("stats-json") > 0);
   HostRegisterFile hrf(&rf, NUM_REGISTERS);
   debug_log("Register file instantiated with " +
             std::to_string(NUM_REGISTERS) + " registers");
@@ -231,30 +435,24 @@ int main(int argc, char *argv[]) {
   gpu_pipeline->set_debug(true);
   cpu_pipeline->set_debug(config.isCPUDebug());
 
-  gpu_controller.set_scheduler(
-      std::dynamic_pointer_cast<WarpScheduler>(gpu_pipeline->get_stage(0)));
-  gpu_controller.set_pipeline(gpu_pipeline);
-  gpu_controller.set_coalescing_unit(&cu);
-
-  // Execute the threads
-  while (cpu_pipeline->has_active_stages() ||
-         gpu_pipeline->has_active_stages() ||
-         gpu_pipeline->is_pipeline_active()) {
-    
-    gpu_pipeline->apply_deferred_deactivation();
+  connect_gpu_controller(&gpu_controller, gpu_pipeline, &cu);
 
-    GPUStatisticsManager::instance().set_gpu_pipeline_active(gpu_pipeline->is_pipeline_active());
+  SelfProfiler &self_profiler = SelfProfiler::instance();
+  bool self_profiling = result.count("self-profile") > 0;
+  if (self_profiling) {
+    cpu_pipeline->enable_self_profile("cpu");
+    gpu_pipeline->enable_self_profile("gpu");
+    self_profiler.enable();
+  }
 
-    cpu_pipeline->execute();
-    gpu_pipeline->execute();
-    cu.tick();
+  SimulationHooks hooks;
+  hooks.profiler = profiler.is_enabled() ? &profiler : nullptr;
+  hooks.sampler = sampler.get();
+  hooks.self_profiler = self_profiling ? &self_profiler : nullptr;
+  hooks.launch_report = &launch_report;
+  hooks.stop_on_divergence = compare_stop ? comparator.get() : nullptr;
+  run_simulation(cpu_pipeline, gpu_pipeline, cu, &gpu_controller, hooks);
 
-    GPUStatisticsManager::instance().tick_instr_pipeline();
-
-    if (gpu_pipeline->is_pipeline_active()) {
-      GPUStatisticsManager::instance().increment_gpu_cycles();
-    }
-  }
 
   std::string output = gpu_controller.get_buffer();
   bool statsOnly = config.isStatsOnly();
@@ -287,8 +485,92 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  auto disassemble = [&](uint64_t pc) -> std::string {
+    if (pc < tcim.get_base_addr() || pc > tcim.get_max_addr()) {
+      return "";
+    }
+    uint64_t remaining_buffer = tcim.get_max_addr() + 4 - pc;
+    llvm::ArrayRef<uint8_t> code_ref(tcim.get_instruction(pc), remaining_buffer);
+    return disasm.to_string(disasm.disasm_inst(0, code_ref), pc);
+  };
+  if (profiler.is_enabled()) {
+    std::string profile_file = result["profile"].as<std::string>();
+    std::ofstream profile_out(profile_file);
+    profiler.report(profile_out, disassemble);
+    debug_log("Wrote GPU profile to " + profile_file);
+  }
+
+  if (result.count("stall-breakdown")) {
+    GPUStatisticsManager::instance().report_stall_breakdown(std::cout);
+  }
+
+  if (result.count("lanes-histogram")) {
+    GPUStatisticsManager::instance().report_active_lanes(std::cout);
+  }
+
+  if (result.count("l1-stats")) {
+    GPUStatisticsManager::instance().report_l1_cache(std::cout);
+  }
+
+  if (result.count("dram-stats")) {
+    GPUStatisticsManager::instance().report_dram_banks(std::cout);
+  }
+
+  if (result.count("sram-stats")) {
+    GPUStatisticsManager::instance().report_sram(std::cout, disassemble);
+  }
+
+  if (result.count("scoreboard-stats")) {
+    GPUStatisticsManager::instance().report_scoreboard(std::cout);
+  }
+
+  if (result.count("scalar-stats")) {
+    GPUStatisticsManager::instance().report_scalar(std::cout);
+  }
+
+  if (result.count("regfile-stats")) {
+    GPUStatisticsManager::instance().report_regfile(std::cout);
+  }
+
+  if (result.count("atomic-stats")) {
+    GPUStatisticsManager::instance().report_atomics(std::cout);
+  }
+
+  if (result.count("write-combining-stats")) {
+    GPUStatisticsManager::instance().report_write_combining(std::cout);
+  }
+
+  if (result.count("block-stats")) {
+    GPUStatisticsManager::instance().report_blocks(std::cout);
+  }
+
+  if (result.count("stats-json")) {
+    std::string json_file = result["stats-json"].as<std::string>();
+    std::ofstream json_out(json_file);
+    launch_report.write_json(json_out, filename);
+    debug_log("Wrote per-launch stats to " + json_file);
+  }
+
+  if (self_profiling) {
+    uint64_t warp_instrs = 0;
+    uint64_t thread_instrs = 0;
+    for (const LaunchRecord &launch : launch_report.get_launches()) {
+      warp_instrs += launch.stalls[STALL_NONE];
+      thread_instrs += launch.instrs;
+    }
+    self_profiler.report(std::cout, warp_instrs, thread_instrs);
+  }
+
+  int exit_code = 0;
+  if (comparator) {
+    // Shutting the tracer down drains the events still in flight
+    instr_tracer.reset();
+    comparator->report(std::cout);
+    exit_code = comparator->diverged() ? 2 : 0;
+  }
+
   delete cpu_pipeline;
   delete gpu_pipeline;
 
-  return 0;
+  return exit_code;
 }
\ No newline at end of file
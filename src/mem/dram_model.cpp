@@ -0,0 +1,99 @@
+#include "dram_model.hpp"
+#include "stats/stats.hpp"
+#include <algorithm>
+#include <cassert>
+
+BankedDram::BankedDram(const DramConfig &config) : config(config) {
+  assert(config_error(config).empty());
+  beats_per_row = config.row_bytes / DRAM_BEAT_BYTES;
+  banks.resize(config.channels * config.banks);
+  channels.resize(config.channels);
+}
+
+std::string BankedDram::config_error(const DramConfig &config) {
+  if (config.channels == 0 || config.banks == 0) {
+    return "channels and banks must be at least 1";
+  }
+  if (config.row_bytes < DRAM_BEAT_BYTES || config.row_bytes % DRAM_BEAT_BYTES != 0) {
+    return "the row size must be a multiple of " + std::to_string(DRAM_BEAT_BYTES) + " bytes";
+  }
+  return "";
+}
+
+size_t BankedDram::access(const std::vector<uint64_t> &beat_addrs, size_t now, bool is_write) {
+  size_t done = now;
+  for (uint64_t addr : beat_addrs) {
+    done = std::max(done, access_beat(addr, now, is_write));
+  }
+  return done;
+}
+
+size_t BankedDram::access_beat(uint64_t addr, size_t now, bool is_write) {
+  // Like the GPU cycles, the stats only cover the time a kernel runs
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+  bool counted = stats.is_gpu_pipeline_active();
+  uint64_t beat = (addr & 0xFFFFFFFF) / DRAM_BEAT_BYTES;
+  size_t channel_id = beat % config.channels;
+  uint64_t row = (beat / config.channels) / beats_per_row;
+  size_t bank_id = channel_id * config.banks + row % config.banks;
+  Bank &bank = banks[bank_id];
+  Channel &channel = channels[channel_id];
+
+  size_t start = std::max(now + CONTROLLER_LATENCY, bank.ready);
+  bool turnaround = !is_write && channel.write_end + config.t_wtr > start;
+  if (turnaround) {
+    start = channel.write_end + config.t_wtr;
+  }
+
+  size_t column = start;
+  DramCounter outcome;
+  if (bank.open && bank.row == row) {
+    outcome = DRAM_ROW_HITS;
+  } else if (bank.open) {
+    outcome = DRAM_ROW_CONFLICTS;
+    column += config.t_rp + config.t_rcd;
+  } else {
+    outcome = DRAM_ROW_CLOSED;
+    column += config.t_rcd;
+  }
+
+  size_t data = std::max(column + config.t_cas, channel.bus_free);
+  channel.bus_free = data + 1;
+  if (is_write) {
+    channel.write_end = data + 1;
+  }
+
+  if (config.page_policy == DRAM_OPEN_PAGE) {
+    bank.open = true;
+    bank.row = row;
+    bank.ready = column + 1;
+  } else {
+    // Auto-precharge right after the column command
+    bank.open = false;
+    bank.ready = column + 1 + config.t_rp;
+  }
+  if (counted) {
+    stats.increment_dram(outcome);
+    if (turnaround) {
+      stats.increment_dram(DRAM_TURNAROUNDS);
+    }
+    stats.add_dram_bank_busy(bank_id, bank.ready - start);
+  }
+  return data + 1;
+}
+
+size_t BankedDram::drain_tick(size_t now) const {
+  size_t done = now + CONTROLLER_LATENCY;
+  for (const Bank &bank : banks) {
+    done = std::max(done, bank.ready);
+  }
+  for (const Channel &channel : channels) {
+    done = std::max(done, channel.bus_free);
+  }
+  return done;
+}
+
+void BankedDram::reset() {
+  std::fill(banks.begin(), banks.end(), Bank());
+  std::fill(channels.begin(), channels.end(), Channel());
+}
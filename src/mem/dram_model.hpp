@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "config.hpp"
+
+/*
+ * Banked DRAM timing (--dram-model=banked).
+ *
+ * Beats are mapped to a channel by beat index, then to a bank by row, so
+ * consecutive beats fill a row before moving to the next bank:
+ *   beat = addr / DRAM_BEAT_BYTES
+ *   channel = beat % channels, row = (beat / channels) / beats_per_row
+ *   bank = row % banks
+ * Each bank keeps its open row. An access to the open row only pays tCAS,
+ * an access to a precharged bank tRCD + tCAS, and a row conflict
+ * tRP + tRCD + tCAS. Beats share their channel's data bus one per cycle,
+ * and a read waits tWTR after the channel's last write.
+ */
+class BankedDram {
+public:
+  // Coalescing unit to the controller and back, on top of the bank timings
+  static constexpr size_t CONTROLLER_LATENCY = 14;
+
+  explicit BankedDram(const DramConfig &config);
+
+  // Empty if the configuration can be built, otherwise what is wrong with it
+  static std::string config_error(const DramConfig &config);
+
+  /*
+   * Issues the beats in order at tick now and returns the tick after the
+   * last one has crossed the data bus
+   */
+  size_t access(const std::vector<uint64_t> &beat_addrs, size_t now, bool is_write);
+
+  // Tick by which everything issued so far has finished, for fences
+  size_t drain_tick(size_t now) const;
+
+  // Closes every row and forgets pending work, e.g. at a kernel launch
+  void reset();
+
+  size_t num_banks() const { return banks.size(); }
+
+private:
+  struct Bank {
+    bool open = false;
+    uint64_t row = 0;
+    size_t ready = 0;  // Next tick a command can start
+  };
+
+  struct Channel {
+    size_t bus_free = 0;    // Next tick the data bus is free
+    size_t write_end = 0;   // Tick the last write burst finished
+  };
+
+  size_t access_beat(uint64_t addr, size_t now, bool is_write);
+
+  DramConfig config;
+  size_t beats_per_row;
+  std::vector<Bank> banks;  // channels * banks, channel-major
+  std::vector<Channel> channels;
+};
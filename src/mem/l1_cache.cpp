@@ -0,0 +1,123 @@
+#include "l1_cache.hpp"
+#include <algorithm>
+#include <cassert>
+
+L1Cache::L1Cache(const L1CacheConfig &config) : config(config) {
+  assert(config_error(config).empty());
+  num_sets = config.size_bytes / (config.ways * config.line_bytes);
+  lines.resize(num_sets * config.ways);
+}
+
+std::string L1Cache::config_error(const L1CacheConfig &config) {
+  if (config.line_bytes < 4 || (config.line_bytes & (config.line_bytes - 1)) != 0) {
+    return "the line size must be a power of two of at least 4 bytes";
+  }
+  if (config.ways == 0 || config.mshrs == 0) {
+    return "ways and MSHRs must be at least 1";
+  }
+  if (config.size_bytes == 0 || config.size_bytes % (config.ways * config.line_bytes) != 0) {
+    return "the size must be a non-zero multiple of ways * line size";
+  }
+  return "";
+}
+
+size_t L1Cache::line_beats() const {
+  return std::max<size_t>(1, (config.line_bytes + DRAM_BEAT_BYTES - 1) / DRAM_BEAT_BYTES);
+}
+
+size_t L1Cache::set_index(uint64_t addr) const {
+  return (addr / config.line_bytes) % num_sets;
+}
+
+L1Cache::Line *L1Cache::find(uint64_t addr) {
+  uint64_t tag = line_addr(addr);
+  Line *set = &lines[set_index(addr) * config.ways];
+  for (size_t w = 0; w < config.ways; w++) {
+    if (set[w].valid && set[w].tag == tag) {
+      return &set[w];
+    }
+  }
+  return nullptr;
+}
+
+L1Cache::Outcome L1Cache::lookup(uint64_t addr, size_t now, size_t *ready_tick, bool touch) {
+  Line *line = find(addr);
+  if (!line) {
+    return MISS;
+  }
+  if (touch) {
+    line->last_use = ++use_counter;
+  }
+  if (line->ready_tick > now) {
+    *ready_tick = line->ready_tick;
+    return MSHR_MERGE;
+  }
+  *ready_tick = now + HIT_LATENCY;
+  return HIT;
+}
+
+bool L1Cache::allocate(uint64_t addr, size_t now, size_t fill_tick, bool dirty,
+                       uint64_t *victim_line) {
+  Line *set = &lines[set_index(addr) * config.ways];
+  Line *victim = &set[0];
+  for (size_t w = 0; w < config.ways; w++) {
+    if (!set[w].valid) {
+      victim = &set[w];
+      break;
+    }
+    if (set[w].last_use < victim->last_use) {
+      victim = &set[w];
+    }
+  }
+
+  bool writeback = victim->valid && victim->dirty;
+  if (writeback && victim_line) {
+    *victim_line = victim->tag;
+  }
+  victim->valid = true;
+  victim->dirty = dirty;
+  victim->tag = line_addr(addr);
+  victim->last_use = ++use_counter;
+  victim->ready_tick = fill_tick;
+  if (fill_tick > now) {
+    mshr_fill_ticks.push_back(fill_tick);
+  }
+  return writeback;
+}
+
+bool L1Cache::mark_dirty(uint64_t addr) {
+  Line *line = find(addr);
+  if (!line) {
+    return false;
+  }
+  line->dirty = true;
+  line->last_use = ++use_counter;
+  return true;
+}
+
+bool L1Cache::invalidate(uint64_t addr, bool *was_present) {
+  Line *line = find(addr);
+  if (was_present) {
+    *was_present = line != nullptr;
+  }
+  if (!line) {
+    return false;
+  }
+  bool dirty = line->dirty;
+  *line = Line();
+  return dirty;
+}
+
+size_t L1Cache::free_mshrs(size_t now) {
+  mshr_fill_ticks.erase(std::remove_if(mshr_fill_ticks.begin(), mshr_fill_ticks.end(),
+                                       [now](size_t tick) { return tick <= now; }),
+                        mshr_fill_ticks.end());
+  return mshr_fill_ticks.size() >= config.mshrs ? 0 : config.mshrs - mshr_fill_ticks.size();
+}
+
+void L1Cache::clear_mshrs() {
+  mshr_fill_ticks.clear();
+  for (Line &line : lines) {
+    line.ready_tick = 0;
+  }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "config.hpp"
+
+/*
+ * Set-associative, LRU L1 data cache in front of DRAM (--l1-size).
+ *
+ * Only tags are kept: the data always lives in DataMemory, so the cache
+ * changes timing and DRAM traffic but never a loaded value. A line that
+ * missed is allocated straight away with the tick its fill arrives, and
+ * holds one of the MSHRs until then. Later accesses to it merge into the
+ * outstanding fill instead of going to DRAM again.
+ */
+class L1Cache {
+public:
+  // Cycles from the coalescing unit's exit stage until a hit is returned
+  static constexpr size_t HIT_LATENCY = 2;
+
+  enum Outcome {
+    HIT,
+    MSHR_MERGE,  // The line is still being filled
+    MISS
+  };
+
+  explicit L1Cache(const L1CacheConfig &config);
+
+  // Empty if the configuration can be built, otherwise what is wrong with it
+  static std::string config_error(const L1CacheConfig &config);
+
+  const L1CacheConfig &get_config() const { return config; }
+  uint64_t line_addr(uint64_t addr) const { return addr & ~(config.line_bytes - 1); }
+  // DRAM beats to fill or write back one line
+  size_t line_beats() const;
+
+  /*
+   * Looks up the line holding addr at tick now. On a hit or merge,
+   * *ready_tick is when the data is available. touch=false leaves the
+   * LRU order alone, for checks that do not access the line.
+   */
+  Outcome lookup(uint64_t addr, size_t now, size_t *ready_tick, bool touch = true);
+
+  /*
+   * Allocates the line holding addr, evicting the LRU way of its set.
+   * A fill (fill_tick > now) takes an MSHR until fill_tick; a write-back
+   * store allocates a line that is ready and dirty. Returns true if a
+   * dirty line was evicted and has to be written back; *victim_line is
+   * then its address.
+   */
+  bool allocate(uint64_t addr, size_t now, size_t fill_tick, bool dirty,
+                uint64_t *victim_line = nullptr);
+
+  // Marks a present line dirty (write-back stores); false if it is absent
+  bool mark_dirty(uint64_t addr);
+
+  // Invalidates the line holding addr. Returns true if it was dirty.
+  bool invalidate(uint64_t addr, bool *was_present = nullptr);
+
+  size_t free_mshrs(size_t now);
+  // Outstanding fills are dropped, e.g. when the DRAM state is reset
+  void clear_mshrs();
+
+private:
+  struct Line {
+    bool valid = false;
+    bool dirty = false;
+    uint64_t tag = 0;
+    uint64_t last_use = 0;
+    size_t ready_tick = 0;
+  };
+
+  Line *find(uint64_t addr);
+  size_t set_index(uint64_t addr) const;
+
+  L1CacheConfig config;
+  size_t num_sets;
+  std::vector<Line> lines;  // num_sets * ways, set-major
+  std::vector<size_t> mshr_fill_ticks;
+  uint64_t use_counter = 0;
+};
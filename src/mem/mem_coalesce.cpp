@@ -3,7 +3,9 @@
 #include "config.hpp"
 #include "gen/gen_llvm_riscv_registers.h"
 #include "stats/stats.hpp"
+#include "stats/profiler.hpp"
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <iostream>
 #include <set>
@@ -11,28 +13,87 @@
 #include <iomanip>
 #include <cstdint>
 
-CoalescingUnit::CoalescingUnit(DataMemory *scratchpad_mem, const std::string *trace_file)
-    : scratchpad_mem(scratchpad_mem) {
+CoalescingUnit::CoalescingUnit(DataMemory *scratchpad_mem, const std::string *trace_file,
+                               TraceFormat trace_format)
+    : scratchpad_mem(scratchpad_mem), sram(Config::instance().sramConfig()),
+      scoreboard_depth(Config::instance().loadScoreboard()),
+      write_buffer_capacity(Config::instance().writeCombining()),
+      combine_atomics(Config::instance().isAtomicCombining()) {
   if (trace_file != nullptr) {
-    tracer = std::make_unique<Tracer>(*trace_file);
+    tracer = std::make_unique<Tracer>(*trace_file, trace_format);
+  }
+  const L1CacheConfig &l1_config = Config::instance().l1Cache();
+  if (l1_config.size_bytes > 0) {
+    l1 = std::make_unique<L1Cache>(l1_config);
+  }
+  const DramConfig &dram_config = Config::instance().dramConfig();
+  if (dram_config.model == DRAM_BANKED) {
+    dram = std::make_unique<BankedDram>(dram_config);
   }
 }
 
 CoalescingUnit::~CoalescingUnit() {
 }
 
+static uint64_t issuing_pc(Warp *warp, const std::vector<size_t> &active_threads) {
+  if (!active_threads.empty() && active_threads[0] < warp->pc.size()) {
+    return warp->pc[active_threads[0]];
+  }
+  return warp->pc.empty() ? 0 : warp->pc[0];
+}
+
+/*
+ * Lane 0's address if the lanes access consecutive elements of one
+ * aligned block, as a unit-stride affine register produces. The general
+ * coalescer serves such a warp with a single request, so it is skipped.
+ */
+static std::optional<uint64_t> unit_stride_base(const std::vector<uint64_t> &addrs,
+                                                size_t access_size) {
+  if (addrs.size() != NUM_LANES || (access_size != 1 && access_size != 2 && access_size != 4)) {
+    return std::nullopt;
+  }
+  uint64_t base = addrs[0];
+  if (base % (NUM_LANES * access_size) != 0) {
+    return std::nullopt;
+  }
+  auto in_sram = [](uint64_t addr) {
+    uint64_t addr_32 = 0xFFFFFFFF & addr;
+    return SIM_SHARED_SRAM_BASE <= addr_32 && addr_32 < SIM_SIMT_STACK_BASE;
+  };
+  if (in_sram(base) || in_sram(base + (NUM_LANES - 1) * access_size)) {
+    return std::nullopt;
+  }
+  for (size_t lane = 1; lane < NUM_LANES; lane++) {
+    if (addrs[lane] != base + lane * access_size) {
+      return std::nullopt;
+    }
+  }
+  return base;
+}
+
 bool CoalescingUnit::can_put() {
   return pending_request_queue.size() < MEM_REQ_QUEUE_CAPACITY;
 }
 
 int CoalescingUnit::calculate_bursts(const std::vector<uint64_t> &addrs,
-                                     size_t access_size, bool is_store) {
+                                     size_t access_size, bool is_store,
+                                     std::vector<uint64_t> *beat_addrs) {
   constexpr size_t LOG_LANES = 5;
 
   if (addrs.empty()) {
     return 0;
   }
 
+  if (std::optional<uint64_t> base = unit_stride_base(addrs, access_size)) {
+    int bursts = access_size >= 4 ? 2 : 1;
+    if (beat_addrs) {
+      for (int b = 0; b < bursts; b++) {
+        beat_addrs->push_back((*base & ~(DRAM_BEAT_BYTES - 1)) + b * DRAM_BEAT_BYTES);
+      }
+    }
+    return bursts;
+  }
+
   std::vector<std::pair<size_t, uint64_t>> pending;
   for (size_t lane = 0; lane < addrs.size(); lane++) {
     uint64_t addr = addrs[lane];
@@ -126,6 +187,14 @@ int CoalescingUnit::calculate_bursts(const std::vector<uint64_t> &addrs,
     }
 
     total_dram_accesses += bursts_for_this_access;
+    if (beat_addrs) {
+      // A whole block of words is two beats, anything else one
+      uint64_t first_beat = bursts_for_this_access == 2 ? leader_block << (LOG_LANES + 2)
+                                                        : leader_addr & ~(DRAM_BEAT_BYTES - 1);
+      for (int b = 0; b < bursts_for_this_access; b++) {
+        beat_addrs->push_back(first_beat + b * DRAM_BEAT_BYTES);
+      }
+    }
 
     std::set<size_t> served_set(served_lanes->begin(), served_lanes->end());
     std::vector<std::pair<size_t, uint64_t>> remaining;
@@ -144,6 +213,7 @@ int CoalescingUnit::calculate_request_count(const std::vector<uint64_t> &addrs,
                                            size_t access_size) {
   constexpr size_t LOG_LANES = 5;
   if (addrs.empty()) return 0;
+  if (unit_stride_base(addrs, access_size)) return 1;
 
   std::vector<std::pair<size_t, uint64_t>> pending;
   for (size_t lane = 0; lane < addrs.size(); lane++) {
@@ -345,7 +415,90 @@ bool CoalescingUnit::is_sram_access(const MemRequest &req) const {
   return true;
 }
 
-int CoalescingUnit::calculate_sram_bank_conflicts(const MemRequest &req) const {
+static int apply_atomic(AtomicOp op, int old_value, int operand) {
+  uint32_t u_old = static_cast<uint32_t>(old_value);
+  uint32_t u_operand = static_cast<uint32_t>(operand);
+  switch (op) {
+  case AMO_ADD: return static_cast<int>(u_old + u_operand);
+  case AMO_SWAP: return operand;
+  case AMO_AND: return old_value & operand;
+  case AMO_OR: return old_value | operand;
+  case AMO_XOR: return old_value ^ operand;
+  case AMO_MIN: return std::min(old_value, operand);
+  case AMO_MAX: return std::max(old_value, operand);
+  case AMO_MINU: return static_cast<int>(std::min(u_old, u_operand));
+  case AMO_MAXU: return static_cast<int>(std::max(u_old, u_operand));
+  }
+  return old_value;
+}
+
+/*
+ * Lanes update memory in lane order, so each sees the value the lanes
+ * before it left. With atomic combining, lanes on the same word are
+ * folded into one read-modify-write; the old values returned are the
+ * same as if every lane had gone to memory on its own.
+ */
+std::map<size_t, int> CoalescingUnit::perform_atomic(const MemRequest &req) {
+  std::map<size_t, int> results;
+  std::map<uint64_t, std::vector<size_t>> lanes_by_addr;
+  std::vector<uint64_t> order;
+  for (size_t i = 0; i < req.addrs.size(); i++) {
+    uint64_t addr = translate_stack_address(req.addrs[i], req.warp, req.active_threads[i]);
+    if (!combine_atomics) {
+      int old_value = static_cast<int>(scratchpad_mem->load(addr, req.bytes));
+      int new_value = apply_atomic(req.atomic_op, old_value, req.atomic_operands[i]);
+      scratchpad_mem->store(addr, req.bytes, static_cast<uint32_t>(new_value));
+      results[req.active_threads[i]] = old_value;
+      continue;
+    }
+    std::vector<size_t> &lanes = lanes_by_addr[addr];
+    if (lanes.empty()) {
+      order.push_back(addr);
+    }
+    lanes.push_back(i);
+  }
+
+  for (uint64_t addr : order) {
+    int value = static_cast<int>(scratchpad_mem->load(addr, req.bytes));
+    for (size_t i : lanes_by_addr[addr]) {
+      results[req.active_threads[i]] = value;
+      value = apply_atomic(req.atomic_op, value, req.atomic_operands[i]);
+    }
+    scratchpad_mem->store(addr, req.bytes, static_cast<uint32_t>(value));
+  }
+
+  if (!req.warp->is_cpu) {
+    GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+    size_t rmws = combine_atomics ? order.size() : req.addrs.size();
+    stats.add_atomics(ATOMIC_WARP_INSTRS, 1);
+    stats.add_atomics(ATOMIC_LANE_OPS, req.addrs.size());
+    stats.add_atomics(ATOMIC_RMWS, rmws);
+    stats.add_atomics(ATOMIC_COMBINED, req.addrs.size() - rmws);
+  }
+  return results;
+}
+
+std::string CoalescingUnit::sram_config_error(const SramConfig &config) {
+  if (config.banks == 0 || (config.banks & (config.banks - 1)) != 0 ||
+      config.banks > MAX_SRAM_BANKS) {
+    return "the bank count must be a power of two up to " + std::to_string(MAX_SRAM_BANKS);
+  }
+  if (config.queue_depth == 0) {
+    return "the queue depth must be at least 1";
+  }
+  return "";
+}
+
+size_t CoalescingUnit::sram_bank(uint64_t addr) const {
+  uint64_t word = addr >> 2;
+  if (sram.hash == SRAM_HASH_XOR) {
+    // Each row of banks * words starts on a different bank
+    word ^= word / sram.banks;
+  }
+  return word & (sram.banks - 1);
+}
+
+int CoalescingUnit::sram_conflict_degree(const MemRequest &req) const {
   if (!req.is_store && !req.is_atomic && req.addrs.size() > 1) {
     bool all_same = true;
     for (size_t i = 1; i < req.addrs.size(); i++) {
@@ -354,19 +507,25 @@ int CoalescingUnit::calculate_sram_bank_conflicts(const MemRequest &req) const {
         break;
       }
     }
-    if (all_same) return 2;
+    if (all_same) return 1;
   }
 
-  int bank_count[SRAM_BANKS] = {};
-  for (const auto &addr : req.addrs) {
-    int bank = (addr >> 2) & (SRAM_BANKS - 1);
-    bank_count[bank]++;
-  }
-  int max_per_bank = 0;
-  for (size_t i = 0; i < SRAM_BANKS; i++) {
-    max_per_bank = std::max(max_per_bank, bank_count[i]);
+  std::array<int, MAX_SRAM_BANKS> bank_count = {};
+  if (req.is_atomic && combine_atomics) {
+    // Lanes on the same word share one read-modify-write
+    for (uint64_t addr : std::set<uint64_t>(req.addrs.begin(), req.addrs.end())) {
+      bank_count[sram_bank(addr)]++;
+    }
+  } else {
+    for (const auto &addr : req.addrs) {
+      bank_count[sram_bank(addr)]++;
+    }
   }
-  return std::max(max_per_bank, 2);
+  return *std::max_element(bank_count.begin(), bank_count.begin() + sram.banks);
+}
+
+int CoalescingUnit::calculate_sram_bank_conflicts(const MemRequest &req) const {
+  return std::max(sram_conflict_degree(req), 2);
 }
 
 /*
@@ -481,11 +640,18 @@ void CoalescingUnit::load(Warp *warp, const std::vector<uint64_t> &addrs,
   req.is_zero_extend = is_zero_extend;
   req.rd_reg = rd_reg;
   req.active_threads = active_threads;
+  req.pc = issuing_pc(warp, active_threads);
+  bool scoreboarded = uses_scoreboard(warp);
+  if (scoreboarded) {
+    req.load_id = next_load_id++;
+  }
   pending_request_queue.push(req);
 
-  warp->suspended = true;
+  if (!scoreboarded) {
+    warp->suspended = true;
+  }
 
-  if (instr_tracer && !warp->is_cpu) {
+  if (instr_tracer && !warp->is_cpu && !scoreboarded) {
     TraceEvent event;
     event.cycle = GPUStatisticsManager::instance().get_gpu_cycles();
     event.pc = warp->pc[0];
@@ -509,18 +675,21 @@ void CoalescingUnit::load(Warp *warp, const std::vector<uint64_t> &addrs,
             + SIM_DRAM_RESP_OVERHEAD
             + bursts_extra;
   }
-  blocked_warps[warp] = latency;
+  if (scoreboarded) {
+    OutstandingLoad load;
+    load.id = req.load_id;
+    load.rd_reg = rd_reg;
+    load.remaining = latency;
+    scoreboard[warp].push_back(load);
+    GPUStatisticsManager::instance().increment_scoreboard(SB_LOADS);
+  } else {
+    blocked_warps[warp] = latency;
+  }
 
   int dram_access_count = sim_bursts;
-  for (int i = 0; i < dram_access_count; i++) {
-    if (warp->is_cpu) {
-      GPUStatisticsManager::instance().increment_cpu_dram_accs();
-      if (GPUStatisticsManager::instance().is_gpu_pipeline_active()) {
-        GPUStatisticsManager::instance().increment_gpu_active_cpu_dram_accs();
-      }
-    } else {
-      GPUStatisticsManager::instance().increment_gpu_dram_accs();
-    }
+  // With the L1 the DRAM traffic is only known once the request exits
+  if (!uses_l1(warp)) {
+    count_dram_accs(warp, dram_access_count);
   }
 }
 
@@ -552,19 +721,14 @@ void CoalescingUnit::store(Warp *warp, const std::vector<uint64_t> &addrs,
   req.is_fence = false;
   req.store_values = vals;
   req.active_threads = active_threads;
+  req.pc = issuing_pc(warp, active_threads);
   pending_request_queue.push(req);
 
   std::vector<uint64_t> phys_addrs = build_translated_lane_addrs(warp, addrs, active_threads);
   int dram_access_count = calculate_bursts(phys_addrs, bytes, true);
-  for (int i = 0; i < dram_access_count; i++) {
-    if (warp->is_cpu) {
-      GPUStatisticsManager::instance().increment_cpu_dram_accs();
-      if (GPUStatisticsManager::instance().is_gpu_pipeline_active()) {
-        GPUStatisticsManager::instance().increment_gpu_active_cpu_dram_accs();
-      }
-    } else {
-      GPUStatisticsManager::instance().increment_gpu_dram_accs();
-    }
+  // With the L1 or the write buffer the DRAM traffic is only known once the request exits
+  if (!uses_l1(warp) && !uses_write_buffer(warp)) {
+    count_dram_accs(warp, dram_access_count);
   }
 }
 
@@ -577,6 +741,7 @@ void CoalescingUnit::fence(Warp *warp) {
   req.is_atomic = false;
   req.is_fence = true;
   req.active_threads = {};
+  req.pc = issuing_pc(warp, {});
   pending_request_queue.push(req);
 
   warp->suspended = true;
@@ -599,10 +764,10 @@ void CoalescingUnit::fence(Warp *warp) {
   blocked_warps[warp] = latency;
 }
 
-void CoalescingUnit::atomic_add(Warp *warp, const std::vector<uint64_t> &addrs,
-                                 size_t bytes, unsigned int rd_reg,
-                                 const std::vector<int> &add_values,
-                                 const std::vector<size_t> &active_threads) {
+void CoalescingUnit::atomic(Warp *warp, const std::vector<uint64_t> &addrs,
+                            size_t bytes, unsigned int rd_reg, AtomicOp op,
+                            const std::vector<int> &operands,
+                            const std::vector<size_t> &active_threads) {
   if (tracer && !warp->is_cpu) {
     TraceEvent event;
     event.cycle = GPUStatisticsManager::instance().get_gpu_cycles();
@@ -626,9 +791,11 @@ void CoalescingUnit::atomic_add(Warp *warp, const std::vector<uint64_t> &addrs,
   req.is_store = false;
   req.is_atomic = true;
   req.is_fence = false;
-  req.atomic_add_values = add_values;
+  req.atomic_op = op;
+  req.atomic_operands = operands;
   req.rd_reg = rd_reg;
   req.active_threads = active_threads;
+  req.pc = issuing_pc(warp, active_threads);
   pending_request_queue.push(req);
 
   warp->suspended = true;
@@ -658,21 +825,15 @@ void CoalescingUnit::atomic_add(Warp *warp, const std::vector<uint64_t> &addrs,
   blocked_warps[warp] = latency;
 
   int dram_access_count = sim_bursts;
-  for (int i = 0; i < dram_access_count; i++) {
-    if (warp->is_cpu) {
-      GPUStatisticsManager::instance().increment_cpu_dram_accs();
-      if (GPUStatisticsManager::instance().is_gpu_pipeline_active()) {
-        GPUStatisticsManager::instance().increment_gpu_active_cpu_dram_accs();
-      }
-    } else {
-      GPUStatisticsManager::instance().increment_gpu_dram_accs();
-    }
+  // With the L1 the DRAM traffic is only known once the request exits
+  if (!uses_l1(warp)) {
+    count_dram_accs(warp, dram_access_count);
   }
 }
 
 bool CoalescingUnit::is_busy() {
-  return !pending_request_queue.empty() || !blocked_warps.empty()
-      || coalescing_remaining > 0 || coalescing_waiting;
+  return !pending_request_queue.empty() || !blocked_warps.empty() || !scoreboard.empty()
+      || coalescing_remaining > 0 || coalescing_waiting || !write_buffer.empty();
 }
 
 void CoalescingUnit::reset_dram_state() {
@@ -688,6 +849,17 @@ void CoalescingUnit::reset_dram_state() {
   while (!sram_queue.empty()) sram_queue.pop();
   sram_processing_remaining = 0;
   next_dram_resp_available = 0;
+  if (l1) {
+    l1->clear_mshrs();
+  }
+  if (dram) {
+    dram->reset();
+  }
+  // Loads dropped from the pipeline above would never complete
+  scoreboard.clear();
+  scoreboard_waits.clear();
+  write_buffer.clear();
+  write_buffer_exit_beats = 0;
 }
 
 bool CoalescingUnit::is_busy_for_pipeline(bool is_cpu_pipeline) {
@@ -696,6 +868,11 @@ bool CoalescingUnit::is_busy_for_pipeline(bool is_cpu_pipeline) {
       return true;
     }
   }
+  for (auto &[key, loads] : scoreboard) {
+    if (key->is_cpu == is_cpu_pipeline) {
+      return true;
+    }
+  }
   return false;
 }
 
@@ -704,6 +881,17 @@ Warp *CoalescingUnit::get_resumable_warp_for_pipeline(bool is_cpu_pipeline) {
 
   for (auto &[key, val] : blocked_warps) {
     if (val == 0 && key->is_cpu == is_cpu_pipeline) {
+      // A warp stopped by the scoreboard only waits for its own operands
+      auto wait = scoreboard_waits.find(key);
+      if (wait != scoreboard_waits.end()) {
+        if (scoreboard_blocks(key, wait->second)) {
+          continue;
+        }
+        scoreboard_waits.erase(wait);
+        resumable_warp = key;
+        break;
+      }
+
       bool still_in_queues = false;
       {
         std::queue<MemRequest> tmp = pending_request_queue;
@@ -774,7 +962,13 @@ Warp *CoalescingUnit::get_resumable_warp_for_pipeline(bool is_cpu_pipeline) {
     divider_warp = nullptr;
   }
 
+  if (resumable_warp == fp_divider_warp) {
+    fp_divider_warp = nullptr;
+  }
+
   mul_pipeline_warps.erase(resumable_warp);
+  fpu_pipeline_warps.erase(resumable_warp);
+  func_unit_warps.erase(resumable_warp);
 
   blocked_warps.erase(resumable_warp);
   return resumable_warp;
@@ -791,6 +985,7 @@ void CoalescingUnit::suspend_for_func_unit(Warp *warp, size_t latency,
   warp->suspended = true;
   blocked_warps[warp] = latency;
   load_results_map[warp] = {rd_reg, results};
+  func_unit_warps.insert(warp);
 
   if (instr_tracer) {
     TraceEvent event;
@@ -833,12 +1028,15 @@ void CoalescingUnit::tick() {
   if (pipeline_stages[EXIT_STAGE]) {
     bool is_sram = is_sram_access(pipeline_stages[EXIT_STAGE]->req);
     if (is_sram) {
-      if (sram_queue.size() >= SRAM_QUEUE_CAPACITY) {
+      if (sram_queue.size() >= sram.queue_depth) {
         stalling = true;
       }
     } else {
       if (go5_current > 0 || old_dram_inflight >= DRAM_MAX_INFLIGHT) {
         stalling = true;
+      } else if (l1_mshrs_full(pipeline_stages[EXIT_STAGE]->req)) {
+        stalling = true;
+        GPUStatisticsManager::instance().increment_l1(L1_MSHR_STALLS);
       }
     }
   }
@@ -870,8 +1068,16 @@ void CoalescingUnit::tick() {
       bool is_sram = is_sram_access(pipe_req.req);
 
       if (is_sram) {
-        int bank_cycles = calculate_sram_bank_conflicts(pipe_req.req);
+        int degree = sram_conflict_degree(pipe_req.req);
+        int bank_cycles = std::max(degree, 2);
         sram_queue.push(bank_cycles);
+        if (!pipe_req.req.warp->is_cpu) {
+          GPUStatisticsManager::instance().record_sram_access(pipe_req.req.pc, degree);
+        }
+        if (PCProfiler::instance().is_enabled() && !pipe_req.req.warp->is_cpu) {
+          // A conflict-free access takes the minimum of 2 cycles
+          PCProfiler::instance().record_sram_conflict_cycles(pipe_req.req.pc, bank_cycles - 2);
+        }
         if (sram_processing_remaining == 0) {
           sram_processing_remaining = sram_queue.front();
           sram_queue.pop();
@@ -890,6 +1096,10 @@ void CoalescingUnit::tick() {
       }
 
       process_mem_request(pipe_req.req);
+      if (exit_is_store && uses_write_buffer(pipe_req.req.warp)) {
+        // Only the beats the buffer wrote out use the DRAM port
+        exit_burst_len = std::max(1, write_buffer_exit_beats);
+      }
       pipeline_stages[EXIT_STAGE] = std::nullopt;
       exit_happened = true;
       inflight_decr = 1;
@@ -915,6 +1125,20 @@ void CoalescingUnit::tick() {
     }
   }
 
+  if (!write_buffer.empty() && !pipeline_stages[EXIT_STAGE] && go5_busy_remaining == 0 &&
+      old_dram_inflight < DRAM_MAX_INFLIGHT) {
+    auto stale = std::find_if(write_buffer.begin(), write_buffer.end(),
+                              [this](const WriteCombineEntry &e) {
+                                return tick_counter - e.last_write >= WRITE_COMBINE_TIMEOUT;
+                              });
+    if (stale != write_buffer.end()) {
+      GPUStatisticsManager::instance().add_write_combining(WC_DRAINS, 1);
+      write_out({*stale});
+      write_buffer.erase(stale);
+      go5_busy_remaining = 1;
+    }
+  }
+
   bool can_consume = space_for_two
                    && (!stalling || !old_occupied[1])
                    && go5_busy_remaining == 0
@@ -965,6 +1189,17 @@ void CoalescingUnit::tick() {
     if (val > 0)
       val--;
   }
+  for (auto &[key, loads] : scoreboard) {
+    for (OutstandingLoad &load : loads) {
+      if (load.remaining > 0)
+        load.remaining--;
+    }
+  }
+
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+  if (write_buffer_capacity > 0 && stats.is_gpu_pipeline_active()) {
+    stats.note_write_combining_entries(write_buffer.size());
+  }
 }
 
 void CoalescingUnit::process_mem_request(const MemRequest &req) {
@@ -998,19 +1233,7 @@ void CoalescingUnit::process_mem_request(const MemRequest &req) {
   if (req.is_fence) {
     // do nothing
   } else if (req.is_atomic) {
-    std::map<size_t, int> results;
-    for (size_t i = 0; i < req.addrs.size(); i++) {
-      uint64_t virtual_addr = req.addrs[i];
-      uint64_t addr = translate_stack_address(virtual_addr, req.warp, req.active_threads[i]);
-
-      int64_t old_value = scratchpad_mem->load(addr, req.bytes);
-      int64_t new_value = old_value + req.atomic_add_values[i];
-
-      scratchpad_mem->store(addr, req.bytes, static_cast<uint64_t>(new_value));
-      results[req.active_threads[i]] = static_cast<int>(old_value);
-    }
-    
-    load_results_map[req.warp] = std::make_pair(req.rd_reg, results);
+    load_results_map[req.warp] = std::make_pair(req.rd_reg, perform_atomic(req));
   } else if (req.is_store) {
     assert(req.addrs.size() == req.store_values.size() && "Store request: addresses and values must have same size");
     
@@ -1044,22 +1267,31 @@ void CoalescingUnit::process_mem_request(const MemRequest &req) {
       results[req.active_threads[i]] = static_cast<int>(value);
     }
     
-    load_results_map[req.warp] = std::make_pair(req.rd_reg, results);
+    if (req.load_id != 0) {
+      for (OutstandingLoad &load : scoreboard[req.warp]) {
+        if (load.id == req.load_id) {
+          load.processed = true;
+          load.results = std::move(results);
+        }
+      }
+    } else {
+      load_results_map[req.warp] = std::make_pair(req.rd_reg, results);
+    }
   }
 
   if (!req.is_fence && !req.addrs.empty() && is_sram_access(req)) {
     if (!req.is_store) {
-      auto it = blocked_warps.find(req.warp);
-      if (it != blocked_warps.end()) {
+      size_t *latency = remaining_latency(req);
+      if (latency) {
         size_t queue_wait = sram_processing_remaining;
         std::queue<int> tmp = sram_queue;
         while (!tmp.empty()) {
           queue_wait += tmp.front();
           tmp.pop();
         }
-        size_t sram_latency = queue_wait + BANKED_SRAM_LATENCY;
-        if (sram_latency > it->second) {
-          it->second = sram_latency;
+        size_t sram_latency = queue_wait + sram.latency;
+        if (sram_latency > *latency) {
+          *latency = sram_latency;
         }
       }
     }
@@ -1070,81 +1302,385 @@ void CoalescingUnit::process_mem_request(const MemRequest &req) {
     int groups = 1;
 
     if (dram_trace && !req.warp->is_cpu) {
-      uint64_t cycle = GPUStatisticsManager::instance().get_gpu_cycles();
-      *dram_trace << cycle << "," << req.warp->warp_id << ","
-                  << "F" << "," << beats << "," << groups << ","
-                  << "DRAM" << "," << "0x0"
-                  << "\n";
-    }
-
-    size_t first_resp_arrival = tick_counter + 2 + dram_queue_depth + SIM_DRAM_LATENCY;
-    size_t total_resp_processing = static_cast<size_t>(beats + groups);
-    size_t resp_start = std::max(first_resp_arrival, next_dram_resp_available);
-    next_dram_resp_available = resp_start + total_resp_processing;
-    size_t group_complete_tick = next_dram_resp_available;
-    dram_response_schedule.push({group_complete_tick, groups});
-
-    size_t resume_tick = next_dram_resp_available + 3;
-    size_t dram_latency = resume_tick - tick_counter;
-
-    auto it = blocked_warps.find(req.warp);
-    if (it != blocked_warps.end()) {
-      if (dram_latency > static_cast<size_t>(it->second)) {
-        it->second = dram_latency;
-      }
+      TraceEvent event;
+      event.cycle = GPUStatisticsManager::instance().get_gpu_cycles();
+      event.warp_id = req.warp->warp_id;
+      event.event_type = DRAM_ACCESS;
+      event.access_type = 'F';
+      event.beats = beats;
+      event.groups = groups;
+      dram_trace->trace_event(event);
     }
 
+    drain_write_buffer(nullptr, 0);
+    block_until(req, schedule_dram_read({}, beats, groups));
     dram_queue_depth += beats;
-    dram_inflight += groups;
   }
 
   if (!req.is_fence && !req.addrs.empty()) {
     std::vector<uint64_t> phys_addrs = build_translated_lane_addrs(
         req.warp, req.addrs, req.active_threads);
-    int beats = calculate_bursts(phys_addrs, req.bytes, req.is_store);
+    std::vector<uint64_t> beat_addrs;
+    int beats = calculate_bursts(phys_addrs, req.bytes, req.is_store, &beat_addrs);
     bool is_sram = is_sram_access(req);
     int groups = calculate_request_count(phys_addrs, req.bytes);
+    bool through_l1 = !is_sram && uses_l1(req.warp);
+    if (through_l1) {
+      L1Traffic traffic = access_l1(req, phys_addrs, beat_addrs, groups);
+      beats = traffic.beats;
+      groups = traffic.groups;
+    }
+    bool buffered = !is_sram && req.is_store && uses_write_buffer(req.warp);
+    if (buffered) {
+      beats = buffer_store(phys_addrs, req.bytes);
+      groups = beats > 0 ? 1 : 0;
+      write_buffer_exit_beats = beats;
+    } else if (!is_sram && uses_write_buffer(req.warp)) {
+      // A load or atomic reads DRAM after the buffered stores to its beats
+      drain_write_buffer(&phys_addrs, req.bytes);
+    }
+
+    if (!is_sram && PCProfiler::instance().is_enabled() && !req.warp->is_cpu) {
+      PCProfiler::instance().record_dram_beats(req.pc, beats);
+    }
 
     if (dram_trace && !req.warp->is_cpu) {
-      uint64_t cycle = GPUStatisticsManager::instance().get_gpu_cycles();
-      char type = req.is_atomic ? 'A' : (req.is_store ? 'S' : 'L');
       uint64_t addr = 0;
       if (!phys_addrs.empty()) {
         for (auto a : phys_addrs) { if (a != SIM_SHARED_SRAM_BASE) { addr = a; break; } }
       }
-      *dram_trace << cycle << "," << req.warp->warp_id << ","
-                  << type << "," << beats << "," << groups << ","
-                  << (is_sram ? "SRAM" : "DRAM") << ","
-                  << "0x" << std::hex << (addr >> DRAM_BEAT_LOG_BYTES) << std::dec
-                  << "\n";
+      TraceEvent event;
+      event.cycle = GPUStatisticsManager::instance().get_gpu_cycles();
+      event.pc = addr >> DRAM_BEAT_LOG_BYTES;
+      event.warp_id = req.warp->warp_id;
+      event.event_type = DRAM_ACCESS;
+      event.access_type = req.is_atomic ? 'A' : (req.is_store ? 'S' : 'L');
+      event.beats = beats;
+      event.groups = groups;
+      event.is_sram = is_sram;
+      dram_trace->trace_event(event);
+    }
+
+    if (beats > 0 && !through_l1 && !buffered) {
+      if (req.is_store) {
+        schedule_dram_write(beat_addrs);
+      } else {
+        block_until(req, schedule_dram_read(beat_addrs, beats, groups));
+        dram_queue_depth += beats;
+      }
     }
+  }
+}
 
-    if (beats > 0) {
-      if (!req.is_store) {
-        size_t first_resp_arrival = tick_counter + 2 + dram_queue_depth + SIM_DRAM_LATENCY;
+size_t CoalescingUnit::schedule_dram_read(const std::vector<uint64_t> &beat_addrs, int beats,
+                                          int groups) {
+  size_t first_resp_arrival;
+  if (dram) {
+    // Responses are still taken one beat per cycle, so they can start
+    // once the beats would have arrived back to back
+    size_t last_beat = beat_addrs.empty() ? dram->drain_tick(tick_counter + 2)
+                                          : dram->access(beat_addrs, tick_counter + 2, false);
+    first_resp_arrival = last_beat - std::min<size_t>(last_beat, beats);
+  } else {
+    first_resp_arrival = tick_counter + 2 + dram_queue_depth + SIM_DRAM_LATENCY;
+  }
+  size_t total_resp_processing = static_cast<size_t>(beats + groups);
+  size_t resp_start = std::max(first_resp_arrival, next_dram_resp_available);
+  next_dram_resp_available = resp_start + total_resp_processing;
 
-        size_t total_resp_processing = static_cast<size_t>(beats + groups);
+  size_t group_complete_tick = next_dram_resp_available;
+  dram_response_schedule.push({group_complete_tick, groups});
+  dram_inflight += groups;
 
-        size_t resp_start = std::max(first_resp_arrival, next_dram_resp_available);
-        next_dram_resp_available = resp_start + total_resp_processing;
+  return next_dram_resp_available + 3;
+}
 
-        size_t group_complete_tick = next_dram_resp_available;
-        dram_response_schedule.push({group_complete_tick, groups});
+void CoalescingUnit::schedule_dram_write(const std::vector<uint64_t> &beat_addrs) {
+  if (dram) {
+    dram->access(beat_addrs, tick_counter + 2, true);
+  }
+  dram_queue_depth += beat_addrs.size();
+}
 
-        size_t resume_tick = next_dram_resp_available + 3;
-        size_t dram_latency = resume_tick - tick_counter;
+// Bytes of each DRAM beat the non-SRAM lanes touch, in the order the beats are first seen
+static std::vector<std::pair<uint64_t, uint64_t>> beat_byte_masks(
+    const std::vector<uint64_t> &phys_addrs, size_t bytes) {
+  static_assert(DRAM_BEAT_BYTES == 64, "a beat's byte mask is one uint64_t");
+  std::vector<std::pair<uint64_t, uint64_t>> masks;
+  for (uint64_t addr : phys_addrs) {
+    uint64_t addr_32 = addr & 0xFFFFFFFF;
+    if (SIM_SHARED_SRAM_BASE <= addr_32 && addr_32 < SIM_SIMT_STACK_BASE) {
+      continue;
+    }
+    for (size_t b = 0; b < bytes; b++) {
+      uint64_t beat = (addr + b) & ~(DRAM_BEAT_BYTES - 1);
+      uint64_t bit = 1ULL << ((addr + b) & (DRAM_BEAT_BYTES - 1));
+      auto it = std::find_if(masks.begin(), masks.end(),
+                             [beat](const auto &m) { return m.first == beat; });
+      if (it == masks.end()) {
+        masks.push_back({beat, bit});
+      } else {
+        it->second |= bit;
+      }
+    }
+  }
+  return masks;
+}
 
-        auto it = blocked_warps.find(req.warp);
-        if (it != blocked_warps.end()) {
-          if (dram_latency > static_cast<size_t>(it->second)) {
-            it->second = dram_latency;
-          }
+int CoalescingUnit::buffer_store(const std::vector<uint64_t> &phys_addrs, size_t bytes) {
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+  std::vector<WriteCombineEntry> written;
+  for (const auto &[beat, mask] : beat_byte_masks(phys_addrs, bytes)) {
+    stats.add_write_combining(WC_STORE_BEATS, 1);
+    auto it = std::find_if(write_buffer.begin(), write_buffer.end(),
+                           [beat = beat](const WriteCombineEntry &e) { return e.beat == beat; });
+    if (it != write_buffer.end()) {
+      stats.add_write_combining(WC_MERGES, 1);
+      it->byte_mask |= mask;
+      it->last_write = tick_counter;
+    } else {
+      if (write_buffer.size() >= write_buffer_capacity) {
+        stats.add_write_combining(WC_EVICTIONS, 1);
+        written.push_back(write_buffer.front());
+        write_buffer.erase(write_buffer.begin());
+      }
+      write_buffer.push_back({beat, mask, tick_counter});
+      it = write_buffer.end() - 1;
+    }
+    if (it->byte_mask == ~0ULL) {
+      written.push_back(*it);
+      write_buffer.erase(it);
+    }
+  }
+  write_out(written);
+  return static_cast<int>(written.size());
+}
+
+void CoalescingUnit::drain_write_buffer(const std::vector<uint64_t> *phys_addrs, size_t bytes) {
+  if (write_buffer.empty()) {
+    return;
+  }
+  std::vector<uint64_t> beats;
+  if (phys_addrs) {
+    for (const auto &[beat, mask] : beat_byte_masks(*phys_addrs, bytes)) {
+      beats.push_back(beat);
+    }
+  }
+  std::vector<WriteCombineEntry> written;
+  std::vector<WriteCombineEntry> kept;
+  for (const WriteCombineEntry &entry : write_buffer) {
+    bool read = !phys_addrs || std::find(beats.begin(), beats.end(), entry.beat) != beats.end();
+    (read ? written : kept).push_back(entry);
+  }
+  write_buffer = std::move(kept);
+  GPUStatisticsManager::instance().add_write_combining(WC_DRAINS, written.size());
+  write_out(written);
+}
+
+void CoalescingUnit::write_out(const std::vector<WriteCombineEntry> &entries) {
+  if (entries.empty()) {
+    return;
+  }
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+  std::vector<uint64_t> beats;
+  for (const WriteCombineEntry &entry : entries) {
+    beats.push_back(entry.beat);
+    stats.increment_gpu_dram_accs();
+    if (entry.byte_mask == ~0ULL) {
+      stats.add_write_combining(WC_FULL_BEATS, 1);
+    }
+  }
+  stats.add_write_combining(WC_DRAM_BEATS, beats.size());
+  schedule_dram_write(beats);
+}
+
+std::vector<uint64_t> CoalescingUnit::l1_line_beats(const std::vector<uint64_t> &lines) const {
+  std::vector<uint64_t> beat_addrs;
+  for (uint64_t line : lines) {
+    for (size_t b = 0; b < l1->line_beats(); b++) {
+      beat_addrs.push_back((line & ~(DRAM_BEAT_BYTES - 1)) + b * DRAM_BEAT_BYTES);
+    }
+  }
+  return beat_addrs;
+}
+
+void CoalescingUnit::block_until(const MemRequest &req, size_t resume_tick) {
+  size_t *latency = remaining_latency(req);
+  if (latency && resume_tick - tick_counter > *latency) {
+    *latency = resume_tick - tick_counter;
+  }
+}
+
+size_t *CoalescingUnit::remaining_latency(const MemRequest &req) {
+  if (req.load_id != 0) {
+    auto it = scoreboard.find(req.warp);
+    if (it != scoreboard.end()) {
+      for (OutstandingLoad &load : it->second) {
+        if (load.id == req.load_id) {
+          return &load.remaining;
         }
+      }
+    }
+    return nullptr;
+  }
+  auto it = blocked_warps.find(req.warp);
+  return it != blocked_warps.end() ? &it->second : nullptr;
+}
+
+std::vector<uint64_t> CoalescingUnit::l1_lines(const std::vector<uint64_t> &phys_addrs) const {
+  std::vector<uint64_t> lines;
+  for (uint64_t addr : phys_addrs) {
+    uint64_t addr_32 = 0xFFFFFFFF & addr;
+    if (SIM_SHARED_SRAM_BASE <= addr_32 && addr_32 < SIM_SIMT_STACK_BASE) {
+      continue;
+    }
+    uint64_t line = l1->line_addr(addr);
+    if (std::find(lines.begin(), lines.end(), line) == lines.end()) {
+      lines.push_back(line);
+    }
+  }
+  return lines;
+}
+
+CoalescingUnit::L1Traffic CoalescingUnit::access_l1(const MemRequest &req,
+                                                    const std::vector<uint64_t> &phys_addrs,
+                                                    const std::vector<uint64_t> &beat_addrs,
+                                                    int groups) {
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+  std::vector<uint64_t> lines = l1_lines(phys_addrs);
+  bool write_back = l1->get_config().write_policy == L1_WRITE_BACK;
+  L1Traffic traffic;
+  std::vector<uint64_t> written_back;
+  uint64_t victim = 0;
+
+  if (req.is_atomic) {
+    // Atomics are performed at DRAM, so a cached copy is written back and dropped
+    for (uint64_t line : lines) {
+      if (l1->invalidate(line)) {
+        written_back.push_back(line);
+      }
+    }
+    traffic.beats = static_cast<int>(beat_addrs.size());
+    traffic.groups = groups;
+    block_until(req, schedule_dram_read(beat_addrs, traffic.beats, groups));
+    dram_queue_depth += traffic.beats;
+  } else if (req.is_store) {
+    for (uint64_t line : lines) {
+      if (!write_back) {
+        size_t ready_tick = 0;
+        l1->lookup(line, tick_counter, &ready_tick);
+      } else if (!l1->mark_dirty(line) &&
+                 l1->allocate(line, tick_counter, tick_counter, true, &victim)) {
+        written_back.push_back(victim);
+      }
+    }
+    if (!write_back) {
+      traffic.beats = static_cast<int>(beat_addrs.size());
+      schedule_dram_write(beat_addrs);
+    }
+  } else {
+    size_t resume_tick = tick_counter;
+    std::vector<uint64_t> missed;
+    for (uint64_t line : lines) {
+      size_t ready_tick = 0;
+      L1Cache::Outcome outcome = l1->lookup(line, tick_counter, &ready_tick);
+      if (outcome == L1Cache::MISS) {
+        stats.increment_l1(L1_MISSES);
+        missed.push_back(line);
+        continue;
+      }
+      stats.increment_l1(outcome == L1Cache::HIT ? L1_HITS : L1_MSHR_MERGES);
+      resume_tick = std::max(resume_tick, ready_tick);
+    }
 
-        dram_inflight += groups;
+    if (!missed.empty()) {
+      // Adjacent lines are filled by one burst, like a coalesced access
+      std::sort(missed.begin(), missed.end());
+      traffic.groups = 1;
+      for (size_t i = 1; i < missed.size(); i++) {
+        if (missed[i] != missed[i - 1] + l1->get_config().line_bytes) {
+          traffic.groups++;
+        }
       }
+      traffic.beats = static_cast<int>(missed.size() * l1->line_beats());
+      size_t fill_tick = schedule_dram_read(l1_line_beats(missed), traffic.beats, traffic.groups);
+      dram_queue_depth += traffic.beats;
+      for (uint64_t line : missed) {
+        if (l1->allocate(line, tick_counter, fill_tick, false, &victim)) {
+          written_back.push_back(victim);
+        }
+      }
+      resume_tick = std::max(resume_tick, fill_tick);
+    }
 
-      dram_queue_depth += beats;
+    // Unlike the DRAM path this may shorten the latency guessed in load()
+    size_t *latency = remaining_latency(req);
+    if (latency) {
+      *latency = resume_tick - tick_counter;
+    }
+  }
+
+  std::vector<uint64_t> writeback_beats = l1_line_beats(written_back);
+  schedule_dram_write(writeback_beats);
+  stats.increment_l1(L1_WRITEBACKS, written_back.size());
+  traffic.beats += static_cast<int>(writeback_beats.size());
+  count_dram_accs(req.warp, traffic.beats);
+  return traffic;
+}
+
+bool CoalescingUnit::l1_mshrs_full(const MemRequest &req) {
+  if (!uses_l1(req.warp) || req.is_store || req.is_atomic || req.is_fence || req.addrs.empty()) {
+    return false;
+  }
+  // A request that misses more lines than there are MSHRs goes once all are free
+  size_t free = l1->free_mshrs(tick_counter);
+  if (free == l1->get_config().mshrs) {
+    return false;
+  }
+  std::vector<uint64_t> phys_addrs = build_translated_lane_addrs(
+      req.warp, req.addrs, req.active_threads);
+  size_t misses = 0;
+  for (uint64_t line : l1_lines(phys_addrs)) {
+    size_t ready_tick = 0;
+    if (l1->lookup(line, tick_counter, &ready_tick, false) == L1Cache::MISS) {
+      misses++;
+    }
+  }
+  return misses > free;
+}
+
+void CoalescingUnit::flush_lines(Warp *warp, const std::vector<uint64_t> &addrs,
+                                 const std::vector<size_t> &active_threads) {
+  if (!l1) {
+    return;
+  }
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+  std::vector<uint64_t> written_back;
+  for (uint64_t line : l1_lines(build_translated_lane_addrs(warp, addrs, active_threads))) {
+    bool present = false;
+    if (l1->invalidate(line, &present)) {
+      written_back.push_back(line);
+    }
+    if (present) {
+      stats.increment_l1(L1_FLUSHES);
+    }
+  }
+  stats.increment_l1(L1_WRITEBACKS, written_back.size());
+  std::vector<uint64_t> writeback_beats = l1_line_beats(written_back);
+  schedule_dram_write(writeback_beats);
+  count_dram_accs(warp, static_cast<int>(writeback_beats.size()));
+}
+
+void CoalescingUnit::count_dram_accs(Warp *warp, int count) {
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+  for (int i = 0; i < count; i++) {
+    if (warp->is_cpu) {
+      stats.increment_cpu_dram_accs();
+      if (stats.is_gpu_pipeline_active()) {
+        stats.increment_gpu_active_cpu_dram_accs();
+      }
+    } else {
+      stats.increment_gpu_dram_accs();
     }
   }
 }
@@ -1161,6 +1697,7 @@ std::pair<unsigned int, std::map<size_t, int>> CoalescingUnit::get_load_results(
 
 bool CoalescingUnit::has_pending_memory_ops(Warp *warp) {
   if (warp->suspended) return true;
+  if (scoreboard.count(warp)) return true;
   
   auto blocked_it = blocked_warps.find(warp);
   if (blocked_it != blocked_warps.end() && blocked_it->second > 0) return true;
@@ -1176,4 +1713,73 @@ bool CoalescingUnit::has_pending_memory_ops(Warp *warp) {
   }
   
   return false;
-}
\ No newline at end of file
+}
+
+size_t CoalescingUnit::outstanding_loads(Warp *warp) const {
+  auto it = scoreboard.find(warp);
+  return it == scoreboard.end() ? 0 : it->second.size();
+}
+
+bool CoalescingUnit::has_pending_register(Warp *warp, const std::vector<unsigned int> &regs) const {
+  auto it = scoreboard.find(warp);
+  if (it == scoreboard.end()) {
+    return false;
+  }
+  for (const OutstandingLoad &load : it->second) {
+    if (std::find(regs.begin(), regs.end(), load.rd_reg) != regs.end()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool CoalescingUnit::scoreboard_blocks(Warp *warp, const ScoreboardWait &wait) const {
+  return has_pending_register(warp, wait.regs) ||
+         (wait.is_load && outstanding_loads(warp) >= scoreboard_depth);
+}
+
+bool CoalescingUnit::wait_for_scoreboard(Warp *warp, const std::vector<unsigned int> &regs,
+                                         bool is_load) {
+  ScoreboardWait wait{regs, is_load};
+  if (!uses_scoreboard(warp) || !scoreboard_blocks(warp, wait)) {
+    return false;
+  }
+  GPUStatisticsManager::instance().increment_scoreboard(
+      has_pending_register(warp, regs) ? SB_HAZARD_STALLS : SB_FULL_STALLS);
+
+  warp->suspended = true;
+  blocked_warps[warp] = 0;
+  scoreboard_waits[warp] = wait;
+
+  if (instr_tracer) {
+    TraceEvent event;
+    event.cycle = GPUStatisticsManager::instance().get_gpu_cycles();
+    event.pc = warp->pc[0];
+    event.warp_id = warp->warp_id;
+    event.lane_id = -1;
+    event.event_type = WARP_SUSPEND;
+    instr_tracer->trace_event(event);
+  }
+  return true;
+}
+
+std::optional<CoalescingUnit::CompletedLoad>
+CoalescingUnit::pop_completed_load(bool is_cpu_pipeline) {
+  for (auto it = scoreboard.begin(); it != scoreboard.end(); ++it) {
+    if (it->first->is_cpu != is_cpu_pipeline) {
+      continue;
+    }
+    std::vector<OutstandingLoad> &loads = it->second;
+    for (auto load = loads.begin(); load != loads.end(); ++load) {
+      if (load->processed && load->remaining == 0) {
+        CompletedLoad done{it->first, load->rd_reg, std::move(load->results)};
+        loads.erase(load);
+        if (loads.empty()) {
+          scoreboard.erase(it);
+        }
+        return done;
+      }
+    }
+  }
+  return std::nullopt;
+}
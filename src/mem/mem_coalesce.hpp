@@ -2,6 +2,8 @@
 
 #include "gpu/pipeline.hpp"
 #include "mem_data.hpp"
+#include "dram_model.hpp"
+#include "l1_cache.hpp"
 #include "utils.hpp"
 #include "trace/trace.hpp"
 #include <queue>
@@ -10,6 +12,12 @@
 #include <optional>
 #include <unordered_set>
 
+// The read-modify-write of an AMO; rd gets the old value
+enum AtomicOp {
+  AMO_ADD, AMO_SWAP, AMO_AND, AMO_OR, AMO_XOR,
+  AMO_MIN, AMO_MAX, AMO_MINU, AMO_MAXU
+};
+
 struct MemRequest {
   Warp *warp;
   std::vector<uint64_t> addrs;
@@ -19,14 +27,18 @@ struct MemRequest {
   bool is_fence;
   bool is_zero_extend;
   std::vector<int> store_values;
-  std::vector<int> atomic_add_values;
+  AtomicOp atomic_op = AMO_ADD;
+  std::vector<int> atomic_operands;
   unsigned int rd_reg;
   std::vector<size_t> active_threads;
+  uint64_t pc = 0;  // Issuing instruction, for the per-PC profile
+  uint64_t load_id = 0;  // Non-zero for a load tracked by the scoreboard
 };
 
 class CoalescingUnit {
 public:
-  CoalescingUnit(DataMemory *scratchpad_mem, const std::string *trace_file = nullptr);
+  CoalescingUnit(DataMemory *scratchpad_mem, const std::string *trace_file = nullptr,
+                 TraceFormat trace_format = TRACE_CSV);
   ~CoalescingUnit();
   
   bool can_put();
@@ -35,12 +47,17 @@ public:
             bool is_zero_extend = false);
   void store(Warp *warp, const std::vector<uint64_t> &addrs, size_t bytes,
              const std::vector<int> &vals, const std::vector<size_t> &active_threads);
-  void atomic_add(Warp *warp, const std::vector<uint64_t> &addrs, size_t bytes,
-                  unsigned int rd_reg, const std::vector<int> &add_values,
-                  const std::vector<size_t> &active_threads);
+  void atomic(Warp *warp, const std::vector<uint64_t> &addrs, size_t bytes,
+              unsigned int rd_reg, AtomicOp op, const std::vector<int> &operands,
+              const std::vector<size_t> &active_threads);
   void fence(Warp *warp);
+  // Writes back (if dirty) and invalidates the L1 lines holding addrs
+  void flush_lines(Warp *warp, const std::vector<uint64_t> &addrs,
+                   const std::vector<size_t> &active_threads);
   
   bool is_busy();
+  // True while the write-combining buffer holds stores not yet written to DRAM
+  bool has_buffered_writes() const { return !write_buffer.empty(); }
   bool is_busy_for_pipeline(bool is_cpu_pipeline);
   void reset_dram_state();
   size_t pending_size() const { return pending_request_queue.size(); }
@@ -62,6 +79,8 @@ public:
   std::pair<unsigned int, std::map<size_t, int>> get_load_results(Warp *warp);
   bool has_pending_memory_ops(Warp *warp);
 
+  bool is_waiting_for_func_unit(Warp *warp) const { return func_unit_warps.count(warp) > 0; }
+
   bool can_use_divider() const { return divider_warp == nullptr; }
   void acquire_divider(Warp *warp) { divider_warp = warp; }
 
@@ -69,13 +88,45 @@ public:
   bool can_use_multiplier() const { return mul_pipeline_warps.size() < MUL_PIPELINE_CAPACITY; }
   void acquire_multiplier(Warp *warp) { mul_pipeline_warps.insert(warp); }
 
+  // Zfinx ops: pipelined like the multiplier, FDIV/FSQRT on their own unit like the divider
+  static constexpr size_t FPU_PIPELINE_CAPACITY = 4;
+  bool can_use_fpu() const { return fpu_pipeline_warps.size() < FPU_PIPELINE_CAPACITY; }
+  void acquire_fpu(Warp *warp) { fpu_pipeline_warps.insert(warp); }
+  bool can_use_fp_divider() const { return fp_divider_warp == nullptr; }
+  void acquire_fp_divider(Warp *warp) { fp_divider_warp = warp; }
+
   void set_instr_tracer(Tracer *t) { instr_tracer = t; }
-  void set_dram_trace(std::ofstream *f) { dram_trace = f; }
+  void set_dram_trace(Tracer *t) { dram_trace = t; }
+
+  // Null unless Config::l1Cache() enables the L1 data cache
+  L1Cache *get_l1_cache() { return l1.get(); }
+
+  /*
+   * With --load-scoreboard a GPU load does not suspend its warp. It marks
+   * rd pending until its data is written back, and the warp only
+   * suspends on an instruction that reads or writes a pending register,
+   * or on a load while the scoreboard is full.
+   */
+  bool uses_scoreboard(const Warp *warp) const { return scoreboard_depth > 0 && !warp->is_cpu; }
+  size_t outstanding_loads(Warp *warp) const;
+  // Suspends the warp and returns true if regs or, for a load, the scoreboard depth stop it
+  bool wait_for_scoreboard(Warp *warp, const std::vector<unsigned int> &regs, bool is_load);
+
+  struct CompletedLoad {
+    Warp *warp;
+    unsigned int rd_reg;
+    std::map<size_t, int> results;
+  };
+  // A scoreboarded load of the pipeline whose data is back, removed from the scoreboard
+  std::optional<CompletedLoad> pop_completed_load(bool is_cpu_pipeline);
 
 private:
-  std::map<Warp *, size_t> blocked_warps;
+  std::map<Warp *, size_t, WarpIdLess> blocked_warps;
   Warp *divider_warp = nullptr;
   std::unordered_set<Warp *> mul_pipeline_warps;
+  Warp *fp_divider_warp = nullptr;
+  std::unordered_set<Warp *> fpu_pipeline_warps;
+  std::unordered_set<Warp *> func_unit_warps;
   DataMemory *scratchpad_mem;
   std::queue<MemRequest> pending_request_queue;
   
@@ -85,10 +136,10 @@ private:
   static constexpr size_t COALESCING_PIPELINE_DEPTH = 5;
   std::optional<PipelineRequest> pipeline_stages[COALESCING_PIPELINE_DEPTH] = {};
   
-  std::map<Warp *, std::pair<unsigned int, std::map<size_t, int>>> load_results_map;
+  std::map<Warp *, std::pair<unsigned int, std::map<size_t, int>>, WarpIdLess> load_results_map;
   std::unique_ptr<Tracer> tracer;
   Tracer *instr_tracer = nullptr;
-  std::ofstream *dram_trace = nullptr;
+  Tracer *dram_trace = nullptr;
 
   size_t coalescing_remaining = 0;
 
@@ -98,12 +149,83 @@ private:
 
   int inflight_count_reg = 0;
 
-  static constexpr size_t SRAM_QUEUE_CAPACITY = 2;
-  static constexpr size_t SRAM_BANKS = 16;
-  static constexpr size_t BANKED_SRAM_LATENCY = 10;
+  SramConfig sram;
   std::queue<int> sram_queue;
   int sram_processing_remaining = 0;
 
+  // GPU accesses outside the shared SRAM go through the L1 when enabled
+  std::unique_ptr<L1Cache> l1;
+  bool uses_l1(const Warp *warp) const { return l1 && !warp->is_cpu; }
+
+  struct L1Traffic {
+    int beats = 0;   // DRAM beats read and written
+    int groups = 0;  // DRAM read requests
+  };
+  // Distinct L1 lines touched by the DRAM lanes of a request
+  std::vector<uint64_t> l1_lines(const std::vector<uint64_t> &phys_addrs) const;
+  // Looks the request up in the L1 and schedules the DRAM traffic it causes
+  L1Traffic access_l1(const MemRequest &req, const std::vector<uint64_t> &phys_addrs,
+                      const std::vector<uint64_t> &beat_addrs, int groups);
+  // DRAM beats of whole L1 lines
+  std::vector<uint64_t> l1_line_beats(const std::vector<uint64_t> &lines) const;
+  // True if a load at the exit stage has to wait for an MSHR
+  bool l1_mshrs_full(const MemRequest &req);
+  void count_dram_accs(Warp *warp, int count);
+
+  // Null unless Config::dramConfig() selects the banked DRAM model
+  std::unique_ptr<BankedDram> dram;
+
+  struct OutstandingLoad {
+    uint64_t id;
+    unsigned int rd_reg;
+    size_t remaining;        // Cycles left, like blocked_warps
+    bool processed = false;  // Left the exit stage, so results is set
+    std::map<size_t, int> results;
+  };
+  struct ScoreboardWait {
+    std::vector<unsigned int> regs;
+    bool is_load;
+  };
+  size_t scoreboard_depth;
+  uint64_t next_load_id = 1;
+  std::map<Warp *, std::vector<OutstandingLoad>, WarpIdLess> scoreboard;
+  std::map<Warp *, ScoreboardWait, WarpIdLess> scoreboard_waits;
+  // True if one of regs is the destination of an outstanding load
+  bool has_pending_register(Warp *warp, const std::vector<unsigned int> &regs) const;
+  bool scoreboard_blocks(Warp *warp, const ScoreboardWait &wait) const;
+  // Cycles left before the warp (or the scoreboarded load) of req can go on
+  size_t *remaining_latency(const MemRequest &req);
+
+  /*
+   * With --write-combining, GPU stores that bypass the L1 are merged per
+   * DRAM beat before they go to DRAM. An entry is written out once every
+   * byte of its beat has been written, to make room for a new beat (oldest
+   * first), before a load or atomic reads its beat, at a fence, and when
+   * it has not been written for WRITE_COMBINE_TIMEOUT cycles and the DRAM
+   * port is free.
+   */
+  static constexpr size_t WRITE_COMBINE_TIMEOUT = 32;
+  struct WriteCombineEntry {
+    uint64_t beat;
+    uint64_t byte_mask;  // Bit i set once byte i of the beat is written
+    size_t last_write;   // Tick of the last store merged into it
+  };
+  size_t write_buffer_capacity;
+  std::vector<WriteCombineEntry> write_buffer;  // Oldest first
+  int write_buffer_exit_beats = 0;  // Beats written out by the store leaving the pipeline
+  bool uses_write_buffer(const Warp *warp) const {
+    return write_buffer_capacity > 0 && !warp->is_cpu && !uses_l1(warp);
+  }
+  // Merges the DRAM lanes of a store into the buffer; returns the beats written to DRAM
+  int buffer_store(const std::vector<uint64_t> &phys_addrs, size_t bytes);
+  // Writes out the entries for the beats the lanes touch, or every entry if phys_addrs is null
+  void drain_write_buffer(const std::vector<uint64_t> *phys_addrs, size_t bytes);
+  void write_out(const std::vector<WriteCombineEntry> &entries);
+
+  bool combine_atomics;
+  // Performs the read-modify-writes of an atomic and returns each lane's old value
+  std::map<size_t, int> perform_atomic(const MemRequest &req);
+
 public:
   size_t dram_queue_depth = 0;
 
@@ -116,11 +238,19 @@ public:
 
   bool is_sram_access(const MemRequest &req) const;
 
+  static constexpr size_t MAX_SRAM_BANKS = 64;
+  // Empty if the shared SRAM configuration can be built, otherwise what is wrong with it
+  static std::string sram_config_error(const SramConfig &config);
+  size_t sram_bank(uint64_t addr) const;
+  // Most lanes of the access that need the same bank; 1 for a broadcast
+  int sram_conflict_degree(const MemRequest &req) const;
+  // Cycles the banks take for the access, at least 2
   int calculate_sram_bank_conflicts(const MemRequest &req) const;
   void suspend_warp(Warp *warp, const std::vector<uint64_t> &addrs,
                     size_t access_size, bool is_store);
+  // Number of DRAM beats; beat_addrs, if given, gets the address of each
   int calculate_bursts(const std::vector<uint64_t> &addrs, size_t access_size,
-                       bool is_store);
+                       bool is_store, std::vector<uint64_t> *beat_addrs = nullptr);
   int calculate_request_count(const std::vector<uint64_t> &addrs, size_t access_size);
   std::vector<uint64_t> compute_coalesced_addresses(const std::vector<uint64_t> &addrs,
                                                       size_t access_size);
@@ -133,5 +263,15 @@ public:
       Warp *warp, const std::vector<uint64_t> &addrs,
       const std::vector<size_t> &active_threads);
 
+  /*
+   * Queues a DRAM read behind the responses already scheduled and returns
+   * the tick the requesting warp can resume at. beat_addrs is only used by
+   * the banked model; a fence passes none and waits for DRAM to drain.
+   */
+  size_t schedule_dram_read(const std::vector<uint64_t> &beat_addrs, int beats, int groups);
+  void schedule_dram_write(const std::vector<uint64_t> &beat_addrs);
+  // Keeps the warp (or the scoreboarded load) of req blocked until at least resume_tick
+  void block_until(const MemRequest &req, size_t resume_tick);
+
   void process_mem_request(const MemRequest &req);
 };
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "simulator.hpp"
+#include "disassembler/llvm_disasm.hpp"
+#include "gpu/pipeline_ats.hpp"
+#include "gpu/pipeline_execute.hpp"
+#include "gpu/pipeline_instr_fetch.hpp"
+#include "gpu/pipeline_op_fetch.hpp"
+#include "gpu/pipeline_op_latch.hpp"
+#include "gpu/pipeline_warp_scheduler.hpp"
+#include "gpu/pipeline_writeback.hpp"
+#include "host/host_gpu_control.hpp"
+#include "mem/mem_coalesce.hpp"
+#include "mem/mem_data.hpp"
+#include "mem/mem_instr.hpp"
+#include "stats/launch_report.hpp"
+#include "stats/profiler.hpp"
+#include "stats/self_profiler.hpp"
+#include "stats/stats_sampler.hpp"
+#include "trace/trace_compare.hpp"
+
+Pipeline *initialize_pipeline(InstructionMemory *im, CoalescingUnit *cu,
+                              RegisterFile *rf, LLVMDisassembler *disasm,
+                              HostGPUControl *gpu_controller, bool is_cpu,
+                              Tracer *instr_tracer) {
+  Pipeline *p = new Pipeline();
+
+  if (is_cpu) {
+    p->add_stage<WarpScheduler>(1, 1, im->get_base_addr(), cu);
+  } else {
+    p->add_stage<WarpScheduler>(NUM_LANES, NUM_WARPS, im->get_base_addr(), cu, false);
+  }
+  p->add_stage<ActiveThreadSelection>();
+  p->add_stage<InstructionFetch>(im, disasm);
+  p->add_stage<OperandFetch>();
+  p->add_stage<OperandLatch>();
+  p->add_stage<ExecuteSuspend>(cu, rf, im->get_max_addr(), disasm,
+                               gpu_controller);
+  p->add_stage<WritebackResume>(cu, rf, is_cpu);
+
+  std::shared_ptr<WarpScheduler> warp_scheduler_stage =
+      std::dynamic_pointer_cast<WarpScheduler>(p->get_stage(0));
+  std::shared_ptr<ExecuteSuspend> execute_stage =
+      std::dynamic_pointer_cast<ExecuteSuspend>(p->get_stage(5));
+  std::shared_ptr<WritebackResume> writeback_stage =
+      std::dynamic_pointer_cast<WritebackResume>(p->get_stage(6));
+
+  if (!is_cpu && Config::instance().reconvergence() == RECONVERGE_IPDOM) {
+    auto table = std::make_shared<const ReconvergenceTable>(im, disasm);
+    std::dynamic_pointer_cast<ActiveThreadSelection>(p->get_stage(1))->set_reconvergence(table);
+    execute_stage->set_reconvergence(table);
+  }
+
+  if (instr_tracer) {
+    execute_stage->set_instr_tracer(instr_tracer);
+    writeback_stage->set_instr_tracer(instr_tracer);
+  }
+  
+  auto insert_warp_callback = [ws = warp_scheduler_stage](Warp *warp) {
+    ws->insert_warp(warp);
+  };
+  execute_stage->insert_warp = insert_warp_callback;
+
+  execute_stage->insert_warp_retry = [ws = warp_scheduler_stage](Warp *warp) {
+    ws->insert_warp_retry(warp);
+  };
+
+  if (!is_cpu) {
+    execute_stage->notify_warp_terminated = [pipeline = p, gpu_controller](Warp *warp) {
+      if (gpu_controller && gpu_controller->is_dispatching_blocks()) {
+        gpu_controller->warp_terminated(warp);
+      } else {
+        pipeline->notify_warp_terminated();
+      }
+    };
+  }
+
+  writeback_stage->insert_warp = insert_warp_callback;
+
+  writeback_stage->insert_warp_with_susp_delay = [ws = warp_scheduler_stage](Warp *warp) {
+    ws->insert_warp_retry(warp);
+  };
+
+  // Initialize latches (7 stages = 7 latches)
+  PipelineLatch *latches[7];
+  for (int i = 0; i < 7; i++) {
+    latches[i] = new PipelineLatch();
+  }
+
+  // Connect latches in a circular pattern (stage N output -> stage N+1 input)
+  p->get_stage(0)->set_latches(latches[6], latches[0]);
+  p->get_stage(1)->set_latches(latches[0], latches[1]);
+  p->get_stage(2)->set_latches(latches[1], latches[2]);
+  p->get_stage(3)->set_latches(latches[2], latches[3]);
+  p->get_stage(4)->set_latches(latches[3], latches[4]);
+  p->get_stage(5)->set_latches(latches[4], latches[5]);
+  p->get_stage(6)->set_latches(latches[5], latches[6]);
+
+  return p;
+}
+
+void connect_gpu_controller(HostGPUControl *gpu_controller, Pipeline *gpu_pipeline,
+                            CoalescingUnit *cu) {
+  gpu_controller->set_scheduler(
+      std::dynamic_pointer_cast<WarpScheduler>(gpu_pipeline->get_stage(0)));
+  gpu_controller->set_pipeline(gpu_pipeline);
+  gpu_controller->set_coalescing_unit(cu);
+}
+
+void load_data_sections(const parse_output &out, DataMemory *mem) {
+  for (const auto& section : out.data_sections) {
+    uint64_t addr = section.first;
+    const std::vector<uint8_t>& data = section.second;
+    for (size_t i = 0; i < data.size(); i++) {
+      // Store each byte individually (store function handles little-endian, but for 1 byte it's fine)
+      mem->store(addr + i, 1, static_cast<uint64_t>(data[i]));
+    }
+    debug_log("Loaded data section at 0x" + 
+              std::to_string(addr) + " (" + 
+              std::to_string(data.size()) + " bytes)");
+  }
+}
+
+uint64_t run_simulation(Pipeline *cpu_pipeline, Pipeline *gpu_pipeline, CoalescingUnit &cu,
+                        HostGPUControl *gpu_controller, const SimulationHooks &hooks) {
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+  SelfProfiler *self_profiler = hooks.self_profiler;
+  uint64_t cycles = 0;
+
+  // Execute the threads
+  bool gpu_was_active = false;
+  while (cpu_pipeline->has_active_stages() ||
+         gpu_pipeline->has_active_stages() ||
+         gpu_pipeline->is_pipeline_active() ||
+         (gpu_controller && gpu_controller->has_queued_launches())) {
+    
+    // Before the deactivation, so a finished launch is closed before the next starts
+    if (gpu_controller) {
+      gpu_controller->tick();
+    }
+    gpu_pipeline->apply_deferred_deactivation();
+
+    stats.set_gpu_pipeline_active(gpu_pipeline->is_pipeline_active());
+
+    if (self_profiler) {
+      self_profiler->lap(SelfProfiler::SECTION_OTHER);
+    }
+    cpu_pipeline->execute();
+    gpu_pipeline->execute();
+    cu.tick();
+    if (self_profiler) {
+      self_profiler->lap(SelfProfiler::SECTION_COALESCING_UNIT);
+    }
+
+    stats.tick_instr_pipeline();
+
+    if (gpu_pipeline->is_pipeline_active()) {
+      stats.increment_gpu_cycles();
+      stats.tick_stall_breakdown();
+      if (hooks.profiler) {
+        hooks.profiler->tick();
+      }
+      if (hooks.sampler) {
+        hooks.sampler->tick(cu.dram_inflight, cu.pending_size());
+      }
+    } else if (gpu_was_active) {
+      if (hooks.launch_report) {
+        hooks.launch_report->end_launch();
+      }
+      if (hooks.sampler) {
+        hooks.sampler->end_launch(cu.dram_inflight, cu.pending_size());
+      }
+    }
+    gpu_was_active = gpu_pipeline->is_pipeline_active();
+    if (self_profiler) {
+      self_profiler->lap(SelfProfiler::SECTION_STATS);
+      self_profiler->count_cycle(gpu_was_active);
+    }
+    cycles++;
+
+    if (hooks.stop_on_divergence && hooks.stop_on_divergence->diverged()) {
+      break;
+    }
+  }
+
+  if (hooks.sampler) {
+    hooks.sampler->end_launch(cu.dram_inflight, cu.pending_size());
+  }
+  return cycles;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "gpu/pipeline.hpp"
+#include "parser.hpp"
+
+class CoalescingUnit;
+class DataMemory;
+class HostGPUControl;
+class InstructionMemory;
+class LLVMDisassembler;
+class LaunchReport;
+class PCProfiler;
+class RegisterFile;
+class SelfProfiler;
+class StatsSampler;
+class TraceComparator;
+class Tracer;
+
+/*
+ * Initialize pipeline (CPU is modelled as 1x1 GPU for simplicity)
+ */
+Pipeline *initialize_pipeline(InstructionMemory *im, CoalescingUnit *cu,
+                              RegisterFile *rf, LLVMDisassembler *disasm,
+                              HostGPUControl *gpu_controller, bool is_cpu,
+                              Tracer *instr_tracer = nullptr);
+
+/*
+ * Hands the GPU pipeline and coalescing unit to the host control unit,
+ * which launches kernels on them
+ */
+void connect_gpu_controller(HostGPUControl *gpu_controller, Pipeline *gpu_pipeline,
+                            CoalescingUnit *cu);
+
+/*
+ * Stores the ELF data sections (rodata, data, etc.) into data memory
+ */
+void load_data_sections(const parse_output &out, DataMemory *mem);
+
+/*
+ * Optional observers of run_simulation; null members are skipped
+ */
+struct SimulationHooks {
+  PCProfiler *profiler = nullptr;
+  StatsSampler *sampler = nullptr;
+  SelfProfiler *self_profiler = nullptr;
+  LaunchReport *launch_report = nullptr;
+  // Stops the simulation at the first divergence from the reference trace
+  TraceComparator *stop_on_divergence = nullptr;
+};
+
+/*
+ * Ticks both pipelines and the coalescing unit until the program has
+ * finished and no kernel launch is left in gpu_controller's queue,
+ * keeping the GPU statistics. Returns the number of cycles.
+ */
+uint64_t run_simulation(Pipeline *cpu_pipeline, Pipeline *gpu_pipeline, CoalescingUnit &cu,
+                        HostGPUControl *gpu_controller, const SimulationHooks &hooks = {});
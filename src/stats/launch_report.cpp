@@ -0,0 +1,239 @@
+#include "launch_report.hpp"
+#include <cinttypes>
+#include <cstdio>
+
+static std::string json_string(const std::string &s) {
+  std::string out = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\u%04x", c);
+      out += buf;
+    } else {
+      out += c;
+    }
+  }
+  return out + "\"";
+}
+
+static std::string json_double(double value) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.3f", value);
+  return buf;
+}
+
+void LaunchReport::begin_launch(uint64_t kernel_pc) {
+  if (launch_open) {
+    capture();
+  }
+  LaunchRecord record;
+  record.index = launches.size();
+  record.kernel_pc = kernel_pc;
+  launches.push_back(record);
+  launch_open = true;
+  launch_ended = false;
+  launch_start = Clock::now();
+}
+
+void LaunchReport::end_launch() {
+  if (launch_open && !launch_ended) {
+    launch_ended = true;
+    launch_end = Clock::now();
+  }
+}
+
+void LaunchReport::capture() {
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+  LaunchRecord &record = launches.back();
+  record.cycles = stats.get_gpu_cycles();
+  record.instrs = stats.get_gpu_instrs();
+  record.susps = stats.get_gpu_susps();
+  record.retries = stats.get_gpu_retries();
+  record.dram_accs = stats.get_gpu_dram_accs();
+  record.cpu_dram_accs = stats.get_gpu_active_cpu_dram_accs();
+  record.active_lanes = stats.get_active_lanes_histogram();
+  for (size_t r = 0; r < NUM_STALL_REASONS; r++) {
+    record.stalls[r] = stats.get_gpu_stalls(static_cast<StallReason>(r));
+  }
+  for (size_t c = 0; c < NUM_L1_COUNTERS; c++) {
+    record.l1[c] = stats.get_l1(static_cast<L1Counter>(c));
+  }
+  for (size_t c = 0; c < NUM_DRAM_COUNTERS; c++) {
+    record.dram[c] = stats.get_dram(static_cast<DramCounter>(c));
+  }
+  record.dram_bank_busy = stats.get_dram_bank_busy();
+  record.sram_conflict_degrees = stats.get_sram_conflict_degrees();
+  for (size_t c = 0; c < NUM_SCOREBOARD_COUNTERS; c++) {
+    record.scoreboard[c] = stats.get_scoreboard(static_cast<ScoreboardCounter>(c));
+  }
+  for (size_t c = 0; c < NUM_SCALAR_COUNTERS; c++) {
+    record.scalar[c] = stats.get_scalar(static_cast<ScalarCounter>(c));
+  }
+  for (size_t c = 0; c < NUM_REGFILE_COUNTERS; c++) {
+    record.regfile[c] = stats.get_regfile(static_cast<RegfileCounter>(c));
+  }
+  for (size_t c = 0; c < NUM_ATOMIC_COUNTERS; c++) {
+    record.atomics[c] = stats.get_atomics(static_cast<AtomicCounter>(c));
+  }
+  for (size_t c = 0; c < NUM_WC_COUNTERS; c++) {
+    record.write_combining[c] = stats.get_write_combining(static_cast<WriteCombineCounter>(c));
+  }
+  for (size_t c = 0; c < NUM_BLOCK_COUNTERS; c++) {
+    record.blocks[c] = stats.get_blocks(static_cast<BlockCounter>(c));
+  }
+  Clock::time_point end = launch_ended ? launch_end : Clock::now();
+  record.wall_time_ms = std::chrono::duration<double, std::milli>(end - launch_start).count();
+  launch_open = false;
+}
+
+const std::vector<LaunchRecord> &LaunchReport::get_launches() {
+  if (launch_open) {
+    capture();
+  }
+  return launches;
+}
+
+void LaunchReport::set_config(const std::string &key, uint64_t value) {
+  config.emplace_back(key, std::to_string(value));
+}
+
+void LaunchReport::set_config(const std::string &key, const std::string &value) {
+  config.emplace_back(key, json_string(value));
+}
+
+std::string LaunchReport::config_fingerprint() const {
+  // FNV-1a over "key=value;" of every entry
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (const auto &[key, value] : config) {
+    for (const std::string &part : {key, std::string("="), value, std::string(";")}) {
+      for (unsigned char c : part) {
+        hash ^= c;
+        hash *= 0x100000001b3ULL;
+      }
+    }
+  }
+  char buf[20];
+  snprintf(buf, sizeof(buf), "%016" PRIx64, hash);
+  return buf;
+}
+
+void LaunchReport::write_json(std::ostream &out, const std::string &program) {
+  const std::vector<LaunchRecord> &records = get_launches();
+  std::string fingerprint = config_fingerprint();
+  double total_ms = std::chrono::duration<double, std::milli>(Clock::now() - run_start).count();
+
+  out << "{\n";
+  out << "  \"program\": " << json_string(program) << ",\n";
+  out << "  \"config_fingerprint\": \"" << fingerprint << "\",\n";
+  out << "  \"config\": {";
+  for (size_t i = 0; i < config.size(); i++) {
+    out << (i ? ", " : "") << json_string(config[i].first) << ": " << config[i].second;
+  }
+  out << "},\n";
+  out << "  \"wall_time_ms\": " << json_double(total_ms) << ",\n";
+  out << "  \"launches\": [";
+  for (size_t i = 0; i < records.size(); i++) {
+    const LaunchRecord &r = records[i];
+    char pc[24];
+    snprintf(pc, sizeof(pc), "0x%08" PRIx64, r.kernel_pc);
+    double ipc = r.cycles ? static_cast<double>(r.instrs) / r.cycles : 0.0;
+    double mips = r.wall_time_ms > 0 ? r.instrs / (r.wall_time_ms * 1000.0) : 0.0;
+
+    out << (i ? ",\n" : "\n") << "    {\n";
+    out << "      \"index\": " << r.index << ",\n";
+    out << "      \"kernel_pc\": \"" << pc << "\",\n";
+    out << "      \"config_fingerprint\": \"" << fingerprint << "\",\n";
+    out << "      \"cycles\": " << r.cycles << ",\n";
+    out << "      \"instrs\": " << r.instrs << ",\n";
+    out << "      \"susps\": " << r.susps << ",\n";
+    out << "      \"retries\": " << r.retries << ",\n";
+    out << "      \"dram_accs\": " << r.dram_accs << ",\n";
+    out << "      \"cpu_dram_accs\": " << r.cpu_dram_accs << ",\n";
+    out << "      \"ipc\": " << json_double(ipc) << ",\n";
+    out << "      \"wall_time_ms\": " << json_double(r.wall_time_ms) << ",\n";
+    out << "      \"host_mips\": " << json_double(mips) << ",\n";
+    out << "      \"active_lanes\": [";
+    for (size_t n = 0; n <= NUM_LANES; n++) {
+      out << (n ? ", " : "") << r.active_lanes[n];
+    }
+    out << "],\n";
+    out << "      \"stalls\": {";
+    for (size_t s = 0; s < NUM_STALL_REASONS; s++) {
+      out << (s ? ", " : "") << "\"" << stall_reason_name(static_cast<StallReason>(s))
+          << "\": " << r.stalls[s];
+    }
+    out << "},\n";
+    out << "      \"l1\": {";
+    for (size_t c = 0; c < NUM_L1_COUNTERS; c++) {
+      out << (c ? ", " : "") << "\"" << l1_counter_name(static_cast<L1Counter>(c))
+          << "\": " << r.l1[c];
+    }
+    out << "},\n";
+    out << "      \"dram\": {";
+    for (size_t c = 0; c < NUM_DRAM_COUNTERS; c++) {
+      out << (c ? ", " : "") << "\"" << dram_counter_name(static_cast<DramCounter>(c))
+          << "\": " << r.dram[c];
+    }
+    out << "},\n";
+    out << "      \"dram_bank_busy\": [";
+    for (size_t b = 0; b < r.dram_bank_busy.size(); b++) {
+      out << (b ? ", " : "") << r.dram_bank_busy[b];
+    }
+    out << "],\n";
+    out << "      \"sram_conflict_degrees\": [";
+    for (size_t d = 0; d <= NUM_LANES; d++) {
+      out << (d ? ", " : "") << r.sram_conflict_degrees[d];
+    }
+    out << "],\n";
+    out << "      \"scoreboard\": {";
+    for (size_t c = 0; c < NUM_SCOREBOARD_COUNTERS; c++) {
+      out << (c ? ", " : "") << "\"" << scoreboard_counter_name(static_cast<ScoreboardCounter>(c))
+          << "\": " << r.scoreboard[c];
+    }
+    out << "},\n";
+    out << "      \"scalar\": {";
+    for (size_t c = 0; c < NUM_SCALAR_COUNTERS; c++) {
+      out << (c ? ", " : "") << "\"" << scalar_counter_name(static_cast<ScalarCounter>(c))
+          << "\": " << r.scalar[c];
+    }
+    out << "},\n";
+    out << "      \"regfile\": {";
+    for (size_t c = 0; c < NUM_REGFILE_COUNTERS; c++) {
+      out << (c ? ", " : "") << "\"" << regfile_counter_name(static_cast<RegfileCounter>(c))
+          << "\": " << r.regfile[c];
+    }
+    out << "},\n";
+    out << "      \"atomics\": {";
+    for (size_t c = 0; c < NUM_ATOMIC_COUNTERS; c++) {
+      out << (c ? ", " : "") << "\"" << atomic_counter_name(static_cast<AtomicCounter>(c))
+          << "\": " << r.atomics[c];
+    }
+    out << "},\n";
+    out << "      \"write_combining\": {";
+    for (size_t c = 0; c < NUM_WC_COUNTERS; c++) {
+      out << (c ? ", " : "") << "\""
+          << write_combine_counter_name(static_cast<WriteCombineCounter>(c))
+          << "\": " << r.write_combining[c];
+    }
+    out << "},\n";
+    out << "      \"block_dispatch\": {";
+    for (size_t c = 0; c < NUM_BLOCK_COUNTERS; c++) {
+      out << (c ? ", " : "") << "\"" << block_counter_name(static_cast<BlockCounter>(c))
+          << "\": " << r.blocks[c];
+    }
+    out << "}\n    }";
+  }
+  out << (records.empty() ? "]\n" : "\n  ]\n");
+  out << "}\n";
+}
+
+void LaunchReport::reset() {
+  launches.clear();
+  launch_open = false;
+  launch_ended = false;
+  config.clear();
+  run_start = Clock::now();
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "stats.hpp"
+#include <stdint.h>
+#include <array>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * Counters of one kernel launch, captured before the next launch resets
+ * them (or at exit for the last one)
+ */
+struct LaunchRecord {
+  uint64_t index = 0;
+  uint64_t kernel_pc = 0;
+  uint64_t cycles = 0;
+  uint64_t instrs = 0;
+  uint64_t susps = 0;
+  uint64_t retries = 0;
+  uint64_t dram_accs = 0;
+  uint64_t cpu_dram_accs = 0;
+  std::array<uint64_t, NUM_STALL_REASONS> stalls = {};
+  std::array<uint64_t, NUM_LANES + 1> active_lanes = {};
+  std::array<uint64_t, NUM_L1_COUNTERS> l1 = {};
+  std::array<uint64_t, NUM_DRAM_COUNTERS> dram = {};
+  std::vector<uint64_t> dram_bank_busy;
+  std::array<uint64_t, NUM_LANES + 1> sram_conflict_degrees = {};
+  std::array<uint64_t, NUM_SCOREBOARD_COUNTERS> scoreboard = {};
+  std::array<uint64_t, NUM_SCALAR_COUNTERS> scalar = {};
+  std::array<uint64_t, NUM_REGFILE_COUNTERS> regfile = {};
+  std::array<uint64_t, NUM_ATOMIC_COUNTERS> atomics = {};
+  std::array<uint64_t, NUM_WC_COUNTERS> write_combining = {};
+  std::array<uint64_t, NUM_BLOCK_COUNTERS> blocks = {};
+  // Host time from the launch until the GPU pipeline went idle
+  double wall_time_ms = 0.0;
+};
+
+/*
+ * Per-launch stats report (--stats-json).
+ *
+ * HostGPUControl::launch_kernel resets the GPU counters, so every launch
+ * is recorded here first. The report is written as JSON together with the
+ * simulator configuration and a fingerprint of it, so results from
+ * different builds or options are never compared by accident.
+ */
+class LaunchReport {
+public:
+  static LaunchReport &instance() {
+    static LaunchReport inst;
+    return inst;
+  }
+
+  /*
+   * Closes the previous launch, if any, and starts timing a new one.
+   * Called before the counters are reset.
+   */
+  void begin_launch(uint64_t kernel_pc);
+
+  /*
+   * Stops the wall clock of the current launch once the GPU goes idle.
+   * The counters are captured later, since retired instructions are
+   * still being counted for a few cycles.
+   */
+  void end_launch();
+
+  // Configuration entries, in order, that make up the fingerprint
+  void set_config(const std::string &key, uint64_t value);
+  void set_config(const std::string &key, const std::string &value);
+  std::string config_fingerprint() const;
+
+  const std::vector<LaunchRecord> &get_launches();
+
+  void write_json(std::ostream &out, const std::string &program);
+
+  void reset();
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  void capture();
+
+  std::vector<LaunchRecord> launches;
+  bool launch_open = false;
+  bool launch_ended = false;
+  Clock::time_point launch_start;
+  Clock::time_point launch_end;
+  Clock::time_point run_start = Clock::now();
+
+  // Key and JSON-encoded value
+  std::vector<std::pair<std::string, std::string>> config;
+
+  LaunchReport() = default;
+};
@@ -0,0 +1,102 @@
+#include "profiler.hpp"
+#include "../config.hpp"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+void PCProfiler::enable(uint64_t base, uint64_t max_addr) {
+  enabled = true;
+  base_addr = base;
+  size_t slots = max_addr >= base ? ((max_addr - base) >> 2) + 1 : 0;
+  for (auto *counter : {&cycles, &instrs, &retries, &bubbles, &dram_beats, &sram_conflicts}) {
+    counter->assign(slots, 0);
+  }
+  stall_pc.assign(NUM_WARPS, 0);
+  stall_since.assign(NUM_WARPS, 0);
+  stalled.assign(NUM_WARPS, false);
+}
+
+void PCProfiler::record_issue(uint64_t warp_id, uint64_t pc) {
+  issued_this_cycle = true;
+  issued_pc = pc;
+  if (warp_id < stalled.size()) stalled[warp_id] = false;
+}
+
+void PCProfiler::record_stall(uint64_t warp_id, uint64_t pc) {
+  if (warp_id >= stalled.size() || stalled[warp_id]) return;
+  stalled[warp_id] = true;
+  stall_pc[warp_id] = pc;
+  stall_since[warp_id] = tick_count;
+}
+
+void PCProfiler::record_instr(uint64_t pc) { add(instrs, pc, 1); }
+void PCProfiler::record_retry(uint64_t pc) { add(retries, pc, 1); }
+void PCProfiler::record_dram_beats(uint64_t pc, int beats) { add(dram_beats, pc, beats); }
+void PCProfiler::record_sram_conflict_cycles(uint64_t pc, int n) { add(sram_conflicts, pc, n); }
+
+void PCProfiler::record_suspension_bubble(uint64_t warp_id) {
+  if (warp_id >= stalled.size()) return;
+  add(bubbles, stall_pc[warp_id], 1);
+  // The bubble went through the issue slot, but the warp is still waiting
+  if (!stalled[warp_id]) {
+    stalled[warp_id] = true;
+    stall_since[warp_id] = tick_count;
+  }
+}
+
+void PCProfiler::tick() {
+  tick_count++;
+  if (issued_this_cycle) {
+    add(cycles, issued_pc, 1);
+    issued_this_cycle = false;
+    return;
+  }
+
+  // Empty issue slot: blame the warp that has been stalled the longest
+  size_t oldest = NO_PC;
+  for (size_t w = 0; w < stalled.size(); w++) {
+    if (stalled[w] && (oldest == NO_PC || stall_since[w] < stall_since[oldest])) {
+      oldest = w;
+    }
+  }
+  if (oldest == NO_PC || index(stall_pc[oldest]) == NO_PC) {
+    unattributed_cycles++;
+  } else {
+    add(cycles, stall_pc[oldest], 1);
+  }
+}
+
+void PCProfiler::report(std::ostream &out,
+                        const std::function<std::string(uint64_t)> &disassemble) const {
+  uint64_t total_cycles = unattributed_cycles;
+  std::vector<size_t> order;
+  for (size_t i = 0; i < cycles.size(); i++) {
+    total_cycles += cycles[i];
+    if (cycles[i] || instrs[i] || retries[i] || bubbles[i] || dram_beats[i] || sram_conflicts[i]) {
+      order.push_back(i);
+    }
+  }
+  std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+    return cycles[a] > cycles[b];
+  });
+
+  char buf[256];
+  out << "# GPU hotspot profile: " << total_cycles << " cycles, "
+      << unattributed_cycles << " not attributable to a PC" << std::endl;
+  snprintf(buf, sizeof(buf), "%-10s %12s %7s %12s %10s %10s %12s %12s  %s\n", "PC", "Cycles",
+           "Cycle%", "Instrs", "Retries", "SuspBubbl", "DRAMBeats", "SRAMConflCyc", "Disassembly");
+  out << buf;
+  for (size_t i : order) {
+    uint64_t pc = base_addr + (i << 2);
+    double pct = total_cycles ? 100.0 * cycles[i] / total_cycles : 0.0;
+    snprintf(buf, sizeof(buf),
+             "0x%08" PRIx64 " %12" PRIu64 " %6.2f%% %12" PRIu64 " %10" PRIu64 " %10" PRIu64
+             " %12" PRIu64 " %12" PRIu64 "  ",
+             pc, cycles[i], pct, instrs[i], retries[i], bubbles[i], dram_beats[i],
+             sram_conflicts[i]);
+    std::string text = disassemble(pc);
+    std::replace(text.begin(), text.end(), '\t', ' ');
+    text.erase(0, text.find_first_not_of(' '));
+    out << buf << text << std::endl;
+  }
+}
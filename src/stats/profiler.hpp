@@ -0,0 +1,100 @@
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*
+ * Per-PC hotspot profiler for GPU kernels (--profile).
+ *
+ * Every counter is a flat array indexed by (pc - base_addr) >> 2 over the
+ * instruction memory, so recording is a bounds check and an increment.
+ * Each active GPU cycle is charged to the PC of the warp that occupied
+ * the issue slot or, when nothing issued, to the PC at which the longest
+ * stalled warp (suspended or in a barrier) stopped.
+ */
+class PCProfiler {
+public:
+  static PCProfiler &instance() {
+    static PCProfiler inst;
+    return inst;
+  }
+
+  /*
+   * Allocates counters for PCs in [base_addr, max_addr]
+   */
+  void enable(uint64_t base_addr, uint64_t max_addr);
+  void disable() { enabled = false; }
+  bool is_enabled() const { return enabled; }
+
+  // Issue slot and stall tracking (warp_id < NUM_WARPS)
+  void record_issue(uint64_t warp_id, uint64_t pc);
+  void record_stall(uint64_t warp_id, uint64_t pc);
+
+  void record_instr(uint64_t pc);
+  void record_retry(uint64_t pc);
+  // Charged to the PC whose instruction suspended the warp
+  void record_suspension_bubble(uint64_t warp_id);
+  void record_dram_beats(uint64_t pc, int beats);
+  void record_sram_conflict_cycles(uint64_t pc, int cycles);
+
+  /*
+   * Charges the current GPU cycle; called once per active GPU cycle
+   */
+  void tick();
+
+  /*
+   * Writes the per-PC table sorted by cycles, annotating each PC with
+   * disassemble(pc)
+   */
+  void report(std::ostream &out,
+              const std::function<std::string(uint64_t)> &disassemble) const;
+
+  uint64_t get_cycles(uint64_t pc) const { return lookup(cycles, pc); }
+  uint64_t get_instrs(uint64_t pc) const { return lookup(instrs, pc); }
+  uint64_t get_retries(uint64_t pc) const { return lookup(retries, pc); }
+  uint64_t get_suspension_bubbles(uint64_t pc) const { return lookup(bubbles, pc); }
+  uint64_t get_dram_beats(uint64_t pc) const { return lookup(dram_beats, pc); }
+  uint64_t get_sram_conflict_cycles(uint64_t pc) const { return lookup(sram_conflicts, pc); }
+  uint64_t get_unattributed_cycles() const { return unattributed_cycles; }
+
+private:
+  static constexpr size_t NO_PC = SIZE_MAX;
+
+  size_t index(uint64_t pc) const {
+    if (pc < base_addr) return NO_PC;
+    size_t i = (pc - base_addr) >> 2;
+    return i < cycles.size() ? i : NO_PC;
+  }
+  uint64_t lookup(const std::vector<uint64_t> &counter, uint64_t pc) const {
+    size_t i = index(pc);
+    return i == NO_PC ? 0 : counter[i];
+  }
+  void add(std::vector<uint64_t> &counter, uint64_t pc, uint64_t amount) {
+    size_t i = index(pc);
+    if (i != NO_PC) counter[i] += amount;
+  }
+
+  bool enabled = false;
+  uint64_t base_addr = 0;
+
+  std::vector<uint64_t> cycles;
+  std::vector<uint64_t> instrs;
+  std::vector<uint64_t> retries;
+  std::vector<uint64_t> bubbles;
+  std::vector<uint64_t> dram_beats;
+  std::vector<uint64_t> sram_conflicts;
+  uint64_t unattributed_cycles = 0;
+
+  // Per-warp stall state, used to pick who to blame for an empty issue slot
+  std::vector<uint64_t> stall_pc;
+  std::vector<uint64_t> stall_since;
+  std::vector<bool> stalled;
+  uint64_t tick_count = 0;
+  bool issued_this_cycle = false;
+  uint64_t issued_pc = 0;
+
+  PCProfiler() = default;
+};
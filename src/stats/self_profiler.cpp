@@ -0,0 +1,69 @@
+#include "self_profiler.hpp"
+#include <cinttypes>
+#include <cstdio>
+
+SelfProfiler::SelfProfiler() {
+  names = {"other", "CoalescingUnit::tick", "stats"};
+  ticks.assign(names.size(), 0);
+}
+
+void SelfProfiler::enable() {
+  enabled = true;
+  start_time = std::chrono::steady_clock::now();
+  start_ticks = now();
+  last = start_ticks;
+}
+
+size_t SelfProfiler::add_section(const std::string &name) {
+  names.push_back(name);
+  ticks.push_back(0);
+  return names.size() - 1;
+}
+
+double SelfProfiler::ns_per_tick() const {
+  double elapsed_ns = std::chrono::duration<double, std::nano>(
+                          std::chrono::steady_clock::now() - start_time)
+                          .count();
+  uint64_t elapsed_ticks = now() - start_ticks;
+  return elapsed_ticks ? elapsed_ns / elapsed_ticks : 1.0;
+}
+
+double SelfProfiler::get_section_ns(size_t section) const {
+  return section < ticks.size() ? ticks[section] * ns_per_tick() : 0.0;
+}
+
+void SelfProfiler::report(std::ostream &out, uint64_t warp_instrs, uint64_t thread_instrs) {
+  double scale = ns_per_tick();
+  uint64_t total_ticks = 0;
+  for (uint64_t t : ticks) {
+    total_ticks += t;
+  }
+  double total_s = total_ticks * scale * 1e-9;
+
+  char buf[160];
+  out << "[Self Profile]" << std::endl;
+  for (size_t i = 0; i < names.size(); i++) {
+    double ms = ticks[i] * scale * 1e-6;
+    double pct = total_ticks ? 100.0 * ticks[i] / total_ticks : 0.0;
+    double ns_per_cycle = sim_cycles ? ticks[i] * scale / sim_cycles : 0.0;
+    snprintf(buf, sizeof(buf), "%-32s %12.1f ms %6.2f%% %10.1f ns/cycle", names[i].c_str(), ms,
+             pct, ns_per_cycle);
+    out << buf << std::endl;
+  }
+
+  auto rate = [total_s](uint64_t n) { return total_s > 0 ? n / total_s : 0.0; };
+  snprintf(buf, sizeof(buf), "Host time: %.3f s", total_s);
+  out << buf << std::endl;
+  snprintf(buf, sizeof(buf), "Simulated cycles: %" PRIu64 " (%.0f cycles/s)", sim_cycles,
+           rate(sim_cycles));
+  out << buf << std::endl;
+  snprintf(buf, sizeof(buf), "Simulated GPU cycles: %" PRIu64 " (%.0f cycles/s)", gpu_cycles,
+           rate(gpu_cycles));
+  out << buf << std::endl;
+  snprintf(buf, sizeof(buf), "GPU warp instructions: %" PRIu64 " (%.0f warp-instrs/s)",
+           warp_instrs, rate(warp_instrs));
+  out << buf << std::endl;
+  snprintf(buf, sizeof(buf), "GPU thread instructions: %" PRIu64 " (%.3f MIPS)", thread_instrs,
+           rate(thread_instrs) * 1e-6);
+  out << buf << std::endl;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/*
+ * Host-side profile of the simulator itself (--self-profile).
+ *
+ * Host time is split into named sections by laps: each lap charges the
+ * time since the previous lap to one section, so a simulated cycle costs
+ * one timestamp per section. Timestamps come from the TSC where available
+ * and are converted to nanoseconds against steady_clock at report time.
+ */
+class SelfProfiler {
+public:
+  static SelfProfiler &instance() {
+    static SelfProfiler inst;
+    return inst;
+  }
+
+  // Fixed sections; pipeline stages register their own
+  enum Section : size_t {
+    SECTION_OTHER,
+    SECTION_COALESCING_UNIT,
+    SECTION_STATS,
+    NUM_FIXED_SECTIONS
+  };
+
+  void enable();
+  bool is_enabled() const { return enabled; }
+
+  size_t add_section(const std::string &name);
+
+  void lap(size_t section) {
+    uint64_t t = now();
+    ticks[section] += t - last;
+    last = t;
+  }
+
+  void count_cycle(bool gpu_active) {
+    sim_cycles++;
+    if (gpu_active) gpu_cycles++;
+  }
+
+  /*
+   * Writes host time per section and simulation speed, given the total
+   * warp and thread instructions executed by the GPU
+   */
+  void report(std::ostream &out, uint64_t warp_instrs, uint64_t thread_instrs);
+
+  double get_section_ns(size_t section) const;
+  const std::vector<std::string> &get_section_names() const { return names; }
+  uint64_t get_sim_cycles() const { return sim_cycles; }
+  uint64_t get_gpu_cycles() const { return gpu_cycles; }
+
+private:
+  static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+  }
+  double ns_per_tick() const;
+
+  bool enabled = false;
+  std::vector<std::string> names;
+  std::vector<uint64_t> ticks;
+  uint64_t last = 0;
+
+  uint64_t start_ticks = 0;
+  std::chrono::steady_clock::time_point start_time;
+
+  uint64_t sim_cycles = 0;
+  uint64_t gpu_cycles = 0;
+
+  SelfProfiler();
+};
@@ -1,4 +1,6 @@
 #include "../utils.hpp"
+#include <algorithm>
+#include <cstdio>
 
 uint64_t GPUStatisticsManager::get_gpu_cycles() { return gpu_cycles; }
 uint64_t GPUStatisticsManager::get_gpu_instrs() { return gpu_instrs; }
@@ -12,6 +14,7 @@ uint64_t GPUStatisticsManager::get_cpu_dram_accs() { return cpu_dram_accs; }
 void GPUStatisticsManager::reset_gpu_cycles() { gpu_cycles = 0; }
 void GPUStatisticsManager::reset_gpu_instrs() {
   gpu_instrs = 0;
+  active_lanes_hist.fill(0);
   instr_delay_pipe.fill(0);
   instr_pipe_head = 0;
   instr_pending_this_cycle = 0;
@@ -23,6 +26,7 @@ void GPUStatisticsManager::reset_gpu_susps() { gpu_susps = 0; }
 void GPUStatisticsManager::increment_gpu_cycles() { gpu_cycles++; }
 void GPUStatisticsManager::increment_gpu_instrs(size_t warp_size) {
   instr_pending_this_cycle += warp_size;
+  active_lanes_hist[std::min(warp_size, NUM_LANES)]++;
 }
 void GPUStatisticsManager::increment_gpu_dram_accs() { gpu_dram_accs++; }
 void GPUStatisticsManager::increment_gpu_retries() { gpu_retries++; }
@@ -45,3 +49,493 @@ void GPUStatisticsManager::tick_instr_pipeline() {
   instr_pending_this_cycle = 0;
   instr_pipe_head = (instr_pipe_head + 1) % INSTR_TREE_DEPTH;
 }
+
+const char *stall_reason_name(StallReason reason) {
+  switch (reason) {
+  case STALL_NONE: return "Issued";
+  case STALL_MEMORY: return "MemoryWait";
+  case STALL_FUNC_UNIT: return "FuncUnitWait";
+  case STALL_BARRIER: return "BarrierWait";
+  case STALL_MULTIPLIER_FULL: return "MultiplierFull";
+  case STALL_DIVIDER_BUSY: return "DividerBusy";
+  case STALL_FPU_BUSY: return "FPUBusy";
+  case STALL_CU_QUEUE_FULL: return "CUQueueFull";
+  case STALL_RETRY: return "RetryBubble";
+  case STALL_PIPELINE: return "PipelineBubble";
+  default: return "Unknown";
+  }
+}
+
+const char *l1_counter_name(L1Counter counter) {
+  switch (counter) {
+  case L1_HITS: return "Hits";
+  case L1_MSHR_MERGES: return "MSHRMerges";
+  case L1_MISSES: return "Misses";
+  case L1_MSHR_STALLS: return "MSHRStalls";
+  case L1_WRITEBACKS: return "Writebacks";
+  case L1_FLUSHES: return "Flushes";
+  default: return "Unknown";
+  }
+}
+
+const char *dram_counter_name(DramCounter counter) {
+  switch (counter) {
+  case DRAM_ROW_HITS: return "RowHits";
+  case DRAM_ROW_CLOSED: return "RowClosed";
+  case DRAM_ROW_CONFLICTS: return "RowConflicts";
+  case DRAM_TURNAROUNDS: return "Turnarounds";
+  default: return "Unknown";
+  }
+}
+
+const char *scoreboard_counter_name(ScoreboardCounter counter) {
+  switch (counter) {
+  case SB_LOADS: return "Loads";
+  case SB_OVERLAPPED_INSTRS: return "OverlappedInstrs";
+  case SB_HAZARD_STALLS: return "HazardStalls";
+  case SB_FULL_STALLS: return "FullStalls";
+  default: return "Unknown";
+  }
+}
+
+const char *scalar_counter_name(ScalarCounter counter) {
+  switch (counter) {
+  case SCALAR_WARP_INSTRS: return "WarpInstrs";
+  case SCALAR_UNIFORM_INSTRS: return "UniformInstrs";
+  case SCALAR_EXECUTED_ONCE: return "ExecutedOnce";
+  case SCALAR_AFFINE_ACCESSES: return "AffineAccesses";
+  default: return "Unknown";
+  }
+}
+
+const char *regfile_counter_name(RegfileCounter counter) {
+  switch (counter) {
+  case RF_UNIFORM_READS: return "UniformReads";
+  case RF_AFFINE_READS: return "AffineReads";
+  case RF_VARYING_READS: return "VaryingReads";
+  case RF_EXPANSIONS: return "Expansions";
+  case RF_COMPRESSIONS: return "Compressions";
+  case RF_PEAK_WORDS: return "PeakWords";
+  case RF_FULL_WORDS: return "FullWords";
+  default: return "Unknown";
+  }
+}
+
+const char *atomic_counter_name(AtomicCounter counter) {
+  switch (counter) {
+  case ATOMIC_WARP_INSTRS: return "WarpInstrs";
+  case ATOMIC_LANE_OPS: return "LaneOps";
+  case ATOMIC_RMWS: return "RMWs";
+  case ATOMIC_COMBINED: return "Combined";
+  default: return "Unknown";
+  }
+}
+
+const char *write_combine_counter_name(WriteCombineCounter counter) {
+  switch (counter) {
+  case WC_STORE_BEATS: return "StoreBeats";
+  case WC_MERGES: return "Merges";
+  case WC_DRAM_BEATS: return "DramBeats";
+  case WC_FULL_BEATS: return "FullBeats";
+  case WC_EVICTIONS: return "Evictions";
+  case WC_DRAINS: return "Drains";
+  case WC_OCCUPANCY: return "Occupancy";
+  case WC_PEAK_ENTRIES: return "PeakEntries";
+  case WC_CYCLES: return "Cycles";
+  default: return "Unknown";
+  }
+}
+
+const char *block_counter_name(BlockCounter counter) {
+  switch (counter) {
+  case BLOCK_DISPATCHED: return "Blocks";
+  case BLOCK_SLOTS: return "Slots";
+  case BLOCK_CYCLES: return "Cycles";
+  case BLOCK_BUSY_SLOT_CYCLES: return "BusySlotCycles";
+  case BLOCK_TAIL_CYCLES: return "TailCycles";
+  default: return "Unknown";
+  }
+}
+
+void GPUStatisticsManager::set_execute_slot(uint64_t warp_id, StallReason outcome) {
+  execute_slot_warp = static_cast<int64_t>(warp_id);
+  execute_slot_outcome = outcome;
+}
+
+void GPUStatisticsManager::set_warp_state(uint64_t warp_id, StallReason state) {
+  if (warp_id < NUM_WARPS) {
+    warp_states[warp_id] = state;
+  }
+}
+
+void GPUStatisticsManager::tick_stall_breakdown() {
+  StallReason slot = execute_slot_outcome;
+  if (execute_slot_warp < 0) {
+    // Empty slot: blame the most serious wait among the live warps, since
+    // a memory-bound warp also holds back any barrier the others are in
+    slot = STALL_PIPELINE;
+    for (StallReason reason : {STALL_MEMORY, STALL_FUNC_UNIT, STALL_BARRIER}) {
+      if (std::find(warp_states.begin(), warp_states.end(), reason) != warp_states.end()) {
+        slot = reason;
+        break;
+      }
+    }
+  }
+  gpu_stalls[slot]++;
+
+  last_warp_state_counts.fill(0);
+  for (size_t w = 0; w < NUM_WARPS; w++) {
+    if (warp_states[w] != NUM_STALL_REASONS) {
+      last_warp_state_counts[warp_states[w]]++;
+    }
+    StallReason state = static_cast<int64_t>(w) == execute_slot_warp ? execute_slot_outcome
+                                                                     : warp_states[w];
+    if (state != NUM_STALL_REASONS) {
+      gpu_warp_stalls[w][state]++;
+    }
+  }
+
+  warp_states.fill(NUM_STALL_REASONS);
+  execute_slot_warp = -1;
+}
+
+uint64_t GPUStatisticsManager::get_gpu_stalls(StallReason reason) { return gpu_stalls[reason]; }
+uint64_t GPUStatisticsManager::get_gpu_warp_stalls(uint64_t warp_id, StallReason reason) {
+  return warp_id < NUM_WARPS ? gpu_warp_stalls[warp_id][reason] : 0;
+}
+void GPUStatisticsManager::reset_gpu_stalls() {
+  gpu_stalls.fill(0);
+  for (auto &warp : gpu_warp_stalls) {
+    warp.fill(0);
+  }
+  warp_states.fill(NUM_STALL_REASONS);
+  last_warp_state_counts.fill(0);
+  execute_slot_warp = -1;
+}
+
+void GPUStatisticsManager::report_stall_breakdown(std::ostream &out) {
+  uint64_t total = 0;
+  for (uint64_t count : gpu_stalls) {
+    total += count;
+  }
+
+  char buf[128];
+  out << "[Stall Breakdown]" << std::endl;
+  for (size_t r = 0; r < NUM_STALL_REASONS; r++) {
+    double pct = total ? 100.0 * gpu_stalls[r] / total : 0.0;
+    snprintf(buf, sizeof(buf), "%-16s %12llu %6.2f%%", stall_reason_name(static_cast<StallReason>(r)),
+             static_cast<unsigned long long>(gpu_stalls[r]), pct);
+    out << buf << std::endl;
+  }
+  out << "Total            " << total << std::endl;
+
+  out << "[Per-Warp Stall Breakdown]" << std::endl;
+  out << "Warp";
+  for (size_t r = 0; r < NUM_STALL_REASONS; r++) {
+    out << "," << stall_reason_name(static_cast<StallReason>(r));
+  }
+  out << std::endl;
+  for (size_t w = 0; w < NUM_WARPS; w++) {
+    const auto &row = gpu_warp_stalls[w];
+    if (std::all_of(row.begin(), row.end(), [](uint64_t count) { return count == 0; })) {
+      continue;
+    }
+    out << w;
+    for (uint64_t count : row) {
+      out << "," << count;
+    }
+    out << std::endl;
+  }
+}
+
+void GPUStatisticsManager::report_active_lanes(std::ostream &out) {
+  uint64_t issues = 0;
+  uint64_t lanes = 0;
+  for (size_t n = 0; n <= NUM_LANES; n++) {
+    issues += active_lanes_hist[n];
+    lanes += n * active_lanes_hist[n];
+  }
+
+  char buf[128];
+  out << "[Active Lanes]" << std::endl;
+  for (size_t n = 0; n <= NUM_LANES; n++) {
+    if (active_lanes_hist[n] == 0) continue;
+    double pct = issues ? 100.0 * active_lanes_hist[n] / issues : 0.0;
+    snprintf(buf, sizeof(buf), "%-16zu %12llu %6.2f%%", n,
+             static_cast<unsigned long long>(active_lanes_hist[n]), pct);
+    out << buf << std::endl;
+  }
+  double efficiency = issues ? 100.0 * lanes / (issues * NUM_LANES) : 0.0;
+  snprintf(buf, sizeof(buf), "SIMT efficiency  %.2f%%", efficiency);
+  out << buf << std::endl;
+}
+
+void GPUStatisticsManager::reset_l1() { l1_counters.fill(0); }
+
+void GPUStatisticsManager::report_l1_cache(std::ostream &out) {
+  char buf[128];
+  out << "[L1 Cache]" << std::endl;
+  for (size_t c = 0; c < NUM_L1_COUNTERS; c++) {
+    snprintf(buf, sizeof(buf), "%-16s %12llu", l1_counter_name(static_cast<L1Counter>(c)),
+             static_cast<unsigned long long>(l1_counters[c]));
+    out << buf << std::endl;
+  }
+  uint64_t lookups = l1_counters[L1_HITS] + l1_counters[L1_MSHR_MERGES] + l1_counters[L1_MISSES];
+  double hit_rate = lookups ? 100.0 * l1_counters[L1_HITS] / lookups : 0.0;
+  snprintf(buf, sizeof(buf), "Hit rate         %.2f%%", hit_rate);
+  out << buf << std::endl;
+}
+
+void GPUStatisticsManager::add_dram_bank_busy(size_t bank, uint64_t cycles) {
+  if (bank >= dram_bank_busy.size()) {
+    dram_bank_busy.resize(bank + 1, 0);
+  }
+  dram_bank_busy[bank] += cycles;
+}
+
+void GPUStatisticsManager::reset_dram() {
+  dram_counters.fill(0);
+  std::fill(dram_bank_busy.begin(), dram_bank_busy.end(), 0);
+}
+
+void GPUStatisticsManager::report_dram_banks(std::ostream &out) {
+  char buf[128];
+  out << "[DRAM Banks]" << std::endl;
+  for (size_t c = 0; c < NUM_DRAM_COUNTERS; c++) {
+    snprintf(buf, sizeof(buf), "%-16s %12llu", dram_counter_name(static_cast<DramCounter>(c)),
+             static_cast<unsigned long long>(dram_counters[c]));
+    out << buf << std::endl;
+  }
+  uint64_t accesses = dram_counters[DRAM_ROW_HITS] + dram_counters[DRAM_ROW_CLOSED] +
+                      dram_counters[DRAM_ROW_CONFLICTS];
+  double hit_rate = accesses ? 100.0 * dram_counters[DRAM_ROW_HITS] / accesses : 0.0;
+  snprintf(buf, sizeof(buf), "Row hit rate     %.2f%%", hit_rate);
+  out << buf << std::endl;
+
+  out << "Bank,BusyCycles,Utilization" << std::endl;
+  for (size_t b = 0; b < dram_bank_busy.size(); b++) {
+    double utilization = gpu_cycles ? 100.0 * dram_bank_busy[b] / gpu_cycles : 0.0;
+    snprintf(buf, sizeof(buf), "%zu,%llu,%.2f%%", b,
+             static_cast<unsigned long long>(dram_bank_busy[b]), utilization);
+    out << buf << std::endl;
+  }
+}
+
+void GPUStatisticsManager::record_sram_access(uint64_t pc, size_t degree) {
+  degree = std::min<size_t>(degree, NUM_LANES);
+  sram_degrees[degree]++;
+  sram_pc_degrees[pc][degree]++;
+}
+
+void GPUStatisticsManager::reset_sram() {
+  sram_degrees.fill(0);
+  sram_pc_degrees.clear();
+}
+
+// Cycles beyond the 2 a conflict-free access takes
+static uint64_t sram_conflict_cycles(const std::array<uint64_t, NUM_LANES + 1> &degrees) {
+  uint64_t cycles = 0;
+  for (size_t d = 3; d <= NUM_LANES; d++) {
+    cycles += (d - 2) * degrees[d];
+  }
+  return cycles;
+}
+
+void GPUStatisticsManager::report_sram(std::ostream &out,
+                                       const std::function<std::string(uint64_t)> &disassemble) {
+  char buf[160];
+  const SramConfig &sram = Config::instance().sramConfig();
+  uint64_t accesses = 0;
+  for (uint64_t n : sram_degrees) {
+    accesses += n;
+  }
+  out << "[Shared SRAM Bank Conflicts]" << std::endl;
+  snprintf(buf, sizeof(buf), "%zu banks, %s hash, queue depth %zu, latency %zu", sram.banks,
+           sram_bank_hash_name(sram.hash), sram.queue_depth, sram.latency);
+  out << buf << std::endl;
+  snprintf(buf, sizeof(buf), "Accesses         %12llu", static_cast<unsigned long long>(accesses));
+  out << buf << std::endl;
+  snprintf(buf, sizeof(buf), "Conflict cycles  %12llu",
+           static_cast<unsigned long long>(sram_conflict_cycles(sram_degrees)));
+  out << buf << std::endl;
+  out << "Degree (lanes on the busiest bank):" << std::endl;
+  for (size_t d = 1; d <= NUM_LANES; d++) {
+    if (sram_degrees[d] == 0) continue;
+    double pct = 100.0 * sram_degrees[d] / accesses;
+    snprintf(buf, sizeof(buf), "  %2zu %12llu %6.2f%%", d,
+             static_cast<unsigned long long>(sram_degrees[d]), pct);
+    out << buf << std::endl;
+  }
+
+  std::vector<std::pair<uint64_t, uint64_t>> order;
+  for (const auto &[pc, degrees] : sram_pc_degrees) {
+    order.push_back({sram_conflict_cycles(degrees), pc});
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [](const auto &a, const auto &b) { return a.first > b.first; });
+  snprintf(buf, sizeof(buf), "%-10s %10s %10s  %s", "PC", "Accesses", "ConflCyc",
+           "Degree:count");
+  out << buf << std::endl;
+  for (const auto &[cycles, pc] : order) {
+    const std::array<uint64_t, NUM_LANES + 1> &degrees = sram_pc_degrees.at(pc);
+    uint64_t pc_accesses = 0;
+    std::string histogram;
+    for (size_t d = 1; d <= NUM_LANES; d++) {
+      if (degrees[d] == 0) continue;
+      pc_accesses += degrees[d];
+      histogram += (histogram.empty() ? "" : " ") + std::to_string(d) + ":" +
+                   std::to_string(degrees[d]);
+    }
+    snprintf(buf, sizeof(buf), "0x%08llx %10llu %10llu  ", static_cast<unsigned long long>(pc),
+             static_cast<unsigned long long>(pc_accesses), static_cast<unsigned long long>(cycles));
+    out << buf << histogram;
+    if (disassemble) {
+      std::string text = disassemble(pc);
+      std::replace(text.begin(), text.end(), '\t', ' ');
+      text.erase(0, text.find_first_not_of(' '));
+      out << "  " << text;
+    }
+    out << std::endl;
+  }
+}
+
+void GPUStatisticsManager::reset_scoreboard() { scoreboard_counters.fill(0); }
+
+void GPUStatisticsManager::report_scoreboard(std::ostream &out) {
+  char buf[128];
+  out << "[Load Scoreboard]" << std::endl;
+  for (size_t c = 0; c < NUM_SCOREBOARD_COUNTERS; c++) {
+    snprintf(buf, sizeof(buf), "%-16s %12llu",
+             scoreboard_counter_name(static_cast<ScoreboardCounter>(c)),
+             static_cast<unsigned long long>(scoreboard_counters[c]));
+    out << buf << std::endl;
+  }
+  uint64_t loads = scoreboard_counters[SB_LOADS];
+  double overlap = loads ? static_cast<double>(scoreboard_counters[SB_OVERLAPPED_INSTRS]) / loads : 0.0;
+  snprintf(buf, sizeof(buf), "Overlap per load %.2f", overlap);
+  out << buf << std::endl;
+}
+
+void GPUStatisticsManager::reset_scalar() { scalar_counters.fill(0); }
+
+void GPUStatisticsManager::report_scalar(std::ostream &out) {
+  char buf[128];
+  out << "[Scalarization]" << std::endl;
+  for (size_t c = 0; c < NUM_SCALAR_COUNTERS; c++) {
+    snprintf(buf, sizeof(buf), "%-16s %12llu", scalar_counter_name(static_cast<ScalarCounter>(c)),
+             static_cast<unsigned long long>(scalar_counters[c]));
+    out << buf << std::endl;
+  }
+  uint64_t instrs = scalar_counters[SCALAR_WARP_INSTRS];
+  double uniform = instrs ? 100.0 * scalar_counters[SCALAR_UNIFORM_INSTRS] / instrs : 0.0;
+  snprintf(buf, sizeof(buf), "Scalarizable     %.2f%%", uniform);
+  out << buf << std::endl;
+}
+
+void GPUStatisticsManager::note_regfile_words(size_t stored, size_t full) {
+  regfile_stored_words = stored;
+  regfile_full_words = full;
+  if (stored > regfile_counters[RF_PEAK_WORDS]) {
+    regfile_counters[RF_PEAK_WORDS] = stored;
+  }
+  if (full > regfile_counters[RF_FULL_WORDS]) {
+    regfile_counters[RF_FULL_WORDS] = full;
+  }
+}
+
+void GPUStatisticsManager::reset_regfile() {
+  regfile_counters.fill(0);
+  regfile_counters[RF_PEAK_WORDS] = regfile_stored_words;
+  regfile_counters[RF_FULL_WORDS] = regfile_full_words;
+}
+
+void GPUStatisticsManager::report_regfile(std::ostream &out) {
+  char buf[128];
+  out << "[Register File Compression]" << std::endl;
+  for (size_t c = 0; c < NUM_REGFILE_COUNTERS; c++) {
+    snprintf(buf, sizeof(buf), "%-16s %12llu", regfile_counter_name(static_cast<RegfileCounter>(c)),
+             static_cast<unsigned long long>(regfile_counters[c]));
+    out << buf << std::endl;
+  }
+  uint64_t reads = regfile_counters[RF_UNIFORM_READS] + regfile_counters[RF_AFFINE_READS] +
+                   regfile_counters[RF_VARYING_READS];
+  uint64_t compressed = regfile_counters[RF_UNIFORM_READS] + regfile_counters[RF_AFFINE_READS];
+  uint64_t full = regfile_counters[RF_FULL_WORDS];
+  double hit_rate = reads ? 100.0 * compressed / reads : 0.0;
+  double savings = full ? 100.0 * (1.0 - static_cast<double>(regfile_counters[RF_PEAK_WORDS]) / full) : 0.0;
+  snprintf(buf, sizeof(buf), "Compressed reads %.2f%%", hit_rate);
+  out << buf << std::endl;
+  snprintf(buf, sizeof(buf), "SRAM saved       %.2f%% (%llu of %llu words at peak)", savings,
+           static_cast<unsigned long long>(regfile_counters[RF_PEAK_WORDS]),
+           static_cast<unsigned long long>(full));
+  out << buf << std::endl;
+}
+
+void GPUStatisticsManager::reset_atomics() { atomic_counters.fill(0); }
+
+void GPUStatisticsManager::report_atomics(std::ostream &out) {
+  char buf[128];
+  out << "[Atomics]" << std::endl;
+  for (size_t c = 0; c < NUM_ATOMIC_COUNTERS; c++) {
+    snprintf(buf, sizeof(buf), "%-16s %12llu", atomic_counter_name(static_cast<AtomicCounter>(c)),
+             static_cast<unsigned long long>(atomic_counters[c]));
+    out << buf << std::endl;
+  }
+  uint64_t rmws = atomic_counters[ATOMIC_RMWS];
+  double per_rmw = rmws ? static_cast<double>(atomic_counters[ATOMIC_LANE_OPS]) / rmws : 0.0;
+  snprintf(buf, sizeof(buf), "Lanes per RMW    %.2f", per_rmw);
+  out << buf << std::endl;
+}
+
+void GPUStatisticsManager::note_write_combining_entries(size_t entries) {
+  wc_counters[WC_OCCUPANCY] += entries;
+  wc_counters[WC_CYCLES]++;
+  if (entries > wc_counters[WC_PEAK_ENTRIES]) {
+    wc_counters[WC_PEAK_ENTRIES] = entries;
+  }
+}
+
+void GPUStatisticsManager::reset_write_combining() { wc_counters.fill(0); }
+
+void GPUStatisticsManager::report_write_combining(std::ostream &out) {
+  char buf[128];
+  out << "[Write Combining]" << std::endl;
+  for (size_t c = 0; c < NUM_WC_COUNTERS; c++) {
+    snprintf(buf, sizeof(buf), "%-16s %12llu",
+             write_combine_counter_name(static_cast<WriteCombineCounter>(c)),
+             static_cast<unsigned long long>(wc_counters[c]));
+    out << buf << std::endl;
+  }
+  uint64_t beats = wc_counters[WC_STORE_BEATS];
+  uint64_t cycles = wc_counters[WC_CYCLES];
+  double merge_rate = beats ? 100.0 * wc_counters[WC_MERGES] / beats : 0.0;
+  double occupancy = cycles ? static_cast<double>(wc_counters[WC_OCCUPANCY]) / cycles : 0.0;
+  snprintf(buf, sizeof(buf), "Merge rate       %.2f%%", merge_rate);
+  out << buf << std::endl;
+  snprintf(buf, sizeof(buf), "Avg occupancy    %.2f entries", occupancy);
+  out << buf << std::endl;
+}
+
+void GPUStatisticsManager::reset_blocks() { block_counters.fill(0); }
+
+void GPUStatisticsManager::report_blocks(std::ostream &out) {
+  char buf[128];
+  out << "[Block Dispatch]" << std::endl;
+  for (size_t c = 0; c < NUM_BLOCK_COUNTERS; c++) {
+    snprintf(buf, sizeof(buf), "%-16s %12llu", block_counter_name(static_cast<BlockCounter>(c)),
+             static_cast<unsigned long long>(block_counters[c]));
+    out << buf << std::endl;
+  }
+  uint64_t slots = block_counters[BLOCK_SLOTS];
+  uint64_t cycles = block_counters[BLOCK_CYCLES];
+  uint64_t waves = slots ? (block_counters[BLOCK_DISPATCHED] + slots - 1) / slots : 0;
+  double occupancy =
+      slots && cycles ? 100.0 * block_counters[BLOCK_BUSY_SLOT_CYCLES] / (slots * cycles) : 0.0;
+  double tail = cycles ? 100.0 * block_counters[BLOCK_TAIL_CYCLES] / cycles : 0.0;
+  snprintf(buf, sizeof(buf), "Waves            %12llu", static_cast<unsigned long long>(waves));
+  out << buf << std::endl;
+  snprintf(buf, sizeof(buf), "Slot occupancy   %.2f%%", occupancy);
+  out << buf << std::endl;
+  snprintf(buf, sizeof(buf), "Tail share       %.2f%%", tail);
+  out << buf << std::endl;
+}
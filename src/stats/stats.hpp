@@ -2,6 +2,135 @@
 
 #include <stdint.h>
 #include <array>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "config.hpp"
+
+/*
+ * Why the GPU execute slot did not retire an instruction in a cycle
+ * (STALL_NONE means it did). Classified once per GPU cycle in total,
+ * and for every live warp per warp.
+ */
+enum StallReason {
+  STALL_NONE,
+  STALL_MEMORY,           // Suspended on a memory request
+  STALL_FUNC_UNIT,        // Suspended on a multi-cycle mul/div result
+  STALL_BARRIER,          // Waiting in a barrier (in_barrier)
+  STALL_MULTIPLIER_FULL,  // Retried: can_use_multiplier() was false
+  STALL_DIVIDER_BUSY,     // Retried: can_use_divider() was false
+  STALL_FPU_BUSY,         // Retried: can_use_fpu() or can_use_fp_divider() was false
+  STALL_CU_QUEUE_FULL,    // Retried: the coalescing unit could not take the request
+  STALL_RETRY,            // Any other retry
+  STALL_PIPELINE,         // Nothing in the execute slot, or warp ready but not there
+  NUM_STALL_REASONS
+};
+
+const char *stall_reason_name(StallReason reason);
+
+/*
+ * L1 data cache events (--l1-size). Hits, merges and misses count lines
+ * looked up by GPU loads, after coalescing.
+ */
+enum L1Counter {
+  L1_HITS,
+  L1_MSHR_MERGES,  // Missed a line whose fill was already in flight
+  L1_MISSES,
+  L1_MSHR_STALLS,  // Cycles the coalescing unit waited for a free MSHR
+  L1_WRITEBACKS,   // Dirty lines written to DRAM (write-back only)
+  L1_FLUSHES,      // Lines invalidated by cache_line_flush
+  NUM_L1_COUNTERS
+};
+
+const char *l1_counter_name(L1Counter counter);
+
+// Banked DRAM events (--dram-model=banked), counted per beat
+enum DramCounter {
+  DRAM_ROW_HITS,
+  DRAM_ROW_CLOSED,     // The bank had no open row
+  DRAM_ROW_CONFLICTS,  // Another row was open and had to be precharged
+  DRAM_TURNAROUNDS,    // Reads delayed by tWTR after a write
+  NUM_DRAM_COUNTERS
+};
+
+const char *dram_counter_name(DramCounter counter);
+
+// Non-blocking GPU loads (--load-scoreboard)
+enum ScoreboardCounter {
+  SB_LOADS,              // Loads issued without suspending the warp
+  SB_OVERLAPPED_INSTRS,  // Warp instructions issued while the warp had loads outstanding
+  SB_HAZARD_STALLS,      // Suspensions on an operand of a pending load
+  SB_FULL_STALLS,        // Suspensions of a load with the scoreboard full
+  NUM_SCOREBOARD_COUNTERS
+};
+
+const char *scoreboard_counter_name(ScoreboardCounter counter);
+
+// Uniform and affine register operands of GPU warp instructions (--scalarize)
+enum ScalarCounter {
+  SCALAR_WARP_INSTRS,      // Warp instructions checked
+  SCALAR_UNIFORM_INSTRS,   // Every register source was uniform across the warp
+  SCALAR_EXECUTED_ONCE,    // Uniform ALU instructions computed for one lane and broadcast
+  SCALAR_AFFINE_ACCESSES,  // Loads and stores whose base register strides by the access size
+  NUM_SCALAR_COUNTERS
+};
+
+const char *scalar_counter_name(ScalarCounter counter);
+
+// Compressed GPU vector registers in the register file's backing store
+enum RegfileCounter {
+  RF_UNIFORM_READS,   // Lane reads served from a single stored value
+  RF_AFFINE_READS,    // Lane reads computed from base + lane * stride
+  RF_VARYING_READS,   // Lane reads of an expanded register
+  RF_EXPANSIONS,      // Writes that unpacked a compressed register to every lane
+  RF_COMPRESSIONS,    // Full-warp writes that left the register uniform or affine again
+  RF_PEAK_WORDS,      // Most words the compressed registers took
+  RF_FULL_WORDS,      // Words the same registers take uncompressed
+  NUM_REGFILE_COUNTERS
+};
+
+const char *regfile_counter_name(RegfileCounter counter);
+
+// GPU atomics and how many read-modify-writes --atomic-combining saved
+enum AtomicCounter {
+  ATOMIC_WARP_INSTRS,  // Atomic warp instructions performed
+  ATOMIC_LANE_OPS,     // Lane operations they issued
+  ATOMIC_RMWS,         // Read-modify-writes at memory
+  ATOMIC_COMBINED,     // Lane operations merged into another lane's read-modify-write
+  NUM_ATOMIC_COUNTERS
+};
+
+const char *atomic_counter_name(AtomicCounter counter);
+
+// GPU store write-combining buffer (--write-combining), counted per DRAM beat
+enum WriteCombineCounter {
+  WC_STORE_BEATS,   // Beats written into the buffer by store instructions
+  WC_MERGES,        // Of those, beats that merged into an entry already held
+  WC_DRAM_BEATS,    // Beats the buffer wrote to DRAM
+  WC_FULL_BEATS,    // Of those, beats with every byte written
+  WC_EVICTIONS,     // Entries written out to make room for another beat
+  WC_DRAINS,        // Entries written out for a load, atomic or fence, or left unwritten too long
+  WC_OCCUPANCY,     // Entries held, summed over GPU cycles
+  WC_PEAK_ENTRIES,  // Most entries held at once
+  WC_CYCLES,        // GPU cycles the occupancy was sampled over
+  NUM_WC_COUNTERS
+};
+
+const char *write_combine_counter_name(WriteCombineCounter counter);
+
+// Hardware block dispatcher, for launches with grid dimensions
+enum BlockCounter {
+  BLOCK_DISPATCHED,        // Blocks started on a slot
+  BLOCK_SLOTS,             // Slots of warps_per_block warps
+  BLOCK_CYCLES,            // Cycles from the first wave until the grid finished
+  BLOCK_BUSY_SLOT_CYCLES,  // Slots running a block, summed over those cycles
+  BLOCK_TAIL_CYCLES,       // Cycles with every block dispatched and a slot idle
+  NUM_BLOCK_COUNTERS
+};
+
+const char *block_counter_name(BlockCounter counter);
 
 class GPUStatisticsManager {
 public:
@@ -42,6 +171,97 @@ public:
 
   void tick_instr_pipeline();
 
+  // Stall breakdown: the execute stage reports its slot, the warp
+  // scheduler the state of every live warp, then one tick per GPU cycle
+  void set_execute_slot(uint64_t warp_id, StallReason outcome);
+  void set_warp_state(uint64_t warp_id, StallReason state);
+  void tick_stall_breakdown();
+  uint64_t get_gpu_stalls(StallReason reason);
+  uint64_t get_gpu_warp_stalls(uint64_t warp_id, StallReason reason);
+  // Number of warps in a state during the last ticked cycle
+  uint64_t get_warp_state_count(StallReason state) { return last_warp_state_counts[state]; }
+  void reset_gpu_stalls();
+  // Totals with percentages, then one CSV row per warp that was live
+  void report_stall_breakdown(std::ostream &out);
+
+  // Issued warp instructions by number of active lanes (0..NUM_LANES),
+  // reset with the instruction counter
+  const std::array<uint64_t, NUM_LANES + 1> &get_active_lanes_histogram() {
+    return active_lanes_hist;
+  }
+  // Histogram with percentages and the SIMT efficiency
+  void report_active_lanes(std::ostream &out);
+
+  void increment_l1(L1Counter counter, uint64_t n = 1) { l1_counters[counter] += n; }
+  uint64_t get_l1(L1Counter counter) { return l1_counters[counter]; }
+  void reset_l1();
+  // Counters and the hit rate of the L1 data cache
+  void report_l1_cache(std::ostream &out);
+
+  void increment_dram(DramCounter counter) { dram_counters[counter]++; }
+  uint64_t get_dram(DramCounter counter) { return dram_counters[counter]; }
+  // Cycles bank (channel * banks + bank) spent activating, precharging or on column commands
+  void add_dram_bank_busy(size_t bank, uint64_t cycles);
+  const std::vector<uint64_t> &get_dram_bank_busy() { return dram_bank_busy; }
+  void reset_dram();
+  // Row buffer outcomes, the row hit rate and the utilization of every bank
+  void report_dram_banks(std::ostream &out);
+
+  /*
+   * Shared SRAM bank conflicts of GPU accesses. The degree of an access is
+   * the most lanes that needed one bank (1 for a broadcast), overall and
+   * per issuing PC.
+   */
+  void record_sram_access(uint64_t pc, size_t degree);
+  const std::array<uint64_t, NUM_LANES + 1> &get_sram_conflict_degrees() { return sram_degrees; }
+  const std::map<uint64_t, std::array<uint64_t, NUM_LANES + 1>> &get_sram_pc_conflict_degrees() {
+    return sram_pc_degrees;
+  }
+  void reset_sram();
+  // Degree histograms and bank conflict cycles, per PC annotated with disassemble(pc)
+  void report_sram(std::ostream &out, const std::function<std::string(uint64_t)> &disassemble);
+
+  void increment_scoreboard(ScoreboardCounter counter) { scoreboard_counters[counter]++; }
+  uint64_t get_scoreboard(ScoreboardCounter counter) { return scoreboard_counters[counter]; }
+  void reset_scoreboard();
+  // Counters and the instructions overlapped per non-blocking load
+  void report_scoreboard(std::ostream &out);
+
+  void increment_scalar(ScalarCounter counter) { scalar_counters[counter]++; }
+  uint64_t get_scalar(ScalarCounter counter) { return scalar_counters[counter]; }
+  void reset_scalar();
+  // Counters and the fraction of scalarizable warp instructions
+  void report_scalar(std::ostream &out);
+
+  void increment_regfile(RegfileCounter counter) { regfile_counters[counter]++; }
+  uint64_t get_regfile(RegfileCounter counter) { return regfile_counters[counter]; }
+  // Current size of the compressed register file; the peak is kept until a reset
+  void note_regfile_words(size_t stored, size_t full);
+  // Counters are cleared, the peak restarts from the current size
+  void reset_regfile();
+  // Read hit rates and the SRAM the compression saves at its peak
+  void report_regfile(std::ostream &out);
+
+  void add_atomics(AtomicCounter counter, uint64_t n) { atomic_counters[counter] += n; }
+  uint64_t get_atomics(AtomicCounter counter) { return atomic_counters[counter]; }
+  void reset_atomics();
+  // Counters and the lane operations per read-modify-write
+  void report_atomics(std::ostream &out);
+
+  void add_write_combining(WriteCombineCounter counter, uint64_t n) { wc_counters[counter] += n; }
+  uint64_t get_write_combining(WriteCombineCounter counter) { return wc_counters[counter]; }
+  // Samples the buffer occupancy for one GPU cycle
+  void note_write_combining_entries(size_t entries);
+  void reset_write_combining();
+  // Counters, the merge rate and the average occupancy
+  void report_write_combining(std::ostream &out);
+
+  void add_blocks(BlockCounter counter, uint64_t n) { block_counters[counter] += n; }
+  uint64_t get_blocks(BlockCounter counter) { return block_counters[counter]; }
+  void reset_blocks();
+  // Counters, the waves, the slot occupancy and the share of the tail
+  void report_blocks(std::ostream &out);
+
 private:
   uint64_t gpu_cycles = 0;
   uint64_t gpu_instrs = 0;
@@ -58,5 +278,28 @@ private:
   size_t instr_pipe_head = 0;
   uint64_t instr_pending_this_cycle = 0;
 
-  GPUStatisticsManager() = default;
+  std::array<uint64_t, NUM_LANES + 1> active_lanes_hist = {};
+  std::array<uint64_t, NUM_L1_COUNTERS> l1_counters = {};
+  std::array<uint64_t, NUM_DRAM_COUNTERS> dram_counters = {};
+  std::vector<uint64_t> dram_bank_busy;
+  std::array<uint64_t, NUM_LANES + 1> sram_degrees = {};
+  std::map<uint64_t, std::array<uint64_t, NUM_LANES + 1>> sram_pc_degrees;
+  std::array<uint64_t, NUM_SCOREBOARD_COUNTERS> scoreboard_counters = {};
+  std::array<uint64_t, NUM_SCALAR_COUNTERS> scalar_counters = {};
+  std::array<uint64_t, NUM_REGFILE_COUNTERS> regfile_counters = {};
+  size_t regfile_stored_words = 0;
+  size_t regfile_full_words = 0;
+  std::array<uint64_t, NUM_ATOMIC_COUNTERS> atomic_counters = {};
+  std::array<uint64_t, NUM_WC_COUNTERS> wc_counters = {};
+  std::array<uint64_t, NUM_BLOCK_COUNTERS> block_counters = {};
+
+  std::array<uint64_t, NUM_STALL_REASONS> gpu_stalls = {};
+  std::array<std::array<uint64_t, NUM_STALL_REASONS>, NUM_WARPS> gpu_warp_stalls = {};
+  // This cycle's state per warp; NUM_STALL_REASONS for warps not reported
+  std::array<StallReason, NUM_WARPS> warp_states;
+  std::array<uint64_t, NUM_STALL_REASONS> last_warp_state_counts = {};
+  int64_t execute_slot_warp = -1;
+  StallReason execute_slot_outcome = STALL_NONE;
+
+  GPUStatisticsManager() { warp_states.fill(NUM_STALL_REASONS); }
 };
\ No newline at end of file
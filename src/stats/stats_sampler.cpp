@@ -0,0 +1,107 @@
+#include "stats_sampler.hpp"
+#include "../utils.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+static const char *const SAMPLE_COLUMNS[] = {
+    "launch",        "cycle",          "instrs",          "retries",        "susps",
+    "dram_accs",     "ipc",            "issued",          "active_lanes",   "dram_inflight",
+    "cu_queue_depth", "suspended_warps", "barrier_warps",
+};
+static constexpr size_t NUM_SAMPLE_COLUMNS = sizeof(SAMPLE_COLUMNS) / sizeof(SAMPLE_COLUMNS[0]);
+
+StatsSampler::StatsSampler(const std::string &file_name, uint64_t interval,
+                           StatsSampleFormat format)
+    : interval(interval ? interval : 1), format(format) {
+  if (format == STATS_SAMPLE_BINARY) {
+    out.open(file_name, std::ios::binary);
+    out.write(STATS_BINARY_MAGIC, sizeof(STATS_BINARY_MAGIC));
+    uint32_t columns = NUM_SAMPLE_COLUMNS;
+    out.write(reinterpret_cast<const char *>(&columns), sizeof(columns));
+    for (const char *name : SAMPLE_COLUMNS) {
+      uint8_t len = static_cast<uint8_t>(strlen(name));
+      out.write(reinterpret_cast<const char *>(&len), 1);
+      out.write(name, len);
+    }
+  } else {
+    out.open(file_name);
+    for (size_t i = 0; i < NUM_SAMPLE_COLUMNS; i++) {
+      out << (i ? "," : "") << SAMPLE_COLUMNS[i];
+    }
+    out << "\n";
+  }
+}
+
+void StatsSampler::end_launch(uint64_t dram_inflight, uint64_t cu_queue_depth) {
+  if (cycles_since_sample > 0) {
+    sample(dram_inflight, cu_queue_depth);
+  }
+  if (launch_sampled) {
+    launch++;
+  }
+  launch_sampled = false;
+  last_cycles = last_instrs = last_issued = 0;
+  out.flush();
+}
+
+void StatsSampler::sample(uint64_t dram_inflight, uint64_t cu_queue_depth) {
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+  uint64_t cycles = stats.get_gpu_cycles();
+  uint64_t instrs = stats.get_gpu_instrs();
+  uint64_t issued = stats.get_gpu_stalls(STALL_NONE);
+
+  // The counters restart at a kernel launch; a drop means end_launch() was missed
+  if (cycles < last_cycles) {
+    launch++;
+    last_cycles = last_instrs = last_issued = 0;
+  }
+
+  uint64_t delta_cycles = cycles - last_cycles;
+  uint64_t delta_instrs = instrs - last_instrs;
+  uint64_t delta_issued = issued - last_issued;
+
+  double row[NUM_SAMPLE_COLUMNS] = {
+      static_cast<double>(launch),
+      static_cast<double>(cycles),
+      static_cast<double>(instrs),
+      static_cast<double>(stats.get_gpu_retries()),
+      static_cast<double>(stats.get_gpu_susps()),
+      static_cast<double>(stats.get_gpu_dram_accs()),
+      delta_cycles ? static_cast<double>(delta_instrs) / delta_cycles : 0.0,
+      static_cast<double>(delta_issued),
+      // Instruction counts lag issue by the instruction tree depth, which
+      // can push a short interval over a full warp
+      delta_issued ? std::min<double>(static_cast<double>(delta_instrs) / delta_issued, NUM_LANES)
+                   : 0.0,
+      static_cast<double>(dram_inflight),
+      static_cast<double>(cu_queue_depth),
+      static_cast<double>(stats.get_warp_state_count(STALL_MEMORY) +
+                          stats.get_warp_state_count(STALL_FUNC_UNIT)),
+      static_cast<double>(stats.get_warp_state_count(STALL_BARRIER)),
+  };
+  write_row(row);
+
+  last_cycles = cycles;
+  last_instrs = instrs;
+  last_issued = issued;
+  cycles_since_sample = 0;
+  launch_sampled = true;
+}
+
+void StatsSampler::write_row(const double *values) {
+  rows++;
+  if (format == STATS_SAMPLE_BINARY) {
+    out.write(reinterpret_cast<const char *>(values), sizeof(double) * NUM_SAMPLE_COLUMNS);
+    return;
+  }
+
+  char buf[64];
+  for (size_t i = 0; i < NUM_SAMPLE_COLUMNS; i++) {
+    // Rates keep a few decimals, everything else is a whole count
+    bool rate = i == 6 || i == 8;
+    snprintf(buf, sizeof(buf), rate ? "%s%.4f" : "%s%.0f", i ? "," : "", values[i]);
+    out << buf;
+  }
+  out << "\n";
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdint.h>
+#include <fstream>
+#include <string>
+
+/*
+ * Time-series export of the GPU counters (--stats-interval).
+ *
+ * Every `interval` GPU cycles one row is written with the cumulative
+ * counters of the current kernel launch plus rates over the interval and
+ * instantaneous occupancy. The last, partial interval of a launch is
+ * written by end_launch().
+ *
+ * CSV files have a header row. Binary files start with STATS_BINARY_MAGIC,
+ * a uint32 column count and each column name as a uint8 length plus the
+ * characters, followed by one row of little-endian doubles per sample.
+ */
+enum StatsSampleFormat {
+  STATS_SAMPLE_CSV,
+  STATS_SAMPLE_BINARY,
+};
+
+constexpr char STATS_BINARY_MAGIC[8] = {'R', 'V', 'G', 'S', 'T', 'A', 'T', '1'};
+
+class StatsSampler {
+public:
+  StatsSampler(const std::string &file_name, uint64_t interval, StatsSampleFormat format);
+
+  bool is_open() const { return out.is_open(); }
+
+  /*
+   * Called once per active GPU cycle, after the cycle has been counted.
+   * The occupancy arguments are the coalescing unit's current state.
+   */
+  void tick(uint64_t dram_inflight, uint64_t cu_queue_depth) {
+    if (++cycles_since_sample == interval) {
+      sample(dram_inflight, cu_queue_depth);
+    }
+  }
+
+  /*
+   * Writes the partial interval at the end of a kernel launch, if any
+   */
+  void end_launch(uint64_t dram_inflight, uint64_t cu_queue_depth);
+
+  uint64_t get_rows() const { return rows; }
+
+private:
+  void sample(uint64_t dram_inflight, uint64_t cu_queue_depth);
+  void write_row(const double *values);
+
+  std::ofstream out;
+  uint64_t interval;
+  StatsSampleFormat format;
+  uint64_t cycles_since_sample = 0;
+  uint64_t rows = 0;
+
+  uint64_t launch = 0;
+  bool launch_sampled = false;
+  uint64_t last_cycles = 0;
+  uint64_t last_instrs = 0;
+  uint64_t last_issued = 0;
+};
@@ -0,0 +1,126 @@
+#include "lz_codec.hpp"
+#include <cstring>
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_OFFSET = 0xFFFF;
+constexpr size_t HASH_LOG = 14;
+// The last bytes are always emitted as literals so matching can read 4 bytes freely
+constexpr size_t TAIL_LITERALS = 8;
+
+uint32_t read32(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+uint32_t hash32(uint32_t v) {
+  return (v * 2654435761U) >> (32 - HASH_LOG);
+}
+
+void write_length(size_t len, std::vector<uint8_t> &out) {
+  while (len >= 255) {
+    out.push_back(255);
+    len -= 255;
+  }
+  out.push_back(static_cast<uint8_t>(len));
+}
+
+void emit_sequence(const uint8_t *literals, size_t literal_len, size_t offset,
+                   size_t match_len, std::vector<uint8_t> &out) {
+  // Token: high nibble literal length, low nibble match length - MIN_MATCH
+  size_t match_code = match_len >= MIN_MATCH ? match_len - MIN_MATCH : 0;
+  uint8_t token = static_cast<uint8_t>((literal_len < 15 ? literal_len : 15) << 4) |
+                  static_cast<uint8_t>(match_code < 15 ? match_code : 15);
+  out.push_back(token);
+  if (literal_len >= 15) write_length(literal_len - 15, out);
+  out.insert(out.end(), literals, literals + literal_len);
+
+  if (match_len == 0) return;  // Final literal-only sequence
+  out.push_back(static_cast<uint8_t>(offset & 0xFF));
+  out.push_back(static_cast<uint8_t>(offset >> 8));
+  if (match_code >= 15) write_length(match_code - 15, out);
+}
+
+}  // namespace
+
+void lz_compress(const uint8_t *data, size_t size, std::vector<uint8_t> &out) {
+  std::vector<uint32_t> table(1 << HASH_LOG, UINT32_MAX);
+  size_t anchor = 0;
+  size_t pos = 0;
+
+  if (size > TAIL_LITERALS + MIN_MATCH) {
+    size_t limit = size - TAIL_LITERALS;
+    while (pos < limit) {
+      uint32_t seq = read32(data + pos);
+      uint32_t h = hash32(seq);
+      uint32_t candidate = table[h];
+      table[h] = static_cast<uint32_t>(pos);
+
+      if (candidate == UINT32_MAX || pos - candidate > MAX_OFFSET ||
+          read32(data + candidate) != seq) {
+        pos++;
+        continue;
+      }
+
+      size_t match_len = MIN_MATCH;
+      while (pos + match_len < limit &&
+             data[candidate + match_len] == data[pos + match_len]) {
+        match_len++;
+      }
+
+      emit_sequence(data + anchor, pos - anchor, pos - candidate, match_len, out);
+      pos += match_len;
+      anchor = pos;
+    }
+  }
+
+  emit_sequence(data + anchor, size - anchor, 0, 0, out);
+}
+
+bool lz_decompress(const uint8_t *data, size_t size, size_t raw_size,
+                   std::vector<uint8_t> &out) {
+  out.clear();
+  out.reserve(raw_size);
+  size_t pos = 0;
+
+  auto read_length = [&](size_t &len) {
+    uint8_t b;
+    do {
+      if (pos >= size) return false;
+      b = data[pos++];
+      len += b;
+    } while (b == 255);
+    return true;
+  };
+
+  while (pos < size) {
+    uint8_t token = data[pos++];
+    size_t literal_len = token >> 4;
+    if (literal_len == 15 && !read_length(literal_len)) return false;
+    if (pos + literal_len > size || out.size() + literal_len > raw_size) return false;
+    out.insert(out.end(), data + pos, data + pos + literal_len);
+    pos += literal_len;
+
+    if (pos == size) break;  // Final literal-only sequence
+
+    if (pos + 2 > size) return false;
+    size_t offset = data[pos] | (static_cast<size_t>(data[pos + 1]) << 8);
+    pos += 2;
+    size_t match_len = token & 0xF;
+    if (match_len == 15 && !read_length(match_len)) return false;
+    match_len += MIN_MATCH;
+
+    if (offset == 0 || offset > out.size() || out.size() + match_len > raw_size) {
+      return false;
+    }
+    // Byte-by-byte copy: overlapping matches are how runs are encoded
+    size_t from = out.size() - offset;
+    for (size_t i = 0; i < match_len; i++) {
+      out.push_back(out[from + i]);
+    }
+  }
+
+  return out.size() == raw_size;
+}
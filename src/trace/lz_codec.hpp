@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * A small LZ77 byte codec for trace blocks (LZ4-style sequences of
+ * literals followed by a back-reference), so the trace format has no
+ * external compression dependency.
+ */
+
+/*
+ * Appends the compressed form of data[0..size) to out
+ */
+void lz_compress(const uint8_t *data, size_t size, std::vector<uint8_t> &out);
+
+/*
+ * Decompresses exactly raw_size bytes into out.
+ * Returns false if the input is truncated or malformed.
+ */
+bool lz_decompress(const uint8_t *data, size_t size, size_t raw_size,
+                   std::vector<uint8_t> &out);
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/*
+ * A lock-free single-producer/single-consumer ring buffer.
+ *
+ * The simulator thread is the only producer and the trace writer thread
+ * is the only consumer, so head and tail only need acquire/release
+ * ordering. The producer caches the consumer's index so a push only
+ * touches the shared cache line when the buffer looks full; the consumer
+ * pops in batches so it reloads the producer's index once per batch.
+ */
+template <typename T, size_t Capacity>
+class SpscRingBuffer {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscRingBuffer capacity must be a power of two");
+
+public:
+    SpscRingBuffer() : slots(Capacity) {}
+
+    /*
+     * Producer side: returns false if the buffer is full
+     */
+    bool try_push(const T &item) {
+        size_t head = head_idx.load(std::memory_order_relaxed);
+        if (head - cached_tail == Capacity) {
+            cached_tail = tail_idx.load(std::memory_order_acquire);
+            if (head - cached_tail == Capacity) {
+                return false;
+            }
+        }
+        slots[head & MASK] = item;
+        head_idx.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*
+     * Consumer side: pops up to max_items into out, returns the count
+     */
+    size_t try_pop_batch(T *out, size_t max_items) {
+        size_t tail = tail_idx.load(std::memory_order_relaxed);
+        size_t head = head_idx.load(std::memory_order_acquire);
+        size_t count = head - tail;
+        if (count > max_items) count = max_items;
+        for (size_t i = 0; i < count; i++) {
+            out[i] = slots[(tail + i) & MASK];
+        }
+        tail_idx.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    bool empty() const {
+        return head_idx.load(std::memory_order_acquire) ==
+               tail_idx.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    std::vector<T> slots;
+
+    // Producer-owned
+    alignas(64) std::atomic<size_t> head_idx{0};
+    size_t cached_tail = 0;
+
+    // Consumer-owned
+    alignas(64) std::atomic<size_t> tail_idx{0};
+};
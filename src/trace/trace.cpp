@@ -0,0 +1,241 @@
+#include "trace.hpp"
+#include "trace_compact.hpp"
+#include "trace_compare.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+struct TraceFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+};
+
+static TraceRecord pack_event(const TraceEvent &event, size_t addr_count) {
+    TraceRecord record = {};
+    record.event.cycle = event.cycle;
+    record.event.pc = event.pc;
+    record.event.warp_id = static_cast<uint32_t>(event.warp_id);
+    record.event.lane_id = event.lane_id;
+    record.event.event_type = static_cast<uint8_t>(event.event_type);
+    record.event.addr_count = static_cast<uint16_t>(addr_count);
+    if (event.event_type == DRAM_ACCESS) {
+        record.event.access_type = static_cast<uint8_t>(event.access_type);
+        record.event.beats = static_cast<uint16_t>(event.beats);
+        record.event.groups = static_cast<uint8_t>(event.groups);
+        record.event.is_sram = event.is_sram ? 1 : 0;
+    }
+    return record;
+}
+
+bool TraceRecordAssembler::consume(const TraceRecord &record, TraceEvent &event) {
+    if (addrs_remaining > 0) {
+        size_t count = std::min(addrs_remaining, TraceRecord::ADDRS_PER_RECORD);
+        pending.addrs.insert(pending.addrs.end(), record.addrs, record.addrs + count);
+        addrs_remaining -= count;
+        if (addrs_remaining > 0) return false;
+        event = pending;
+        return true;
+    }
+
+    pending.cycle = record.event.cycle;
+    pending.pc = record.event.pc;
+    pending.warp_id = record.event.warp_id;
+    pending.lane_id = record.event.lane_id;
+    pending.event_type = static_cast<EventType>(record.event.event_type);
+    pending.access_type = static_cast<char>(record.event.access_type);
+    pending.beats = record.event.beats;
+    pending.groups = record.event.groups;
+    pending.is_sram = record.event.is_sram != 0;
+    pending.addrs.clear();
+
+    addrs_remaining = record.event.addr_count;
+    if (addrs_remaining > 0) return false;
+    event = pending;
+    return true;
+}
+
+void TraceCsvFormatter::format(const TraceEvent &event, std::string &out) {
+    char buf[96];
+
+    if (event.event_type == DRAM_ACCESS) {
+        if (!dram_header_written) {
+            out += "cycle,warp,type,beats,groups,dest,addr\n";
+            dram_header_written = true;
+        }
+        int n = snprintf(buf, sizeof(buf), "%" PRIu64 ",%" PRIu64 ",%c,%d,%d,%s,0x%" PRIx64 "\n",
+                         event.cycle, event.warp_id, event.access_type, event.beats,
+                         event.groups, event.is_sram ? "SRAM" : "DRAM", event.pc);
+        out.append(buf, n);
+        return;
+    }
+
+    int n = snprintf(buf, sizeof(buf), "%" PRIu64 ",0x%08" PRIx64 ",%" PRIu64 ",%d,%d\n",
+                     event.cycle, event.pc, event.warp_id, event.lane_id,
+                     static_cast<int>(event.event_type));
+    out.append(buf, n);
+
+    if (event.event_type == MEM_REQ_ISSUE || event.event_type == DRAM_REQ_ISSUE) {
+        for (uint64_t addr : event.addrs) {
+            n = snprintf(buf, sizeof(buf), "0x%08" PRIx64 ",", addr);
+            out.append(buf, n);
+        }
+        out += '\n';
+    }
+}
+
+Tracer::Tracer(std::string file_name, TraceFormat format, TraceComparator *comparator)
+    : format(format), comparator(comparator) {
+    if (!file_name.empty()) {
+        file.open(file_name, format == TRACE_CSV ? std::ios::out : std::ios::binary);
+    }
+    if (file.is_open() && format == TRACE_BINARY) {
+        TraceFileHeader header;
+        memcpy(header.magic, TRACE_BINARY_MAGIC, sizeof(header.magic));
+        header.version = TRACE_BINARY_VERSION;
+        header.record_size = sizeof(TraceRecord);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    } else if (file.is_open() && format == TRACE_COMPACT) {
+        compact = std::make_unique<CompactTraceWriter>(file);
+    }
+    writer = std::thread(&Tracer::writer_loop, this);
+}
+
+Tracer::~Tracer() {
+    stopping.store(true, std::memory_order_release);
+    if (writer.joinable()) {
+        writer.join();
+    }
+    file.close();
+}
+
+void Tracer::push(const TraceRecord &record) {
+    // Back-pressure rather than drop: the writer thread will catch up
+    while (!ring.try_push(record)) {
+        std::this_thread::yield();
+    }
+}
+
+void Tracer::trace_event(const TraceEvent &event) {
+    bool has_addrs = event.event_type == MEM_REQ_ISSUE || event.event_type == DRAM_REQ_ISSUE;
+    size_t addr_count = has_addrs ? std::min<size_t>(event.addrs.size(), UINT16_MAX) : 0;
+
+    push(pack_event(event, addr_count));
+
+    for (size_t i = 0; i < addr_count; i += TraceRecord::ADDRS_PER_RECORD) {
+        TraceRecord payload = {};
+        size_t count = std::min(addr_count - i, TraceRecord::ADDRS_PER_RECORD);
+        for (size_t j = 0; j < count; j++) {
+            payload.addrs[j] = event.addrs[i + j];
+        }
+        push(payload);
+    }
+}
+
+void Tracer::writer_loop() {
+    std::vector<TraceRecord> batch(WRITE_BATCH);
+    TraceRecordAssembler assembler;
+    TraceCsvFormatter formatter;
+    TraceEvent event;
+    std::string text;
+
+    while (true) {
+        // Read the flag before draining so nothing pushed before the stop is missed
+        bool stop_requested = stopping.load(std::memory_order_acquire);
+        size_t count = ring.try_pop_batch(batch.data(), batch.size());
+
+        if (count > 0) {
+            bool write_records = file.is_open() && format == TRACE_BINARY;
+            if (write_records) {
+                file.write(reinterpret_cast<const char *>(batch.data()),
+                           count * sizeof(TraceRecord));
+            }
+            if (write_records && !comparator) {
+                continue;
+            }
+            for (size_t i = 0; i < count; i++) {
+                if (!assembler.consume(batch[i], event)) continue;
+                if (comparator) {
+                    comparator->add(event);
+                }
+                if (compact) {
+                    compact->add(event);
+                } else if (file.is_open() && format == TRACE_CSV) {
+                    formatter.format(event, text);
+                }
+            }
+            if (!text.empty()) {
+                file.write(text.data(), text.size());
+                text.clear();
+            }
+            continue;
+        }
+
+        if (stop_requested) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    if (compact) {
+        compact->finish();
+    }
+    if (comparator) {
+        comparator->finish();
+    }
+    file.flush();
+}
+
+static bool convert_binary_trace(std::ifstream &in, std::ofstream &out) {
+    TraceFileHeader header;
+    in.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!in || memcmp(header.magic, TRACE_BINARY_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != TRACE_BINARY_VERSION || header.record_size != sizeof(TraceRecord)) {
+        return false;
+    }
+
+    std::vector<TraceRecord> batch(4096);
+    TraceRecordAssembler assembler;
+    TraceCsvFormatter formatter;
+    TraceEvent event;
+    std::string text;
+    while (in) {
+        in.read(reinterpret_cast<char *>(batch.data()), batch.size() * sizeof(TraceRecord));
+        size_t count = in.gcount() / sizeof(TraceRecord);
+        for (size_t i = 0; i < count; i++) {
+            if (assembler.consume(batch[i], event)) {
+                formatter.format(event, text);
+            }
+        }
+        out.write(text.data(), text.size());
+        text.clear();
+    }
+    return true;
+}
+
+bool convert_trace_to_csv(const std::string &in_file,
+                          const std::string &out_file) {
+    CompactTraceReader compact_reader;
+    if (compact_reader.open(in_file)) {
+        std::ofstream out(out_file);
+        if (!out) return false;
+        TraceCsvFormatter formatter;
+        std::string text;
+        bool ok = compact_reader.read_all([&](const TraceEvent &event) {
+            formatter.format(event, text);
+            if (text.size() > (1 << 20)) {
+                out.write(text.data(), text.size());
+                text.clear();
+            }
+        });
+        out.write(text.data(), text.size());
+        return ok;
+    }
+
+    std::ifstream in(in_file, std::ios::binary);
+    if (!in) return false;
+    std::ofstream out(out_file);
+    if (!out) return false;
+    return convert_binary_trace(in, out);
+}
@@ -4,8 +4,11 @@
 #include <string>
 #include <fstream>
 #include <iostream>
-#include <iomanip>
+#include <atomic>
+#include <memory>
+#include <thread>
 #include <cstdint>
+#include "trace/ring_buffer.hpp"
 
 enum EventType {
     MEM_REQ_ISSUE,
@@ -14,6 +17,7 @@ enum EventType {
     WARP_RETRY,
     WARP_SUSPEND,
     WARP_RESUME,
+    DRAM_ACCESS,  // One --dram-trace-file row (request leaving the CU pipeline)
 };
 
 struct TraceEvent {
@@ -25,32 +29,118 @@ struct TraceEvent {
 
     std::vector<uint64_t> addrs;
 
-    TraceEvent() : lane_id(-1) {}
+    // DRAM_ACCESS only: the remaining --dram-trace-file columns.
+    // The beat address (addr >> DRAM_BEAT_LOG_BYTES) is carried in pc.
+    char access_type;
+    int beats;
+    int groups;
+    bool is_sram;
+
+    TraceEvent()
+        : cycle(0), pc(0), warp_id(0), lane_id(-1), event_type(INSTR_EXEC),
+          access_type(0), beats(0), groups(0), is_sram(false) {}
+};
+
+/*
+ * Fixed-size binary form of a TraceEvent. An event carrying addresses is
+ * followed by ceil(addr_count / ADDRS_PER_RECORD) continuation records
+ * whose payload is just the raw addresses.
+ */
+union TraceRecord {
+    static constexpr size_t ADDRS_PER_RECORD = 4;
+
+    struct {
+        uint64_t cycle;
+        uint64_t pc;
+        uint32_t warp_id;
+        int32_t lane_id;
+        uint8_t event_type;
+        uint8_t access_type;
+        uint16_t addr_count;
+        uint16_t beats;
+        uint8_t groups;
+        uint8_t is_sram;
+    } event;
+    uint64_t addrs[ADDRS_PER_RECORD];
+};
+static_assert(sizeof(TraceRecord) == 32, "TraceRecord must stay 32 bytes");
+
+constexpr char TRACE_BINARY_MAGIC[8] = {'R', 'V', 'G', 'T', 'R', 'A', 'C', 'E'};
+constexpr uint32_t TRACE_BINARY_VERSION = 2;
+
+enum TraceFormat {
+    TRACE_CSV,
+    TRACE_BINARY,
+    TRACE_COMPACT,
+};
+
+/*
+ * Rebuilds TraceEvents from a stream of TraceRecords (header record plus
+ * any address continuation records)
+ */
+class TraceRecordAssembler {
+public:
+    /*
+     * Returns true once record completes an event, which is left in event
+     */
+    bool consume(const TraceRecord &record, TraceEvent &event);
+
+private:
+    TraceEvent pending;
+    size_t addrs_remaining = 0;
 };
 
+/*
+ * Formats events as the CSV lines the tracer has always produced (and
+ * that python_utils/compare_traces.py parses). DRAM_ACCESS events use the
+ * --dram-trace-file columns, preceded by its header line.
+ */
+class TraceCsvFormatter {
+public:
+    void format(const TraceEvent &event, std::string &out);
+
+private:
+    bool dram_header_written = false;
+};
+
+class CompactTraceWriter;
+class TraceComparator;
+
+/*
+ * Asynchronous event tracer. The simulator thread packs each event into
+ * fixed-size records on a lock-free ring buffer and a background thread
+ * batches them to disk, as CSV, raw records or the compact block format.
+ *
+ * With a comparator the writer thread also streams every event against a
+ * reference trace; an empty file_name then skips writing our own trace.
+ */
 class Tracer {
 public:
-    Tracer(std::string file_name) {
-        file.open(file_name);
-    }
-
-    ~Tracer() {
-        file.close();
-    }
-
-    void trace_event(TraceEvent event) {
-        file << event.cycle << ","
-             << "0x" << std::hex << std::setfill('0') << std::setw(8) << event.pc << std::dec << ","
-             << event.warp_id << ","
-             << event.lane_id << ","
-             << static_cast<int>(event.event_type) << std::endl;
-        if (event.event_type == MEM_REQ_ISSUE || event.event_type == DRAM_REQ_ISSUE) {
-            for (uint64_t addr : event.addrs) {
-                file << "0x" << std::hex << std::setfill('0') << std::setw(8) << addr << std::dec << ",";
-            }
-            file << std::endl;
-        }
-    }
+    Tracer(std::string file_name, TraceFormat format = TRACE_CSV,
+           TraceComparator *comparator = nullptr);
+    ~Tracer();
+
+    void trace_event(const TraceEvent &event);
+
 private:
+    static constexpr size_t RING_CAPACITY = 1 << 16;
+    static constexpr size_t WRITE_BATCH = 4096;
+
+    void push(const TraceRecord &record);
+    void writer_loop();
+
     std::ofstream file;
-};
\ No newline at end of file
+    TraceFormat format;
+    std::unique_ptr<CompactTraceWriter> compact;
+    TraceComparator *comparator;
+    SpscRingBuffer<TraceRecord, RING_CAPACITY> ring;
+    std::atomic<bool> stopping{false};
+    std::thread writer;
+};
+
+/*
+ * Converts a binary or compact trace into the CSV format.
+ * Returns false if the input is missing or not a recognised trace.
+ */
+bool convert_trace_to_csv(const std::string &in_file,
+                          const std::string &out_file);
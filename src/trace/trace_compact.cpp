@@ -0,0 +1,301 @@
+#include "trace_compact.hpp"
+#include "trace/lz_codec.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+struct CompactFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+};
+
+struct CompactFileFooter {
+    uint64_t index_offset;
+    uint64_t block_count;
+    char magic[8];
+};
+
+void put_varint(uint64_t v, std::vector<uint8_t> &out) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v) | 0x80);
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+void put_signed(int64_t v, std::vector<uint8_t> &out) {
+    put_varint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63), out);
+}
+
+/*
+ * Bounds-checked cursor over one column; any overrun sets ok = false
+ */
+struct ColumnReader {
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    size_t pos = 0;
+    bool ok = true;
+
+    uint8_t byte() {
+        if (pos >= size) {
+            ok = false;
+            return 0;
+        }
+        return data[pos++];
+    }
+
+    uint64_t varint() {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b = byte();
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        ok = false;
+        return 0;
+    }
+
+    int64_t signed_varint() {
+        uint64_t v = varint();
+        return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+    }
+};
+
+bool has_addrs(EventType type) {
+    return type == MEM_REQ_ISSUE || type == DRAM_REQ_ISSUE;
+}
+
+}  // namespace
+
+void CompactDeltaState::reset() {
+    last_pc.clear();
+    last_addr.clear();
+    last_cycle = 0;
+    last_dram_addr = 0;
+}
+
+CompactTraceWriter::CompactTraceWriter(std::ostream &out) : out(out) {
+    CompactFileHeader header = {};
+    memcpy(header.magic, TRACE_COMPACT_MAGIC, sizeof(header.magic));
+    header.version = TRACE_COMPACT_VERSION;
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file_offset = sizeof(header);
+}
+
+void CompactTraceWriter::add(const TraceEvent &event) {
+    if (block_events == 0) {
+        block_min_cycle = event.cycle;
+        block_max_cycle = event.cycle;
+    }
+    block_min_cycle = std::min(block_min_cycle, event.cycle);
+    block_max_cycle = std::max(block_max_cycle, event.cycle);
+
+    put_varint(event.warp_id, columns[WARP]);
+    columns[TYPE].push_back(static_cast<uint8_t>(event.event_type));
+    put_signed(static_cast<int64_t>(event.cycle - state.last_cycle), columns[CYCLE]);
+    state.last_cycle = event.cycle;
+
+    if (event.event_type == DRAM_ACCESS) {
+        put_signed(static_cast<int64_t>(event.pc - state.last_dram_addr), columns[PC]);
+        state.last_dram_addr = event.pc;
+
+        columns[DRAM].push_back(static_cast<uint8_t>(event.access_type));
+        put_varint(static_cast<uint64_t>(event.beats), columns[DRAM]);
+        put_varint(static_cast<uint64_t>(event.groups), columns[DRAM]);
+        columns[DRAM].push_back(event.is_sram ? 1 : 0);
+    } else {
+        uint64_t &last_pc = state.last_pc[event.warp_id];
+        put_signed(static_cast<int64_t>(event.pc - last_pc), columns[PC]);
+        last_pc = event.pc;
+    }
+    put_signed(event.lane_id, columns[LANE]);
+
+    if (has_addrs(event.event_type)) {
+        put_varint(event.addrs.size(), columns[ADDR]);
+        if (!event.addrs.empty()) {
+            uint64_t &last_addr = state.last_addr[event.warp_id];
+            uint64_t prev = last_addr;
+            for (uint64_t addr : event.addrs) {
+                put_signed(static_cast<int64_t>(addr - prev), columns[ADDR]);
+                prev = addr;
+            }
+            last_addr = event.addrs.front();
+        }
+    }
+
+    if (++block_events == EVENTS_PER_BLOCK) {
+        flush_block();
+    }
+}
+
+void CompactTraceWriter::flush_block() {
+    if (block_events == 0) return;
+
+    raw.clear();
+    for (auto &column : columns) {
+        put_varint(column.size(), raw);
+    }
+    for (auto &column : columns) {
+        raw.insert(raw.end(), column.begin(), column.end());
+        column.clear();
+    }
+
+    packed.clear();
+    lz_compress(raw.data(), raw.size(), packed);
+    bool compressed = packed.size() < raw.size();
+    const std::vector<uint8_t> &payload = compressed ? packed : raw;
+
+    CompactBlockInfo info;
+    info.offset = file_offset;
+    info.min_cycle = block_min_cycle;
+    info.max_cycle = block_max_cycle;
+    info.event_count = block_events;
+    info.stored_size = static_cast<uint32_t>(payload.size());
+    info.raw_size = static_cast<uint32_t>(raw.size());
+    info.compressed = compressed ? 1 : 0;
+    index.push_back(info);
+
+    out.write(reinterpret_cast<const char *>(payload.data()), payload.size());
+    file_offset += payload.size();
+
+    block_events = 0;
+    state.reset();
+}
+
+void CompactTraceWriter::finish() {
+    if (finished) return;
+    finished = true;
+    flush_block();
+
+    CompactFileFooter footer;
+    footer.index_offset = file_offset;
+    footer.block_count = index.size();
+    memcpy(footer.magic, TRACE_COMPACT_MAGIC, sizeof(footer.magic));
+
+    out.write(reinterpret_cast<const char *>(index.data()),
+              index.size() * sizeof(CompactBlockInfo));
+    out.write(reinterpret_cast<const char *>(&footer), sizeof(footer));
+    out.flush();
+}
+
+bool CompactTraceReader::open(const std::string &file_name) {
+    file.open(file_name, std::ios::binary);
+    if (!file) return false;
+
+    CompactFileHeader header;
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!file || memcmp(header.magic, TRACE_COMPACT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != TRACE_COMPACT_VERSION) {
+        return false;
+    }
+
+    CompactFileFooter footer;
+    file.seekg(-static_cast<std::streamoff>(sizeof(footer)), std::ios::end);
+    std::streamoff footer_offset = file.tellg();
+    file.read(reinterpret_cast<char *>(&footer), sizeof(footer));
+    if (!file || memcmp(footer.magic, TRACE_COMPACT_MAGIC, sizeof(footer.magic)) != 0 ||
+        footer.index_offset + footer.block_count * sizeof(CompactBlockInfo) !=
+            static_cast<uint64_t>(footer_offset)) {
+        return false;
+    }
+
+    index.resize(footer.block_count);
+    file.seekg(footer.index_offset);
+    file.read(reinterpret_cast<char *>(index.data()), index.size() * sizeof(CompactBlockInfo));
+    return static_cast<bool>(file);
+}
+
+bool CompactTraceReader::read_window(uint64_t from_cycle, uint64_t to_cycle,
+                                     const std::function<void(const TraceEvent &)> &callback) {
+    for (const CompactBlockInfo &block : index) {
+        if (block.max_cycle < from_cycle || block.min_cycle > to_cycle) continue;
+        if (!decode_block(block, from_cycle, to_cycle, callback)) return false;
+    }
+    return true;
+}
+
+bool CompactTraceReader::decode_block(const CompactBlockInfo &block, uint64_t from_cycle,
+                                      uint64_t to_cycle,
+                                      const std::function<void(const TraceEvent &)> &callback) {
+    stored.resize(block.stored_size);
+    file.clear();
+    file.seekg(block.offset);
+    file.read(reinterpret_cast<char *>(stored.data()), stored.size());
+    if (!file) return false;
+
+    if (block.compressed) {
+        if (!lz_decompress(stored.data(), stored.size(), block.raw_size, raw)) return false;
+    } else {
+        raw.swap(stored);
+    }
+
+    // Column sizes, then the columns back to back
+    constexpr int NUM_COLUMNS = 7;
+    ColumnReader sizes{raw.data(), raw.size()};
+    uint64_t column_size[NUM_COLUMNS];
+    for (auto &size : column_size) {
+        size = sizes.varint();
+    }
+    if (!sizes.ok) return false;
+
+    ColumnReader cols[NUM_COLUMNS];
+    size_t pos = sizes.pos;
+    for (int i = 0; i < NUM_COLUMNS; i++) {
+        if (pos + column_size[i] > raw.size()) return false;
+        cols[i] = ColumnReader{raw.data() + pos, column_size[i]};
+        pos += column_size[i];
+    }
+    ColumnReader &warps = cols[0], &types = cols[1], &cycles = cols[2], &pcs = cols[3],
+                 &lanes = cols[4], &addrs = cols[5], &dram = cols[6];
+
+    CompactDeltaState state;
+    TraceEvent event;
+    for (uint32_t i = 0; i < block.event_count; i++) {
+        event.warp_id = warps.varint();
+        event.event_type = static_cast<EventType>(types.byte());
+        state.last_cycle += cycles.signed_varint();
+        event.cycle = state.last_cycle;
+
+        if (event.event_type == DRAM_ACCESS) {
+            state.last_dram_addr += pcs.signed_varint();
+            event.pc = state.last_dram_addr;
+            event.access_type = static_cast<char>(dram.byte());
+            event.beats = static_cast<int>(dram.varint());
+            event.groups = static_cast<int>(dram.varint());
+            event.is_sram = dram.byte() != 0;
+        } else {
+            uint64_t &last_pc = state.last_pc[event.warp_id];
+            last_pc += pcs.signed_varint();
+            event.pc = last_pc;
+            event.access_type = 0;
+            event.beats = 0;
+            event.groups = 0;
+            event.is_sram = false;
+        }
+        event.lane_id = static_cast<int>(lanes.signed_varint());
+
+        event.addrs.clear();
+        if (has_addrs(event.event_type)) {
+            uint64_t count = addrs.varint();
+            if (count > 0) {
+                uint64_t &last_addr = state.last_addr[event.warp_id];
+                uint64_t prev = last_addr;
+                for (uint64_t j = 0; j < count && addrs.ok; j++) {
+                    prev += addrs.signed_varint();
+                    event.addrs.push_back(prev);
+                }
+                if (!event.addrs.empty()) last_addr = event.addrs.front();
+            }
+        }
+
+        for (auto &col : cols) {
+            if (!col.ok) return false;
+        }
+        if (event.cycle >= from_cycle && event.cycle <= to_cycle) {
+            callback(event);
+        }
+    }
+    return true;
+}
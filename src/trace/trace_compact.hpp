@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "trace/trace.hpp"
+
+/*
+ * Compact trace format.
+ *
+ * Events are grouped into blocks of up to EVENTS_PER_BLOCK. Within a block
+ * each field lives in its own column (warp, type, cycle, pc, lane,
+ * addresses, DRAM columns) so that similar values sit next to each other:
+ * cycles are delta coded against the previous event, pcs and addresses
+ * against the previous value seen for the same warp, all as zigzag
+ * varints. The column bytes are then LZ compressed (stored raw when that
+ * does not help). Delta state is reset per block so every block decodes on
+ * its own.
+ *
+ * An index of {file offset, cycle range} per block is written at the end
+ * of the file, so a reader can seek straight to the blocks that overlap a
+ * cycle window instead of decoding the whole trace.
+ *
+ *   header | block 0 | block 1 | ... | index | footer
+ */
+constexpr char TRACE_COMPACT_MAGIC[8] = {'R', 'V', 'G', 'T', 'R', 'C', 'Z', '1'};
+constexpr uint32_t TRACE_COMPACT_VERSION = 1;
+
+struct CompactBlockInfo {
+    uint64_t offset;      // File offset of the block payload
+    uint64_t min_cycle;
+    uint64_t max_cycle;
+    uint32_t event_count;
+    uint32_t stored_size; // Bytes on disk
+    uint32_t raw_size;    // Bytes once decompressed
+    uint32_t compressed;  // 0 if the payload is stored raw
+};
+
+/*
+ * Per-block delta state shared by the encoder and decoder
+ */
+struct CompactDeltaState {
+    std::unordered_map<uint64_t, uint64_t> last_pc;
+    std::unordered_map<uint64_t, uint64_t> last_addr;
+    uint64_t last_cycle = 0;
+    uint64_t last_dram_addr = 0;
+
+    void reset();
+};
+
+class CompactTraceWriter {
+public:
+    static constexpr size_t EVENTS_PER_BLOCK = 1 << 15;
+
+    /*
+     * Writes the file header; out must be open in binary mode
+     */
+    explicit CompactTraceWriter(std::ostream &out);
+
+    void add(const TraceEvent &event);
+
+    /*
+     * Flushes the last block and writes the index and footer
+     */
+    void finish();
+
+private:
+    enum Column { WARP, TYPE, CYCLE, PC, LANE, ADDR, DRAM, NUM_COLUMNS };
+
+    void flush_block();
+
+    std::ostream &out;
+    uint64_t file_offset = 0;
+    bool finished = false;
+
+    std::vector<uint8_t> columns[NUM_COLUMNS];
+    CompactDeltaState state;
+    uint32_t block_events = 0;
+    uint64_t block_min_cycle = 0;
+    uint64_t block_max_cycle = 0;
+
+    std::vector<uint8_t> raw;
+    std::vector<uint8_t> packed;
+    std::vector<CompactBlockInfo> index;
+};
+
+class CompactTraceReader {
+public:
+    /*
+     * Reads the footer and block index.
+     * Returns false if file is not a compact trace.
+     */
+    bool open(const std::string &file_name);
+
+    const std::vector<CompactBlockInfo> &blocks() const { return index; }
+
+    /*
+     * Decodes every event whose cycle lies in [from_cycle, to_cycle], in
+     * trace order, only touching blocks whose range overlaps the window
+     */
+    bool read_window(uint64_t from_cycle, uint64_t to_cycle,
+                     const std::function<void(const TraceEvent &)> &callback);
+
+    bool read_all(const std::function<void(const TraceEvent &)> &callback) {
+        return read_window(0, UINT64_MAX, callback);
+    }
+
+private:
+    bool decode_block(const CompactBlockInfo &block, uint64_t from_cycle, uint64_t to_cycle,
+                      const std::function<void(const TraceEvent &)> &callback);
+
+    std::ifstream file;
+    std::vector<CompactBlockInfo> index;
+    std::vector<uint8_t> stored;
+    std::vector<uint8_t> raw;
+};
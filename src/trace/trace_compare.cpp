@@ -0,0 +1,163 @@
+#include "trace_compare.hpp"
+#include <cinttypes>
+#include <cstdio>
+
+static const char *event_name(EventType type) {
+    switch (type) {
+    case MEM_REQ_ISSUE: return "MEM_REQ_ISSUE";
+    case DRAM_REQ_ISSUE: return "DRAM_REQ_ISSUE";
+    case INSTR_EXEC: return "INSTR_EXEC";
+    case WARP_RETRY: return "WARP_RETRY";
+    case WARP_SUSPEND: return "WARP_SUSPEND";
+    case WARP_RESUME: return "WARP_RESUME";
+    case DRAM_ACCESS: return "DRAM_ACCESS";
+    }
+    return "UNKNOWN";
+}
+
+static void print_event(std::ostream &out, const char *label, const TraceEvent &event) {
+    char buf[128];
+    snprintf(buf, sizeof(buf), "    %-10s cycle=%" PRIu64 ", warp=%" PRIu64 ", PC=0x%08" PRIx64 ", %s\n",
+             label, event.cycle, event.warp_id, event.pc, event_name(event.event_type));
+    out << buf;
+}
+
+TraceComparator::TraceComparator(TraceCompareOptions options) : options(options) {}
+
+bool TraceComparator::open(const std::string &reference_file) {
+    reference_name = reference_file;
+    reference.open(reference_file);
+    return static_cast<bool>(reference);
+}
+
+bool TraceComparator::is_compared(const TraceEvent &event) const {
+    // Warp-level view: per-lane traces are represented by lane 0
+    if (event.lane_id > 0) return false;
+    return options.all_events || event.event_type == INSTR_EXEC;
+}
+
+bool TraceComparator::matches(const TraceEvent &ours, const TraceEvent &ref) const {
+    if (ours.event_type != ref.event_type || ours.warp_id != ref.warp_id || ours.pc != ref.pc) {
+        return false;
+    }
+    return !options.compare_cycles || ours.cycle == ref.cycle;
+}
+
+bool TraceComparator::next_reference(TraceEvent &event) {
+    while (std::getline(reference, line)) {
+        // SIMTight prefixes its trace lines with TRACE:
+        size_t start = line.find("TRACE:");
+        start = start == std::string::npos ? 0 : start + 6;
+
+        // Address lines and headers fail to parse all five fields
+        unsigned long long cycle, pc, warp_id;
+        int lane_id, event_type;
+        if (sscanf(line.c_str() + start, "%llu,%llx,%llu,%d,%d", &cycle, &pc, &warp_id,
+                   &lane_id, &event_type) != 5) {
+            continue;
+        }
+        event.cycle = cycle;
+        event.pc = pc;
+        event.warp_id = warp_id;
+        event.lane_id = lane_id;
+        event.event_type = static_cast<EventType>(event_type);
+        if (is_compared(event)) return true;
+    }
+    return false;
+}
+
+void TraceComparator::record_divergence(const TraceEvent *ours, const TraceEvent *ref) {
+    has_divergence = true;
+    if (ours) our_diverged = *ours;
+    if (ref) ref_diverged = *ref;
+
+    TraceEvent event;
+    while (!ref_ended && ref_after.size() < options.context) {
+        if (!next_reference(event)) break;
+        ref_after.push_back(event);
+    }
+    diverged_flag.store(true, std::memory_order_release);
+}
+
+void TraceComparator::add(const TraceEvent &event) {
+    if (!is_compared(event)) return;
+
+    if (has_divergence) {
+        if (our_after.size() < options.context) {
+            our_after.push_back(event);
+        }
+        return;
+    }
+
+    TraceEvent ref;
+    if (!next_reference(ref)) {
+        ref_ended = true;
+        record_divergence(&event, nullptr);
+        return;
+    }
+    if (!matches(event, ref)) {
+        record_divergence(&event, &ref);
+        return;
+    }
+
+    matched++;
+    history.push_back(event);
+    if (history.size() > options.context) {
+        history.pop_front();
+    }
+}
+
+void TraceComparator::finish() {
+    if (has_divergence) return;
+
+    TraceEvent ref;
+    if (next_reference(ref)) {
+        our_ended = true;
+        record_divergence(nullptr, &ref);
+    }
+}
+
+void TraceComparator::report(std::ostream &out) const {
+    out << "[Trace Comparison]" << std::endl;
+    out << "Reference: " << reference_name << std::endl;
+    out << "Matched events: " << matched << std::endl;
+
+    if (!has_divergence) {
+        out << "No divergence found" << std::endl;
+        return;
+    }
+
+    out << "First divergence at compared event #" << matched << ":" << std::endl;
+    if (our_ended) {
+        out << "    ours       (trace ended)" << std::endl;
+    } else {
+        print_event(out, "ours", our_diverged);
+    }
+    if (ref_ended) {
+        out << "    reference  (trace ended)" << std::endl;
+    } else {
+        print_event(out, "reference", ref_diverged);
+    }
+    if (!our_ended && !ref_ended) {
+        if (our_diverged.event_type != ref_diverged.event_type) out << "    -> Different event types" << std::endl;
+        if (our_diverged.warp_id != ref_diverged.warp_id) out << "    -> Different warps scheduled" << std::endl;
+        if (our_diverged.pc != ref_diverged.pc) out << "    -> Different PCs" << std::endl;
+        if (our_diverged.cycle != ref_diverged.cycle) {
+            out << "    -> Cycle offset " << static_cast<int64_t>(our_diverged.cycle - ref_diverged.cycle)
+                << std::endl;
+        }
+    }
+
+    out << "Preceding matched events:" << std::endl;
+    for (const TraceEvent &event : history) {
+        print_event(out, "", event);
+    }
+    out << "Following events (ours):" << std::endl;
+    for (const TraceEvent &event : our_after) {
+        print_event(out, "", event);
+    }
+    out << "Following events (reference):" << std::endl;
+    for (const TraceEvent &event : ref_after) {
+        print_event(out, "", event);
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "trace/trace.hpp"
+
+struct TraceCompareOptions {
+    bool all_events = false;      // Compare every warp-level event, not just INSTR_EXEC
+    bool compare_cycles = false;  // Also require the cycles to match
+    size_t context = 8;           // Events shown either side of the divergence
+};
+
+/*
+ * Streams instruction trace events against a reference CSV trace (ours or
+ * SIMTight's, with or without its TRACE: prefix) while the simulation
+ * runs, so the first divergence is found without writing our own trace.
+ *
+ * Like python_utils/compare_traces.py, both traces are reduced to
+ * warp-level events (lane 0 or -1) and compared in order on warp and pc.
+ * The reference is read lazily, so memory stays bounded by the context
+ * window regardless of trace length.
+ *
+ * add() and finish() are called from the tracer's writer thread;
+ * diverged() may be polled from the simulator thread.
+ */
+class TraceComparator {
+public:
+    explicit TraceComparator(TraceCompareOptions options = TraceCompareOptions());
+
+    /*
+     * Returns false if the reference cannot be opened
+     */
+    bool open(const std::string &reference_file);
+
+    void add(const TraceEvent &event);
+
+    /*
+     * Called once our trace has ended; a longer reference is a divergence
+     */
+    void finish();
+
+    bool diverged() const { return diverged_flag.load(std::memory_order_acquire); }
+    uint64_t matched_events() const { return matched; }
+
+    /*
+     * Only call once the owning tracer has shut down
+     */
+    void report(std::ostream &out) const;
+
+private:
+    bool is_compared(const TraceEvent &event) const;
+    bool matches(const TraceEvent &ours, const TraceEvent &ref) const;
+    bool next_reference(TraceEvent &event);
+    void record_divergence(const TraceEvent *ours, const TraceEvent *ref);
+
+    TraceCompareOptions options;
+    std::string reference_name;
+    std::ifstream reference;
+    std::string line;
+
+    uint64_t matched = 0;
+    std::deque<TraceEvent> history;  // Last matching events (ours)
+
+    bool has_divergence = false;
+    bool our_ended = false;
+    bool ref_ended = false;
+    TraceEvent our_diverged;
+    TraceEvent ref_diverged;
+    std::vector<TraceEvent> our_after;
+    std::vector<TraceEvent> ref_after;
+
+    std::atomic<bool> diverged_flag{false};
+};
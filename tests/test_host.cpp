@@ -5,6 +5,7 @@
 #include <cassert>
 #include <iostream>
 #include <memory>
+#include <set>
 
 void test_host_register_file() {
   std::cout << "Running test_host_register_file..." << std::endl;
@@ -30,6 +31,55 @@ void test_host_register_file() {
   std::cout << "test_host_register_file passed!" << std::endl;
 }
 
+void test_register_shapes() {
+  std::cout << "Running test_register_shapes..." << std::endl;
+  RegisterFile rf(32, 4);
+
+  // A fresh register and x0 are uniform zero
+  assert(rf.get_shape(0, llvm::RISCV::X5).tag == REG_UNIFORM);
+  assert(rf.get_shape(0, llvm::RISCV::X0).tag == REG_UNIFORM);
+
+  for (int t = 0; t < 4; t++) {
+    rf.set_register(0, t, llvm::RISCV::X1, 7);
+    rf.set_register(0, t, llvm::RISCV::X2, 0x1000 + 4 * t);
+    rf.set_register(0, t, llvm::RISCV::X3, t == 2 ? 1 : 0);
+    rf.set_register(0, t, llvm::RISCV::X4, 2 - t);
+  }
+  RegisterShape uniform = rf.get_shape(0, llvm::RISCV::X1);
+  assert(uniform.tag == REG_UNIFORM && uniform.base == 7);
+  RegisterShape affine = rf.get_shape(0, llvm::RISCV::X2);
+  assert(affine.tag == REG_AFFINE && affine.base == 0x1000 && affine.stride == 4);
+  assert(rf.get_shape(0, llvm::RISCV::X3).tag == REG_VARYING);
+  // Negative strides wrap like the registers do
+  RegisterShape down = rf.get_shape(0, llvm::RISCV::X4);
+  assert(down.tag == REG_AFFINE && down.base == 2 && down.stride == -1);
+
+  // Shapes are per warp
+  assert(rf.get_shape(1, llvm::RISCV::X2).tag == REG_UNIFORM);
+
+  // Only the varying register is stored per lane
+  assert(rf.stored_words() == 29 * 1 + 2 * 2 + 4 + 32);
+  assert(rf.full_words() == 2 * 32 * 4);
+
+  // A write to some lanes expands a compressed register, a full write compresses it again
+  rf.set_register(0, 1, llvm::RISCV::X1, 8);
+  assert(rf.warp_id_to_registers[0][1].shape.tag == REG_VARYING);
+  assert(rf.get_register(0, 0, llvm::RISCV::X1) == 7 && rf.get_register(0, 1, llvm::RISCV::X1) == 8);
+  for (int t = 0; t < 4; t++) {
+    rf.set_register(0, t, llvm::RISCV::X1, 3 * t);
+  }
+  assert(rf.warp_id_to_registers[0][1].shape.tag == REG_AFFINE);
+  assert(rf.get_register(0, 3, llvm::RISCV::X1) == 9);
+
+  // A divergent write that ends up uniform is compressed when classified
+  rf.set_register(0, 1, llvm::RISCV::X3, 0);
+  rf.set_register(0, 2, llvm::RISCV::X3, 0);
+  assert(rf.warp_id_to_registers[0][3].shape.tag == REG_VARYING);
+  assert(rf.get_shape(0, llvm::RISCV::X3).tag == REG_UNIFORM);
+
+  std::cout << "test_register_shapes passed!" << std::endl;
+}
+
 void test_host_gpu_control() {
   std::cout << "Running test_host_gpu_control..." << std::endl;
   HostGPUControl ctrl;
@@ -57,3 +107,113 @@ void test_host_gpu_control() {
 
   std::cout << "test_host_gpu_control passed!" << std::endl;
 }
+
+// Issues every warp the scheduler holds once and retires it
+static std::set<Warp *> retire_kernel(HostGPUControl &ctrl, WarpScheduler &scheduler,
+                                      PipelineLatch &output, uint64_t pc) {
+  std::set<Warp *> warps;
+  for (int cycle = 0; cycle < 1000 && scheduler.is_active(); cycle++) {
+    scheduler.execute();
+    if (output.updated) {
+      assert(output.warp->pc[0] == pc && !output.warp->finished[0]);
+      std::fill(output.warp->finished.begin(), output.warp->finished.end(), true);
+      if (ctrl.is_dispatching_blocks()) {
+        ctrl.warp_terminated(output.warp);
+      }
+      warps.insert(output.warp);
+      output.updated = false;
+    }
+  }
+  assert(!scheduler.is_active());
+  return warps;
+}
+
+void test_launch_queue() {
+  std::cout << "Running test_launch_queue..." << std::endl;
+  Config::instance().setLaunchQueue(1);
+  HostGPUControl ctrl;
+  auto scheduler = std::make_shared<WarpScheduler>(NUM_LANES, NUM_WARPS, 0x0, nullptr, false);
+  PipelineLatch input, output;
+  output.updated = false;
+  scheduler->set_latches(&input, &output);
+  scheduler->set_debug(false);
+  ctrl.set_scheduler(scheduler);
+
+  ctrl.set_arg_ptr(0x8000);
+  ctrl.set_pc(0x1000);
+  ctrl.launch_kernel();
+  assert(ctrl.is_gpu_active() && ctrl.can_put());
+
+  // The next launch waits in the queue, which is then full
+  ctrl.set_arg_ptr(0x9000);
+  ctrl.set_pc(0x2000);
+  bool taken = ctrl.launch_kernel();
+  assert(taken);
+  assert(ctrl.queued_launches() == 1 && !ctrl.can_put());
+  assert(ctrl.get_arg_ptr() == 0x8000);
+
+  // A launch past the depth is refused and leaves the queue as it was
+  ctrl.set_pc(0x3000);
+  taken = ctrl.launch_kernel();
+  assert(!taken);
+  assert(ctrl.queued_launches() == 1);
+  ctrl.tick();
+  assert(ctrl.has_queued_launches());
+
+  std::set<Warp *> first = retire_kernel(ctrl, *scheduler, output, 0x1000);
+  assert(first.size() == NUM_WARPS);
+
+  // It starts once the last warp has retired, on the same warp objects
+  ctrl.tick();
+  assert(!ctrl.has_queued_launches() && ctrl.is_gpu_active() && ctrl.can_put());
+  assert(ctrl.get_arg_ptr() == 0x9000);
+  std::set<Warp *> second = retire_kernel(ctrl, *scheduler, output, 0x2000);
+  assert(second == first);
+
+  ctrl.tick();
+  assert(!ctrl.is_gpu_active());
+
+  Config::instance().setLaunchQueue(0);
+  std::cout << "test_launch_queue passed!" << std::endl;
+}
+
+void test_block_dispatch() {
+  std::cout << "Running test_block_dispatch..." << std::endl;
+  HostGPUControl ctrl;
+  auto scheduler = std::make_shared<WarpScheduler>(NUM_LANES, NUM_WARPS, 0x0, nullptr, false);
+  PipelineLatch input, output;
+  output.updated = false;
+  scheduler->set_latches(&input, &output);
+  scheduler->set_debug(false);
+  ctrl.set_scheduler(scheduler);
+
+  // A 3x2 grid of 16-warp blocks: four slots, then two more blocks
+  ctrl.set_pc(0x1000);
+  ctrl.set_warps_per_block(16);
+  ctrl.set_dims((2 << 16) | 3);
+  ctrl.launch_kernel();
+  assert(ctrl.is_dispatching_blocks());
+  assert(ctrl.get_block_index(0) == 0 && ctrl.get_block_index(31) == 1);
+  assert(ctrl.get_block_index(48) == ((1 << 16) | 0));
+
+  std::set<Warp *> first = retire_kernel(ctrl, *scheduler, output, 0x1000);
+  assert(first.size() == NUM_WARPS);
+  assert(ctrl.is_gpu_active() && !scheduler->is_active());
+
+  // The first two slots to finish get the last blocks after the dispatch latency
+  for (size_t i = 0; i < BlockDispatcher::DISPATCH_LATENCY; i++) {
+    ctrl.tick();
+  }
+  assert(scheduler->is_active());
+  assert(ctrl.get_block_index(0) == ((1 << 16) | 1) && ctrl.get_block_index(16) == ((1 << 16) | 2));
+  std::set<Warp *> last = retire_kernel(ctrl, *scheduler, output, 0x1000);
+  assert(last.size() == 32);
+  assert(!ctrl.is_gpu_active());
+
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+  assert(stats.get_blocks(BLOCK_DISPATCHED) == 6 && stats.get_blocks(BLOCK_SLOTS) == 4);
+  assert(stats.get_blocks(BLOCK_TAIL_CYCLES) > 0);
+  assert(stats.get_blocks(BLOCK_TAIL_CYCLES) <= stats.get_blocks(BLOCK_CYCLES));
+
+  std::cout << "test_block_dispatch passed!" << std::endl;
+}
@@ -1,4 +1,7 @@
 #pragma once
 
 void test_host_register_file();
+void test_register_shapes();
 void test_host_gpu_control();
+void test_launch_queue();
+void test_block_dispatch();
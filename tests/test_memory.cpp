@@ -1,12 +1,16 @@
 #include "test_memory.hpp"
 #include "config.hpp"
 #include "gpu/pipeline.hpp"
+#include "mem/dram_model.hpp"
+#include "mem/l1_cache.hpp"
 #include "mem/mem_coalesce.hpp"
 #include "mem/mem_data.hpp"
 #include "mem/mem_instr.hpp"
+#include "stats/stats.hpp"
 #include <cassert>
 #include <cstring>
 #include <iostream>
+#include <sstream>
 #include <vector>
 
 void test_data_memory_load_store() {
@@ -99,3 +103,377 @@ void test_coalesce_latency() {
 
   std::cout << "test_coalesce_latency passed!" << std::endl;
 }
+
+void test_l1_cache() {
+  std::cout << "Running test_l1_cache..." << std::endl;
+  L1CacheConfig config;
+  config.size_bytes = 256;  // 2 sets of 2 ways
+  config.ways = 2;
+  config.line_bytes = 64;
+  config.mshrs = 2;
+  config.write_policy = L1_WRITE_BACK;
+  assert(L1Cache::config_error(config).empty());
+  L1Cache cache(config);
+
+  size_t ready = 0;
+  assert(cache.lookup(0x1000, 0, &ready) == L1Cache::MISS);
+  assert(!cache.allocate(0x1000, 0, 50, false));
+  assert(cache.free_mshrs(0) == 1);
+  // Another lane of the same line while the fill is in flight
+  assert(cache.lookup(0x1020, 10, &ready) == L1Cache::MSHR_MERGE && ready == 50);
+  assert(cache.lookup(0x1000, 50, &ready) == L1Cache::HIT);
+  assert(ready == 50 + L1Cache::HIT_LATENCY);
+  assert(cache.free_mshrs(50) == 2);
+
+  // 0x1000, 0x1080 and 0x1100 map to set 0; 0x1080 is the LRU way
+  assert(!cache.allocate(0x1080, 60, 60, true));
+  assert(cache.lookup(0x1000, 61, &ready) == L1Cache::HIT);
+  assert(cache.allocate(0x1100, 62, 62, false));  // Evicts the dirty 0x1080
+  assert(cache.lookup(0x1080, 63, &ready) == L1Cache::MISS);
+  assert(cache.lookup(0x1000, 63, &ready) == L1Cache::HIT);
+
+  assert(cache.mark_dirty(0x1100));
+  bool present = false;
+  assert(cache.invalidate(0x1100, &present) && present);
+  assert(!cache.invalidate(0x1100, &present) && !present);
+
+  config.line_bytes = 48;
+  assert(!L1Cache::config_error(config).empty());
+
+  std::cout << "test_l1_cache passed!" << std::endl;
+}
+
+// Ticks until the warp can resume and returns the number of ticks
+static int ticks_until_resumed(CoalescingUnit &unit, Warp &w) {
+  int ticks = 0;
+  while (ticks < 500) {
+    unit.tick();
+    ticks++;
+    if (unit.get_resumable_warp_for_pipeline(w.is_cpu) == &w) {
+      break;
+    }
+  }
+  w.suspended = false;
+  return ticks;
+}
+
+void test_l1_cache_latency() {
+  std::cout << "Running test_l1_cache_latency..." << std::endl;
+  L1CacheConfig config;
+  config.size_bytes = 4096;
+  Config::instance().setL1Cache(config);
+  DataMemory dmem;
+  CoalescingUnit unit(&dmem);
+  Config::instance().setL1Cache(L1CacheConfig());
+  assert(unit.get_l1_cache() != nullptr);
+
+  Warp w(0, 32, 0x1000, false);
+  std::vector<uint64_t> addresses = {0x2000, 0x2004, 0x2008, 0x200C};
+  GPUStatisticsManager::instance().reset_l1();
+  uint64_t dram_before = GPUStatisticsManager::instance().get_gpu_dram_accs();
+
+  unit.load(&w, addresses, 4, 0, {0, 1, 2, 3});
+  int miss_ticks = ticks_until_resumed(unit, w);
+  uint64_t miss_dram = GPUStatisticsManager::instance().get_gpu_dram_accs() - dram_before;
+  unit.get_load_results(&w);
+
+  unit.load(&w, addresses, 4, 0, {0, 1, 2, 3});
+  int hit_ticks = ticks_until_resumed(unit, w);
+  unit.get_load_results(&w);
+
+  assert(miss_ticks >= static_cast<int>(SIM_DRAM_LATENCY));
+  assert(hit_ticks < static_cast<int>(SIM_DRAM_LATENCY));
+  assert(miss_dram == 1);
+  assert(GPUStatisticsManager::instance().get_gpu_dram_accs() - dram_before == 1);
+  assert(GPUStatisticsManager::instance().get_l1(L1_MISSES) == 1);
+  assert(GPUStatisticsManager::instance().get_l1(L1_HITS) == 1);
+
+  // A flushed line misses again
+  unit.flush_lines(&w, {0x2000}, {0});
+  assert(GPUStatisticsManager::instance().get_l1(L1_FLUSHES) == 1);
+  unit.load(&w, addresses, 4, 0, {0, 1, 2, 3});
+  assert(ticks_until_resumed(unit, w) >= static_cast<int>(SIM_DRAM_LATENCY));
+  unit.get_load_results(&w);
+  GPUStatisticsManager::instance().reset_l1();
+
+  std::cout << "test_l1_cache_latency passed!" << std::endl;
+}
+
+void test_banked_dram() {
+  std::cout << "Running test_banked_dram..." << std::endl;
+  DramConfig config;
+  config.model = DRAM_BANKED;
+  config.channels = 1;
+  config.banks = 2;
+  config.row_bytes = 256;  // 4 beats per row
+  assert(BankedDram::config_error(config).empty());
+  BankedDram dram(config);
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+  stats.reset_dram();
+  stats.set_gpu_pipeline_active(true);
+  const size_t base = BankedDram::CONTROLLER_LATENCY;
+
+  // Closed bank, then a row hit that only waits for the data bus
+  assert(dram.access({0x0}, 0, false) == base + config.t_rcd + config.t_cas + 1);
+  assert(dram.access({0x40}, 0, false) == base + config.t_rcd + config.t_cas + 2);
+  assert(stats.get_dram(DRAM_ROW_CLOSED) == 1 && stats.get_dram(DRAM_ROW_HITS) == 1);
+
+  // Row 1 lives in bank 1. 0x200 is row 2, bank 0 again: a conflict with
+  // the open row 0, while bank 1 is activated in parallel
+  size_t now = 100;
+  assert(dram.access({0x100}, now, false) == now + base + config.t_rcd + config.t_cas + 1);
+  assert(dram.access({0x200}, now, false) ==
+         now + base + config.t_rp + config.t_rcd + config.t_cas + 1);
+  assert(stats.get_dram(DRAM_ROW_CONFLICTS) == 1);
+
+  // A read right after a write waits for the turnaround
+  now = 200;
+  size_t write_done = dram.access({0x240}, now, true);
+  assert(dram.access({0x140}, now, false) >= write_done + config.t_wtr);
+  assert(stats.get_dram(DRAM_TURNAROUNDS) == 1);
+  assert(dram.drain_tick(now) >= write_done);
+  assert(stats.get_dram_bank_busy().size() == 2);
+
+  // A closed-page bank never hits
+  config.page_policy = DRAM_CLOSED_PAGE;
+  BankedDram closed(config);
+  stats.reset_dram();
+  closed.access({0x0, 0x40}, 0, false);
+  assert(stats.get_dram(DRAM_ROW_CLOSED) == 2 && stats.get_dram(DRAM_ROW_HITS) == 0);
+  stats.reset_dram();
+  stats.set_gpu_pipeline_active(false);
+
+  // The coalescer reports the beats it sends to DRAM
+  DataMemory dmem;
+  CoalescingUnit unit(&dmem);
+  std::vector<uint64_t> lane_addrs;
+  for (uint64_t lane = 0; lane < NUM_LANES; lane++) {
+    lane_addrs.push_back(0x1000 + 4 * lane);
+  }
+  std::vector<uint64_t> beat_addrs;
+  assert(unit.calculate_bursts(lane_addrs, 4, false, &beat_addrs) == 2);
+  assert((beat_addrs == std::vector<uint64_t>{0x1000, 0x1040}));
+
+  config.row_bytes = 100;
+  assert(!BankedDram::config_error(config).empty());
+
+  std::cout << "test_banked_dram passed!" << std::endl;
+}
+
+void test_load_scoreboard() {
+  std::cout << "Running test_load_scoreboard..." << std::endl;
+  Config::instance().setLoadScoreboard(2);
+  DataMemory dmem;
+  CoalescingUnit unit(&dmem);
+  Config::instance().setLoadScoreboard(0);
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+  stats.reset_scoreboard();
+  dmem.store(0x2000, 4, 42);
+  dmem.store(0x2004, 4, 43);
+
+  // Loads leave the warp running with rd pending
+  Warp w(0, 32, 0x1000, false);
+  unit.load(&w, {0x2000}, 4, 5, {0});
+  assert(!w.suspended && unit.outstanding_loads(&w) == 1);
+  assert(!unit.wait_for_scoreboard(&w, {6, 7}, false));
+  unit.load(&w, {0x2004}, 4, 6, {0});
+  assert(stats.get_scoreboard(SB_LOADS) == 2);
+
+  // A third load finds the scoreboard full until one load is written back
+  assert(unit.wait_for_scoreboard(&w, {8}, true));
+  assert(w.suspended && stats.get_scoreboard(SB_FULL_STALLS) == 1);
+  std::map<unsigned int, int> written;
+  int ticks = 0;
+  while (written.size() < 2 && ticks++ < 500) {
+    unit.tick();
+    Warp *resumed = unit.get_resumable_warp_for_pipeline(false);
+    assert(resumed == nullptr || (resumed == &w && written.size() == 1));
+    if (auto done = unit.pop_completed_load(false)) {
+      written[done->rd_reg] = done->results.at(0);
+    }
+  }
+  assert(written[5] == 42 && written[6] == 43);
+  w.suspended = false;
+
+  // Reading a pending register waits for its load only
+  unit.load(&w, {0x2000}, 4, 5, {0});
+  assert(unit.wait_for_scoreboard(&w, {5, 9}, false));
+  assert(stats.get_scoreboard(SB_HAZARD_STALLS) == 1);
+  while (unit.outstanding_loads(&w) > 0) {
+    unit.tick();
+    assert(unit.get_resumable_warp_for_pipeline(false) == nullptr);
+    unit.pop_completed_load(false);
+  }
+  unit.tick();
+  assert(unit.get_resumable_warp_for_pipeline(false) == &w);
+  assert(!unit.is_busy());
+  stats.reset_scoreboard();
+
+  std::cout << "test_load_scoreboard passed!" << std::endl;
+}
+
+void test_atomic_combining() {
+  std::cout << "Running test_atomic_combining..." << std::endl;
+  Config::instance().setAtomicCombining(true);
+  DataMemory dmem;
+  CoalescingUnit unit(&dmem);
+  Config::instance().setAtomicCombining(false);
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+  stats.reset_atomics();
+  dmem.store(0x2000, 4, 10);
+  dmem.store(0x2004, 4, 5);
+
+  // Three lanes add to one word, one lane to another: two read-modify-writes
+  Warp w(0, 32, 0x1000, false);
+  unit.atomic(&w, {0x2000, 0x2004, 0x2000, 0x2000}, 4, 5, AMO_ADD, {1, 2, 3, 4}, {0, 1, 2, 3});
+  ticks_until_resumed(unit, w);
+  auto [rd, old_values] = unit.get_load_results(&w);
+  assert(rd == 5);
+  // Each lane sees the value left by the lanes before it
+  assert(old_values.at(0) == 10 && old_values.at(2) == 11 && old_values.at(3) == 14);
+  assert(old_values.at(1) == 5);
+  assert(dmem.load(0x2000, 4) == 18 && dmem.load(0x2004, 4) == 7);
+  assert(stats.get_atomics(ATOMIC_WARP_INSTRS) == 1);
+  assert(stats.get_atomics(ATOMIC_LANE_OPS) == 4);
+  assert(stats.get_atomics(ATOMIC_RMWS) == 2);
+  assert(stats.get_atomics(ATOMIC_COMBINED) == 2);
+
+  // The other operations fold the same way
+  unit.atomic(&w, {0x2000, 0x2000}, 4, 5, AMO_MAX, {30, -1}, {0, 1});
+  ticks_until_resumed(unit, w);
+  old_values = unit.get_load_results(&w).second;
+  assert(old_values.at(0) == 18 && old_values.at(1) == 30);
+  unit.atomic(&w, {0x2000, 0x2000}, 4, 5, AMO_MINU, {-1, 7}, {0, 1});
+  ticks_until_resumed(unit, w);
+  assert(unit.get_load_results(&w).second.at(1) == 30);
+  assert(dmem.load(0x2000, 4) == 7);
+  stats.reset_atomics();
+
+  // Without combining every lane is its own read-modify-write
+  CoalescingUnit serial(&dmem);
+  serial.atomic(&w, {0x2004, 0x2004}, 4, 5, AMO_SWAP, {8, 9}, {0, 1});
+  ticks_until_resumed(serial, w);
+  old_values = serial.get_load_results(&w).second;
+  assert(old_values.at(0) == 7 && old_values.at(1) == 8);
+  assert(dmem.load(0x2004, 4) == 9);
+  assert(stats.get_atomics(ATOMIC_RMWS) == 2 && stats.get_atomics(ATOMIC_COMBINED) == 0);
+  stats.reset_atomics();
+
+  std::cout << "test_atomic_combining passed!" << std::endl;
+}
+
+void test_write_combining() {
+  std::cout << "Running test_write_combining..." << std::endl;
+  Config::instance().setWriteCombining(2);
+  DataMemory dmem;
+  CoalescingUnit unit(&dmem);
+  Config::instance().setWriteCombining(0);
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+  stats.reset_write_combining();
+  auto run = [&unit](int ticks) {
+    for (int i = 0; i < ticks; i++) {
+      unit.tick();
+    }
+  };
+
+  // Two stores of half a beat each fill it, and it is written out whole
+  Warp w(0, 32, 0x1000, false);
+  std::vector<uint64_t> low, high;
+  for (uint64_t lane = 0; lane < 8; lane++) {
+    low.push_back(0x2000 + lane * 4);
+    high.push_back(0x2020 + lane * 4);
+  }
+  unit.store(&w, low, 4, std::vector<int>(8, 1), {0, 1, 2, 3, 4, 5, 6, 7});
+  unit.store(&w, high, 4, std::vector<int>(8, 2), {8, 9, 10, 11, 12, 13, 14, 15});
+  run(10);
+  assert(!unit.has_buffered_writes());
+  assert(stats.get_write_combining(WC_STORE_BEATS) == 2);
+  assert(stats.get_write_combining(WC_MERGES) == 1);
+  assert(stats.get_write_combining(WC_DRAM_BEATS) == 1);
+  assert(stats.get_write_combining(WC_FULL_BEATS) == 1);
+  assert(dmem.load(0x2020, 4) == 2);
+
+  // A third beat evicts the oldest entry, and a load of a buffered beat drains it
+  unit.store(&w, {0x3000}, 1, {1}, {0});
+  unit.store(&w, {0x4000}, 1, {1}, {0});
+  unit.store(&w, {0x5000}, 1, {1}, {0});
+  run(10);
+  assert(stats.get_write_combining(WC_EVICTIONS) == 1);
+  assert(stats.get_write_combining(WC_DRAM_BEATS) == 2);
+  unit.load(&w, {0x4001}, 1, 5, {0});
+  ticks_until_resumed(unit, w);
+  unit.get_load_results(&w);
+  assert(stats.get_write_combining(WC_DRAINS) >= 1);
+
+  // Entries left alone are written out once they time out
+  while (unit.is_busy()) {
+    unit.tick();
+  }
+  assert(!unit.has_buffered_writes());
+  assert(stats.get_write_combining(WC_DRAINS) == 2);
+  assert(stats.get_write_combining(WC_DRAM_BEATS) == 4);
+  stats.reset_write_combining();
+
+  std::cout << "test_write_combining passed!" << std::endl;
+}
+
+void test_sram_banks() {
+  std::cout << "Running test_sram_banks..." << std::endl;
+  // A warp reading one column of a 16-word-wide shared array
+  MemRequest req;
+  req.bytes = 4;
+  req.is_store = false;
+  req.is_atomic = false;
+  req.is_fence = false;
+  for (uint64_t lane = 0; lane < NUM_LANES; lane++) {
+    req.addrs.push_back(SIM_SHARED_SRAM_BASE + lane * 16 * 4);
+  }
+
+  DataMemory dmem;
+  CoalescingUnit word_unit(&dmem);
+  assert(word_unit.sram_bank(SIM_SHARED_SRAM_BASE + 17 * 4) == 1);
+  assert(word_unit.sram_conflict_degree(req) == static_cast<int>(NUM_LANES));
+  assert(word_unit.calculate_sram_bank_conflicts(req) == static_cast<int>(NUM_LANES));
+
+  // Swizzling puts every row on a different bank, padding the array gets the same
+  SramConfig config;
+  config.hash = SRAM_HASH_XOR;
+  Config::instance().setSram(config);
+  CoalescingUnit xor_unit(&dmem);
+  Config::instance().setSram(SramConfig());
+  assert(xor_unit.sram_conflict_degree(req) == static_cast<int>(NUM_LANES / 16));
+  MemRequest padded = req;
+  for (uint64_t lane = 0; lane < NUM_LANES; lane++) {
+    padded.addrs[lane] = SIM_SHARED_SRAM_BASE + lane * 17 * 4;
+  }
+  assert(word_unit.sram_conflict_degree(padded) == static_cast<int>(NUM_LANES / 16));
+
+  // A broadcast is one access, and still takes the minimum of two cycles
+  MemRequest broadcast = req;
+  std::fill(broadcast.addrs.begin(), broadcast.addrs.end(), SIM_SHARED_SRAM_BASE);
+  assert(word_unit.sram_conflict_degree(broadcast) == 1);
+  assert(word_unit.calculate_sram_bank_conflicts(broadcast) == 2);
+
+  config = SramConfig();
+  assert(CoalescingUnit::sram_config_error(config).empty());
+  config.banks = 12;
+  assert(!CoalescingUnit::sram_config_error(config).empty());
+  config.banks = 16;
+  config.queue_depth = 0;
+  assert(!CoalescingUnit::sram_config_error(config).empty());
+
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+  stats.reset_sram();
+  stats.record_sram_access(0x100, 1);
+  stats.record_sram_access(0x104, 32);
+  stats.record_sram_access(0x104, 32);
+  assert(stats.get_sram_conflict_degrees()[32] == 2);
+  assert(stats.get_sram_pc_conflict_degrees().at(0x104)[32] == 2);
+  std::ostringstream out;
+  stats.report_sram(out, nullptr);
+  assert(out.str().find("Conflict cycles            60") != std::string::npos);
+  assert(out.str().find("0x00000104          2         60  32:2") != std::string::npos);
+  stats.reset_sram();
+
+  std::cout << "test_sram_banks passed!" << std::endl;
+}
@@ -3,3 +3,10 @@
 void test_data_memory_load_store();
 void test_instr_memory();
 void test_coalesce_latency();
+void test_l1_cache();
+void test_l1_cache_latency();
+void test_banked_dram();
+void test_load_scoreboard();
+void test_atomic_combining();
+void test_write_combining();
+void test_sram_banks();
@@ -6,6 +6,7 @@
 #include "gpu/pipeline_instr_fetch.hpp"
 #include "gpu/pipeline_op_fetch.hpp"
 #include "gpu/pipeline_writeback.hpp"
+#include "gpu/reconvergence.hpp"
 #include "mem/mem_coalesce.hpp"
 #include "mem/mem_data.hpp"
 #include "mem/mem_instr.hpp"
@@ -156,3 +157,53 @@ void test_writeback_latch() {
 
   std::cout << "test_writeback_latch passed!" << std::endl;
 }
+
+void test_ipdom_reconvergence() {
+  std::cout << "Running test_ipdom_reconvergence..." << std::endl;
+
+  // 0x1000: beq x1, x2, 0x100c
+  // 0x1004: addi x3, x0, 1
+  // 0x1008: j 0x1010
+  // 0x100c: addi x3, x0, 2
+  // 0x1010: addi x4, x0, 3
+  // 0x1014: ret
+  parse_output p;
+  p.base_addr = 0x1000;
+  p.max_addr = 0x1018;
+  p.code = {0x63, 0x86, 0x20, 0x00, 0x93, 0x01, 0x10, 0x00, 0x6F, 0x00, 0x80, 0x00,
+            0x93, 0x01, 0x20, 0x00, 0x13, 0x02, 0x30, 0x00, 0x67, 0x80, 0x00, 0x00};
+  InstructionMemory im(&p);
+  LLVMDisassembler disasm("riscv64-unknown-elf", "generic-rv64", "+m,+a,+zfinx");
+  ReconvergenceTable table(&im, &disasm);
+
+  assert(table.get_block_count() == 4);
+  assert(table.get_reconvergence_pc(0x1000) == 0x1010);
+  assert(table.get_reconvergence_pc(0x1004) == 0x1008);
+  assert(table.get_reconvergence_pc(0x1014) == ReconvergenceTable::NO_RECONVERGENCE);
+
+  // Lanes 0-1 fall through, lanes 2-3 take the branch
+  Warp warp(0, 4, 0x1000, false);
+  assert(table.select_lanes(&warp) == 0b1111);
+  warp.pc = {0x1004, 0x1004, 0x100c, 0x100c};
+  table.diverge(&warp, 0x1000, {0, 1, 2, 3});
+  assert(warp.reconvergence_stack.size() == 2);
+  assert(table.select_lanes(&warp) == 0b0011);
+
+  warp.pc[0] = warp.pc[1] = 0x1010;
+  assert(table.select_lanes(&warp) == 0b1100);
+  warp.pc[2] = 0x1010;
+  warp.finished[3] = true;
+  assert(table.select_lanes(&warp) == 0b1111);
+  assert(warp.reconvergence_stack.empty());
+
+  // A loop: 0 -> 1, 1 -> {1, 2}, 2 -> exit; lanes leaving early wait at 2
+  std::vector<uint64_t> rpcs = ReconvergenceTable::compute(0x2000, {{1}, {1, 2}, {-1}});
+  assert(rpcs[1] == 0x2008);
+  assert(rpcs[0] == 0x2004);
+
+  // A branch that never reaches the exit has no reconvergence point
+  rpcs = ReconvergenceTable::compute(0x2000, {{1, 2}, {1}, {2}});
+  assert(rpcs[0] == ReconvergenceTable::NO_RECONVERGENCE);
+
+  std::cout << "test_ipdom_reconvergence passed!" << std::endl;
+}
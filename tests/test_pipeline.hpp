@@ -4,3 +4,4 @@ void test_instr_fetch_latch();
 void test_ats_latch();
 void test_op_fetch_latch();
 void test_writeback_latch();
+void test_ipdom_reconvergence();
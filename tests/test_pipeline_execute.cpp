@@ -5,7 +5,9 @@
 #include "gpu/register_file.hpp"
 #include "mem/mem_coalesce.hpp"
 #include "mem/mem_data.hpp"
+#include <bit>
 #include <cassert>
+#include <cmath>
 #include <iostream>
 #include <vector>
 
@@ -485,3 +487,144 @@ void test_execution_unit() {
 
   std::cout << "test_execution_unit passed!" << std::endl;
 }
+
+void test_fpu_execution() {
+  std::cout << "Running test_fpu_execution..." << std::endl;
+  DataMemory dm;
+  CoalescingUnit cu(&dm);
+  RegisterFile rf(32, 32);
+  LLVMDisassembler disasm("riscv32", "generic-rv32", "+m,+zfinx");
+  ExecutionUnit eu(&cu, &rf, &disasm, nullptr);
+  constexpr uint32_t OP_FP = 0x53;
+  constexpr uint32_t OP_MADD = 0x43;
+
+  auto decode = [&](uint32_t word) {
+    std::vector<uint8_t> bytes = {static_cast<uint8_t>(word), static_cast<uint8_t>(word >> 8),
+                                  static_cast<uint8_t>(word >> 16), static_cast<uint8_t>(word >> 24)};
+    return disasm.disasm_inst(0, bytes);
+  };
+  auto bits = [](float f) { return static_cast<int>(std::bit_cast<uint32_t>(f)); };
+  auto value = [](int reg) { return std::bit_cast<float>(static_cast<uint32_t>(reg)); };
+
+  Warp warp(0, 32, 0x1000, false);
+  std::vector<size_t> lanes = {0, 1};
+  rf.set_register(0, 0, llvm::RISCV::X1, bits(1.5f));
+  rf.set_register(0, 1, llvm::RISCV::X1, bits(-2.0f));
+  rf.set_register(0, 0, llvm::RISCV::X2, bits(2.0f));
+  rf.set_register(0, 1, llvm::RISCV::X2, bits(0.25f));
+  rf.set_register(0, 0, llvm::RISCV::X3, bits(0.5f));
+  rf.set_register(0, 1, llvm::RISCV::X3, bits(1.0f));
+
+  // The result is written back by the FPU after its latency, like MUL
+  auto run = [&](uint32_t word) {
+    llvm::MCInst inst = decode(word);
+    execute_result res = eu.execute(&warp, lanes, inst);
+    assert(res.success && !res.write_required && warp.suspended);
+    complete_load_operation(cu, rf, &warp);
+  };
+
+  run(encode_r_type(0x00, 2, 1, 7, 4, OP_FP));  // FADD.S x4, x1, x2
+  assert(value(rf.get_register(0, 0, llvm::RISCV::X4)) == 3.5f);
+  assert(value(rf.get_register(0, 1, llvm::RISCV::X4)) == -1.75f);
+
+  // FMADD.S x4, x1, x2, x3
+  run((3u << 27) | encode_r_type(0x00, 2, 1, 7, 4, OP_MADD));
+  assert(value(rf.get_register(0, 0, llvm::RISCV::X4)) == 3.5f);
+  assert(value(rf.get_register(0, 1, llvm::RISCV::X4)) == 0.5f);
+
+  run(encode_r_type(0x50, 2, 1, 1, 4, OP_FP));  // FLT.S x4, x1, x2
+  assert(rf.get_register(0, 0, llvm::RISCV::X4) == 1);
+  assert(rf.get_register(0, 1, llvm::RISCV::X4) == 1);
+
+  run(encode_r_type(0x60, 0, 1, 1, 4, OP_FP));  // FCVT.W.S x4, x1, rtz
+  assert(rf.get_register(0, 0, llvm::RISCV::X4) == 1);
+  assert(rf.get_register(0, 1, llvm::RISCV::X4) == -2);
+
+  run(encode_r_type(0x0C, 0, 1, 7, 4, OP_FP));  // FDIV.S x4, x1, x0
+  assert(std::isinf(value(rf.get_register(0, 0, llvm::RISCV::X4))));
+
+  // 0/0 is the canonical NaN; FMIN returns the other operand
+  run(encode_r_type(0x0C, 0, 0, 7, 5, OP_FP));  // FDIV.S x5, x0, x0
+  assert(static_cast<uint32_t>(rf.get_register(0, 0, llvm::RISCV::X5)) == 0x7FC00000);
+  run(encode_r_type(0x14, 5, 1, 0, 4, OP_FP));  // FMIN.S x4, x1, x5
+  assert(value(rf.get_register(0, 0, llvm::RISCV::X4)) == 1.5f);
+
+  // FDIV holds the iterative unit until it is written back
+  llvm::MCInst fdiv = decode(encode_r_type(0x0C, 2, 1, 7, 4, OP_FP));
+  Warp other(1, 32, 0x1000, false);
+  eu.execute(&warp, lanes, fdiv);
+  assert(!cu.can_use_fp_divider());
+  execute_result res = eu.execute(&other, lanes, fdiv);
+  assert(!res.success && eu.get_retry_reason() == STALL_FPU_BUSY);
+  complete_load_operation(cu, rf, &warp);
+  assert(cu.can_use_fp_divider());
+  assert(value(rf.get_register(0, 1, llvm::RISCV::X4)) == -8.0f);
+
+  std::cout << "test_fpu_execution passed!" << std::endl;
+}
+
+void test_bitmanip_execution() {
+  std::cout << "Running test_bitmanip_execution..." << std::endl;
+  DataMemory dm;
+  CoalescingUnit cu(&dm);
+  RegisterFile rf(32, 32);
+  LLVMDisassembler disasm("riscv32", "generic-rv32", "+m,+zbb");
+  ExecutionUnit eu(&cu, &rf, &disasm, nullptr);
+
+  auto decode = [&](uint32_t word) {
+    std::vector<uint8_t> bytes = {static_cast<uint8_t>(word), static_cast<uint8_t>(word >> 8),
+                                  static_cast<uint8_t>(word >> 16), static_cast<uint8_t>(word >> 24)};
+    return disasm.disasm_inst(0, bytes);
+  };
+  Warp warp(0, 32, 0x1000, false);
+  std::vector<size_t> lanes = {0, 1};
+  rf.set_register(0, 0, llvm::RISCV::X1, 0x00F0);
+  rf.set_register(0, 1, llvm::RISCV::X1, -8);
+  rf.set_register(0, 0, llvm::RISCV::X2, 4);
+  rf.set_register(0, 1, llvm::RISCV::X2, 3);
+
+  // Zbb ops complete in the ALU like ADD
+  auto run = [&](uint32_t word) {
+    llvm::MCInst inst = decode(word);
+    execute_result res = eu.execute(&warp, lanes, inst);
+    assert(res.success && res.write_required && !warp.suspended);
+  };
+  auto lane = [&](int thread) { return rf.get_register(0, thread, llvm::RISCV::X3); };
+
+  run(encode_i_type(0x600, 1, 1, 3, OP_OP_IMM));  // CLZ x3, x1
+  assert(lane(0) == 24 && lane(1) == 0);
+  run(encode_i_type(0x601, 1, 1, 3, OP_OP_IMM));  // CTZ x3, x1
+  assert(lane(0) == 4 && lane(1) == 3);
+  run(encode_i_type(0x602, 1, 1, 3, OP_OP_IMM));  // CPOP x3, x1
+  assert(lane(0) == 4 && lane(1) == 29);
+  run(encode_r_type(0x05, 2, 1, 4, 3, OP_OP));    // MIN x3, x1, x2
+  assert(lane(0) == 4 && lane(1) == -8);
+  run(encode_r_type(0x05, 2, 1, 7, 3, OP_OP));    // MAXU x3, x1, x2
+  assert(lane(0) == 0xF0 && lane(1) == -8);
+  run(encode_r_type(0x20, 2, 1, 7, 3, OP_OP));    // ANDN x3, x1, x2
+  assert(lane(0) == 0xF0 && lane(1) == -8);
+  run(encode_r_type(0x30, 2, 1, 1, 3, OP_OP));    // ROL x3, x1, x2
+  assert(lane(0) == 0xF00 && lane(1) == -57);
+  run(encode_i_type(0x604, 1, 5, 3, OP_OP_IMM));  // RORI x3, x1, 4
+  assert(lane(0) == 0xF && static_cast<uint32_t>(lane(1)) == 0x8FFFFFFF);
+
+  // The MULH family goes through the multiplier like MUL
+  auto run_mul = [&](uint32_t word) {
+    llvm::MCInst inst = decode(word);
+    execute_result res = eu.execute(&warp, lanes, inst);
+    assert(res.success && warp.suspended);
+    complete_load_operation(cu, rf, &warp);
+  };
+  rf.set_register(0, 0, llvm::RISCV::X1, -2);
+  rf.set_register(0, 0, llvm::RISCV::X2, 3);
+  run_mul(encode_r_type(0x01, 2, 1, 1, 3, OP_OP));  // MULH: -6 >> 32
+  assert(lane(0) == -1);
+  run_mul(encode_r_type(0x01, 2, 1, 3, 3, OP_OP));  // MULHU: (2^32 - 2) * 3 >> 32
+  assert(lane(0) == 2);
+  run_mul(encode_r_type(0x01, 1, 2, 2, 3, OP_OP));  // MULHSU x3, x2, x1: 3 * (2^32 - 2) >> 32
+  assert(lane(0) == 2);
+  run_mul(encode_r_type(0x01, 2, 1, 2, 3, OP_OP));  // MULHSU x3, x1, x2: -2 * 3 >> 32
+  assert(lane(0) == -1);
+
+  std::cout << "test_bitmanip_execution passed!" << std::endl;
+}
@@ -1,3 +1,5 @@
 #pragma once
 
 void test_execution_unit();
+void test_fpu_execution();
+void test_bitmanip_execution();
@@ -1,3 +1,5 @@
 #pragma once
 
 void test_warp_scheduler();
+void test_random_scheduler_seed();
+void test_warp_policies();
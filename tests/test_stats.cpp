@@ -0,0 +1,321 @@
+#include "test_stats.hpp"
+#include "stats/launch_report.hpp"
+#include "stats/profiler.hpp"
+#include "stats/self_profiler.hpp"
+#include "gpu/pipeline.hpp"
+#include "stats/stats_sampler.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+void test_pc_profiler() {
+  std::cout << "Running test_pc_profiler..." << std::endl;
+
+  PCProfiler &profiler = PCProfiler::instance();
+  const uint64_t base = 0x80000000;
+  profiler.enable(base, base + 0x3C);
+
+  // Cycle 1: warp 0 issues the load at base+4
+  profiler.record_issue(0, base + 4);
+  profiler.record_instr(base + 4);
+  profiler.record_dram_beats(base + 4, 3);
+  profiler.tick();
+
+  // Cycles 2-4: the load suspends warp 0 and nothing else can issue
+  profiler.record_stall(0, base + 4);
+  profiler.tick();
+  profiler.tick();
+  profiler.record_suspension_bubble(0);
+  profiler.tick();
+
+  // Cycle 5: warp 1 issues; its retried instruction is counted separately
+  profiler.record_issue(1, base + 8);
+  profiler.record_retry(base + 8);
+  profiler.record_sram_conflict_cycles(base + 8, 6);
+  profiler.tick();
+
+  // Warp 1 stalls later than warp 0, so warp 0 is still blamed
+  profiler.record_stall(1, base + 8);
+  profiler.tick();
+  assert(profiler.get_cycles(base + 4) == 5);
+  assert(profiler.get_cycles(base + 8) == 1);
+
+  // Once warp 0 issues again warp 1 is the oldest stall
+  profiler.record_issue(0, base + 12);
+  profiler.tick();
+  profiler.tick();
+  assert(profiler.get_cycles(base + 12) == 1);
+  assert(profiler.get_cycles(base + 8) == 2);
+
+  assert(profiler.get_instrs(base + 4) == 1);
+  assert(profiler.get_dram_beats(base + 4) == 3);
+  assert(profiler.get_suspension_bubbles(base + 4) == 1);
+  assert(profiler.get_retries(base + 8) == 1);
+  assert(profiler.get_sram_conflict_cycles(base + 8) == 6);
+
+  // PCs outside the instruction memory are ignored
+  profiler.record_instr(base + 0x40);
+  profiler.record_instr(base - 4);
+  assert(profiler.get_instrs(base + 0x40) == 0);
+
+  std::stringstream report;
+  profiler.report(report, [](uint64_t pc) { return "\tinsn\t" + std::to_string(pc); });
+  std::string text = report.str();
+  assert(text.find("# GPU hotspot profile: 8 cycles, 0 not attributable") == 0);
+  // Sorted by cycles, so the stalling load comes first
+  assert(text.find("0x80000004") < text.find("0x80000008"));
+  assert(text.find("0x80000008") < text.find("0x8000000c"));
+  assert(text.find("insn 2147483652") != std::string::npos);
+
+  profiler.disable();
+
+  std::cout << "test_pc_profiler passed!" << std::endl;
+}
+
+void test_stall_breakdown() {
+  std::cout << "Running test_stall_breakdown..." << std::endl;
+
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+  stats.reset_gpu_stalls();
+
+  // Cycle 1: warp 0 executes while warp 1 waits for issue
+  stats.set_warp_state(0, STALL_PIPELINE);
+  stats.set_warp_state(1, STALL_PIPELINE);
+  stats.set_execute_slot(0, STALL_NONE);
+  stats.tick_stall_breakdown();
+
+  // Cycle 2: warp 1 retries on a full CU queue
+  stats.set_warp_state(0, STALL_MEMORY);
+  stats.set_warp_state(1, STALL_PIPELINE);
+  stats.set_execute_slot(1, STALL_CU_QUEUE_FULL);
+  stats.tick_stall_breakdown();
+
+  // Cycles 3-4: empty slot, memory wait outranks the barrier
+  for (int i = 0; i < 2; i++) {
+    stats.set_warp_state(0, STALL_MEMORY);
+    stats.set_warp_state(1, STALL_BARRIER);
+    stats.tick_stall_breakdown();
+  }
+
+  // Cycle 5: empty slot with only a barrier wait
+  stats.set_warp_state(1, STALL_BARRIER);
+  stats.tick_stall_breakdown();
+
+  assert(stats.get_gpu_stalls(STALL_NONE) == 1);
+  assert(stats.get_gpu_stalls(STALL_CU_QUEUE_FULL) == 1);
+  assert(stats.get_gpu_stalls(STALL_MEMORY) == 2);
+  assert(stats.get_gpu_stalls(STALL_BARRIER) == 1);
+  assert(stats.get_gpu_stalls(STALL_PIPELINE) == 0);
+
+  assert(stats.get_gpu_warp_stalls(0, STALL_NONE) == 1);
+  assert(stats.get_gpu_warp_stalls(0, STALL_MEMORY) == 3);
+  assert(stats.get_gpu_warp_stalls(0, STALL_BARRIER) == 0);
+  assert(stats.get_gpu_warp_stalls(1, STALL_PIPELINE) == 1);
+  assert(stats.get_gpu_warp_stalls(1, STALL_CU_QUEUE_FULL) == 1);
+  assert(stats.get_gpu_warp_stalls(1, STALL_BARRIER) == 3);
+  assert(stats.get_gpu_warp_stalls(2, STALL_PIPELINE) == 0);
+
+  std::stringstream report;
+  stats.report_stall_breakdown(report);
+  assert(report.str().find("Total            5") != std::string::npos);
+  assert(report.str().find("\n1,0,0,0,3,0,0,0,1,0,1\n") != std::string::npos);
+
+  stats.reset_gpu_stalls();
+  assert(stats.get_gpu_stalls(STALL_MEMORY) == 0);
+
+  std::cout << "test_stall_breakdown passed!" << std::endl;
+}
+
+void test_active_lanes_histogram() {
+  std::cout << "Running test_active_lanes_histogram..." << std::endl;
+
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+  stats.reset_gpu_instrs();
+  stats.increment_gpu_instrs(NUM_LANES);
+  stats.increment_gpu_instrs(NUM_LANES / 2);
+  stats.increment_gpu_instrs(NUM_LANES / 2);
+
+  const auto &hist = stats.get_active_lanes_histogram();
+  assert(hist[NUM_LANES] == 1);
+  assert(hist[NUM_LANES / 2] == 2);
+  assert(hist[1] == 0);
+
+  std::ostringstream out;
+  stats.report_active_lanes(out);
+  assert(out.str().find("SIMT efficiency  66.67%") != std::string::npos);
+
+  stats.reset_gpu_instrs();
+  assert(stats.get_active_lanes_histogram()[NUM_LANES] == 0);
+
+  std::cout << "test_active_lanes_histogram passed!" << std::endl;
+}
+
+void test_stats_sampler() {
+  std::cout << "Running test_stats_sampler..." << std::endl;
+
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+  const std::string csv_name = "test_stats_samples.csv";
+  const std::string bin_name = "test_stats_samples.bin";
+
+  auto run_launch = [&](StatsSampler &sampler, int cycles) {
+    stats.reset_gpu_cycles();
+    stats.reset_gpu_instrs();
+    stats.reset_gpu_dram_accs();
+    stats.reset_gpu_retries();
+    stats.reset_gpu_stalls();
+    for (int c = 0; c < cycles; c++) {
+      stats.increment_gpu_cycles();
+      stats.increment_gpu_retries();
+      stats.set_warp_state(0, STALL_MEMORY);
+      stats.set_warp_state(1, STALL_BARRIER);
+      stats.set_warp_state(2, STALL_PIPELINE);
+      stats.set_execute_slot(2, STALL_NONE);
+      stats.tick_stall_breakdown();
+      sampler.tick(3, 7);
+    }
+    sampler.end_launch(0, 0);
+  };
+
+  {
+    StatsSampler csv_sampler(csv_name, 4, STATS_SAMPLE_CSV);
+    StatsSampler bin_sampler(bin_name, 4, STATS_SAMPLE_BINARY);
+    assert(csv_sampler.is_open() && bin_sampler.is_open());
+    // 10 cycles: two full intervals and a partial one, then a second launch
+    run_launch(csv_sampler, 10);
+    run_launch(csv_sampler, 4);
+    run_launch(bin_sampler, 10);
+    assert(csv_sampler.get_rows() == 4);
+    assert(bin_sampler.get_rows() == 3);
+  }
+
+  std::ifstream csv(csv_name);
+  std::string line;
+  std::getline(csv, line);
+  assert(line.rfind("launch,cycle,instrs,retries", 0) == 0);
+  std::getline(csv, line);
+  assert(line == "0,4,0,4,0,0,0.0000,4,0.0000,3,7,1,1");
+  std::getline(csv, line);
+  std::getline(csv, line);
+  // The partial interval is taken at the end of the launch
+  assert(line == "0,10,0,10,0,0,0.0000,2,0.0000,0,0,1,1");
+  std::getline(csv, line);
+  assert(line.rfind("1,4,", 0) == 0);
+
+  std::ifstream bin(bin_name, std::ios::binary);
+  char magic[8];
+  uint32_t columns = 0;
+  bin.read(magic, sizeof(magic));
+  bin.read(reinterpret_cast<char *>(&columns), sizeof(columns));
+  assert(memcmp(magic, STATS_BINARY_MAGIC, sizeof(magic)) == 0);
+  assert(columns == 13);
+  for (uint32_t i = 0; i < columns; i++) {
+    uint8_t len = 0;
+    bin.read(reinterpret_cast<char *>(&len), 1);
+    bin.ignore(len);
+  }
+  double row[13];
+  bin.read(reinterpret_cast<char *>(row), sizeof(row));
+  assert(row[1] == 4 && row[3] == 4 && row[9] == 3 && row[10] == 7);
+
+  stats.reset_gpu_cycles();
+  stats.reset_gpu_retries();
+  stats.reset_gpu_stalls();
+  std::remove(csv_name.c_str());
+  std::remove(bin_name.c_str());
+
+  std::cout << "test_stats_sampler passed!" << std::endl;
+}
+
+void test_launch_report() {
+  std::cout << "Running test_launch_report..." << std::endl;
+
+  GPUStatisticsManager &stats = GPUStatisticsManager::instance();
+  LaunchReport &report = LaunchReport::instance();
+  report.reset();
+  report.set_config("warp_scheduler", "baseline");
+  report.set_config("num_warps", 64);
+  std::string fingerprint = report.config_fingerprint();
+  assert(fingerprint.size() == 16);
+
+  // Two launches; each one's counters are captured before the next reset
+  report.begin_launch(0x80000100);
+  stats.reset_gpu_cycles();
+  stats.reset_gpu_retries();
+  for (int i = 0; i < 5; i++) {
+    stats.increment_gpu_cycles();
+  }
+  stats.increment_gpu_retries();
+  report.end_launch();
+
+  report.begin_launch(0x80000200);
+  stats.reset_gpu_cycles();
+  stats.reset_gpu_retries();
+  for (int i = 0; i < 3; i++) {
+    stats.increment_gpu_cycles();
+  }
+
+  const auto &launches = report.get_launches();
+  assert(launches.size() == 2);
+  assert(launches[0].kernel_pc == 0x80000100 && launches[0].cycles == 5 &&
+         launches[0].retries == 1);
+  assert(launches[1].index == 1 && launches[1].cycles == 3 && launches[1].retries == 0);
+
+  std::stringstream json;
+  report.write_json(json, "Samples/VecAdd/app.elf");
+  assert(json.str().find("\"program\": \"Samples/VecAdd/app.elf\"") != std::string::npos);
+  assert(json.str().find("\"config\": {\"warp_scheduler\": \"baseline\", \"num_warps\": 64}") !=
+         std::string::npos);
+  assert(json.str().find("\"kernel_pc\": \"0x80000200\"") != std::string::npos);
+  assert(json.str().find("\"config_fingerprint\": \"" + fingerprint + "\"") != std::string::npos);
+
+  // Any configuration change changes the fingerprint
+  report.set_config("dram_latency", 30);
+  assert(report.config_fingerprint() != fingerprint);
+
+  report.reset();
+  stats.reset_gpu_cycles();
+  stats.reset_gpu_retries();
+
+  std::cout << "test_launch_report passed!" << std::endl;
+}
+
+void test_self_profiler() {
+  std::cout << "Running test_self_profiler..." << std::endl;
+
+  SelfProfiler &profiler = SelfProfiler::instance();
+  Pipeline pipeline;
+  pipeline.add_stage<MockPipelineStage>("first");
+  pipeline.add_stage<MockPipelineStage>("second");
+  PipelineLatch latches[2] = {};
+  pipeline.get_stage(0)->set_latches(&latches[0], &latches[1]);
+  pipeline.get_stage(1)->set_latches(&latches[1], &latches[0]);
+  pipeline.set_debug(false);
+  pipeline.enable_self_profile("test");
+
+  const auto &names = profiler.get_section_names();
+  size_t first = names.size() - 2;
+  assert(names[first] == "test.MockPipelineStage");
+  assert(names[first + 1] == "test.MockPipelineStage");
+
+  profiler.enable();
+  for (int i = 0; i < 100; i++) {
+    profiler.lap(SelfProfiler::SECTION_OTHER);
+    pipeline.execute();
+    profiler.lap(SelfProfiler::SECTION_STATS);
+    profiler.count_cycle(i % 2 == 0);
+  }
+  assert(profiler.get_sim_cycles() == 100 && profiler.get_gpu_cycles() == 50);
+  assert(profiler.get_section_ns(first) > 0 && profiler.get_section_ns(first + 1) > 0);
+
+  std::stringstream report;
+  profiler.report(report, 10, 320);
+  assert(report.str().find("test.MockPipelineStage") != std::string::npos);
+  assert(report.str().find("Simulated GPU cycles: 50") != std::string::npos);
+  assert(report.str().find("GPU warp instructions: 10") != std::string::npos);
+
+  std::cout << "test_self_profiler passed!" << std::endl;
+}
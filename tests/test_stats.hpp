@@ -0,0 +1,8 @@
+#pragma once
+
+void test_pc_profiler();
+void test_stall_breakdown();
+void test_active_lanes_histogram();
+void test_stats_sampler();
+void test_launch_report();
+void test_self_profiler();
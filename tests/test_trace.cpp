@@ -0,0 +1,322 @@
+#include "test_trace.hpp"
+#include "trace/ring_buffer.hpp"
+#include "trace/trace.hpp"
+#include "trace/trace_compact.hpp"
+#include "trace/trace_compare.hpp"
+#include "trace/lz_codec.hpp"
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+static std::string read_file(const std::string &name) {
+  std::ifstream in(name);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  return ss.str();
+}
+
+void test_trace_ring_buffer() {
+  std::cout << "Running test_trace_ring_buffer..." << std::endl;
+
+  SpscRingBuffer<uint64_t, 8> ring;
+  uint64_t out[16];
+
+  assert(ring.empty());
+  assert(ring.try_pop_batch(out, 16) == 0);
+
+  // Fill to capacity, the next push must fail
+  for (uint64_t i = 0; i < 8; i++) {
+    assert(ring.try_push(i));
+  }
+  assert(!ring.try_push(8));
+
+  // Partial pop then wrap around
+  assert(ring.try_pop_batch(out, 3) == 3);
+  assert(out[0] == 0 && out[1] == 1 && out[2] == 2);
+  for (uint64_t i = 8; i < 11; i++) {
+    assert(ring.try_push(i));
+  }
+  assert(ring.try_pop_batch(out, 16) == 8);
+  for (uint64_t i = 0; i < 8; i++) {
+    assert(out[i] == i + 3);
+  }
+  assert(ring.empty());
+
+  // Ordering across a real producer/consumer pair
+  SpscRingBuffer<uint64_t, 64> shared;
+  constexpr uint64_t TOTAL = 100000;
+  std::thread consumer([&shared]() {
+    uint64_t expected = 0;
+    uint64_t buf[32];
+    while (expected < TOTAL) {
+      size_t n = shared.try_pop_batch(buf, 32);
+      for (size_t i = 0; i < n; i++) {
+        assert(buf[i] == expected);
+        expected++;
+      }
+    }
+  });
+  for (uint64_t i = 0; i < TOTAL; i++) {
+    while (!shared.try_push(i)) std::this_thread::yield();
+  }
+  consumer.join();
+
+  std::cout << "test_trace_ring_buffer passed!" << std::endl;
+}
+
+void test_trace_binary_roundtrip() {
+  std::cout << "Running test_trace_binary_roundtrip..." << std::endl;
+
+  const std::string csv_name = "test_trace_direct.csv";
+  const std::string bin_name = "test_trace.bin";
+  const std::string converted_name = "test_trace_converted.csv";
+
+  std::vector<TraceEvent> events;
+  for (int i = 0; i < 50; i++) {
+    TraceEvent event;
+    event.cycle = 100 + i;
+    event.pc = 0x80000000 + 4 * i;
+    event.warp_id = i % 64;
+    event.lane_id = (i % 3 == 0) ? -1 : i % 32;
+    event.event_type = static_cast<EventType>(i % 6);
+    // Exercise empty, partial and multi-record address payloads
+    for (int a = 0; a < (i % 11); a++) {
+      event.addrs.push_back(0x1000 + 4 * a);
+    }
+    events.push_back(event);
+  }
+
+  {
+    Tracer csv_tracer(csv_name, TRACE_CSV);
+    Tracer bin_tracer(bin_name, TRACE_BINARY);
+    for (const auto &event : events) {
+      csv_tracer.trace_event(event);
+      bin_tracer.trace_event(event);
+    }
+  }
+
+  std::string direct = read_file(csv_name);
+  assert(direct.rfind("100,0x80000000,0,-1,0\n\n", 0) == 0);
+  assert(direct.find("102,0x80000008,2,2,2\n") != std::string::npos);
+  assert(direct.find("106,0x80000018,6,-1,0\n0x00001000,0x00001004,0x00001008,"
+                     "0x0000100c,0x00001010,0x00001014,\n") != std::string::npos);
+
+  assert(convert_trace_to_csv(bin_name, converted_name));
+  assert(read_file(converted_name) == direct);
+
+  // A CSV file is not a binary trace
+  assert(!convert_trace_to_csv(csv_name, converted_name + ".bad"));
+
+  std::remove(csv_name.c_str());
+  std::remove(bin_name.c_str());
+  std::remove(converted_name.c_str());
+
+  std::cout << "test_trace_binary_roundtrip passed!" << std::endl;
+}
+
+void test_trace_lz_codec() {
+  std::cout << "Running test_trace_lz_codec..." << std::endl;
+
+  std::vector<std::vector<uint8_t>> inputs;
+  inputs.push_back({});
+  inputs.push_back({1, 2, 3});
+  // Long run (overlapping match) and a repeated pattern
+  inputs.push_back(std::vector<uint8_t>(1000, 0xAB));
+  std::vector<uint8_t> pattern;
+  for (int i = 0; i < 5000; i++) {
+    pattern.push_back(static_cast<uint8_t>((i % 37) * 7));
+  }
+  inputs.push_back(pattern);
+  // Incompressible
+  std::vector<uint8_t> noise;
+  uint32_t x = 12345;
+  for (int i = 0; i < 3000; i++) {
+    x = x * 1103515245 + 12345;
+    noise.push_back(static_cast<uint8_t>(x >> 16));
+  }
+  inputs.push_back(noise);
+
+  for (const auto &input : inputs) {
+    std::vector<uint8_t> packed, unpacked;
+    lz_compress(input.data(), input.size(), packed);
+    assert(lz_decompress(packed.data(), packed.size(), input.size(), unpacked));
+    assert(unpacked == input);
+  }
+
+  std::vector<uint8_t> packed, unpacked;
+  lz_compress(pattern.data(), pattern.size(), packed);
+  assert(packed.size() < pattern.size() / 10);
+  // Truncated input must be rejected
+  assert(!lz_decompress(packed.data(), packed.size() / 2, pattern.size(), unpacked));
+
+  std::cout << "test_trace_lz_codec passed!" << std::endl;
+}
+
+void test_trace_compact_roundtrip() {
+  std::cout << "Running test_trace_compact_roundtrip..." << std::endl;
+
+  const std::string csv_name = "test_trace_compact_direct.csv";
+  const std::string compact_name = "test_trace.rvgz";
+  const std::string converted_name = "test_trace_compact_converted.csv";
+
+  // Enough events to span several blocks, with instruction, memory and DRAM rows
+  const size_t total = CompactTraceWriter::EVENTS_PER_BLOCK * 2 + 1000;
+  {
+    Tracer csv_tracer(csv_name, TRACE_CSV);
+    Tracer compact_tracer(compact_name, TRACE_COMPACT);
+    for (size_t i = 0; i < total; i++) {
+      TraceEvent event;
+      event.cycle = i / 2;
+      event.warp_id = i % 64;
+      event.lane_id = (i % 5 == 0) ? -1 : static_cast<int>(i % 32);
+      if (i % 7 == 0) {
+        event.event_type = DRAM_ACCESS;
+        event.pc = (0x80000000 + 64 * i) >> 5;
+        event.access_type = "LSAF"[i % 4];
+        event.beats = 1 + i % 8;
+        event.groups = 1 + i % 3;
+        event.is_sram = i % 2;
+      } else {
+        event.event_type = static_cast<EventType>(i % 6);
+        event.pc = 0x80000000 + 4 * (i % 300);
+        for (size_t a = 0; a < i % 9; a++) {
+          event.addrs.push_back(0x90000000 + 4 * a + 128 * (i % 13));
+        }
+      }
+      csv_tracer.trace_event(event);
+      compact_tracer.trace_event(event);
+    }
+  }
+
+  std::string direct = read_file(csv_name);
+  assert(convert_trace_to_csv(compact_name, converted_name));
+  assert(read_file(converted_name) == direct);
+
+  CompactTraceReader reader;
+  assert(reader.open(compact_name));
+  assert(reader.blocks().size() == 3);
+
+  // A window inside the second block only decodes that block
+  uint64_t from = reader.blocks()[1].min_cycle + 10;
+  uint64_t to = from + 20;
+  size_t seen = 0;
+  assert(reader.read_window(from, to, [&](const TraceEvent &event) {
+    assert(event.cycle >= from && event.cycle <= to);
+    if (event.event_type == DRAM_ACCESS) {
+      assert(event.beats >= 1 && event.groups >= 1);
+    }
+    seen++;
+  }));
+  assert(seen == 2 * (to - from + 1));
+
+  // Other trace formats are not compact traces
+  CompactTraceReader not_compact;
+  assert(!not_compact.open(csv_name));
+
+  std::remove(csv_name.c_str());
+  std::remove(compact_name.c_str());
+  std::remove(converted_name.c_str());
+
+  std::cout << "test_trace_compact_roundtrip passed!" << std::endl;
+}
+
+void test_trace_compare() {
+  std::cout << "Running test_trace_compare..." << std::endl;
+
+  const std::string ref_name = "test_trace_reference.csv";
+
+  // SIMTight-style reference: TRACE: prefix, one event per warp
+  {
+    std::ofstream ref(ref_name);
+    ref << "some unrelated log line\n";
+    for (int i = 0; i < 20; i++) {
+      ref << "TRACE:" << 10 + i << ",0x" << std::hex << 0x80000000 + 4 * i << std::dec << ","
+          << i % 4 << ",-1,2\n";
+      if (i % 5 == 0) {
+        ref << "TRACE:" << 10 + i << ",0x80000000," << i % 4 << ",-1,4\n";
+      }
+    }
+  }
+
+  auto make_exec = [](int i, int lane) {
+    TraceEvent event;
+    event.cycle = 12 + i;
+    event.pc = 0x80000000 + 4 * i;
+    event.warp_id = i % 4;
+    event.lane_id = lane;
+    event.event_type = INSTR_EXEC;
+    return event;
+  };
+
+  // Per-lane events from our side reduce to lane 0, so a full match streams through
+  {
+    TraceComparator comparator;
+    assert(comparator.open(ref_name));
+    {
+      Tracer tracer("", TRACE_CSV, &comparator);
+      for (int i = 0; i < 20; i++) {
+        for (int lane = 0; lane < 4; lane++) {
+          tracer.trace_event(make_exec(i, lane));
+        }
+      }
+    }
+    assert(!comparator.diverged());
+    assert(comparator.matched_events() == 20);
+  }
+
+  // A wrong PC is reported at the right position with bounded context
+  {
+    TraceCompareOptions options;
+    options.context = 3;
+    TraceComparator comparator(options);
+    assert(comparator.open(ref_name));
+    for (int i = 0; i < 20; i++) {
+      TraceEvent event = make_exec(i, 0);
+      if (i == 7) event.pc += 4;
+      comparator.add(event);
+    }
+    comparator.finish();
+    assert(comparator.diverged());
+    assert(comparator.matched_events() == 7);
+
+    std::stringstream report;
+    comparator.report(report);
+    assert(report.str().find("First divergence at compared event #7") != std::string::npos);
+    assert(report.str().find("-> Different PCs") != std::string::npos);
+  }
+
+  // Cycle checking, other event types, and our trace ending early
+  {
+    TraceCompareOptions options;
+    options.compare_cycles = true;
+    TraceComparator comparator(options);
+    assert(comparator.open(ref_name));
+    comparator.add(make_exec(0, 0));
+    assert(comparator.diverged());
+  }
+  {
+    TraceCompareOptions options;
+    options.all_events = true;
+    TraceComparator comparator(options);
+    assert(comparator.open(ref_name));
+    // The reference has a WARP_SUSPEND after the first instruction
+    comparator.add(make_exec(0, -1));
+    assert(!comparator.diverged());
+    comparator.add(make_exec(1, -1));
+    assert(comparator.diverged());
+  }
+  {
+    TraceComparator comparator;
+    assert(comparator.open(ref_name));
+    comparator.add(make_exec(0, 0));
+    comparator.finish();
+    assert(comparator.diverged() && comparator.matched_events() == 1);
+  }
+
+  std::remove(ref_name.c_str());
+
+  std::cout << "test_trace_compare passed!" << std::endl;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+void test_trace_ring_buffer();
+void test_trace_binary_roundtrip();
+void test_trace_lz_codec();
+void test_trace_compact_roundtrip();
+void test_trace_compare();
@@ -3,6 +3,8 @@
 #include "test_pipeline.hpp"
 #include "test_pipeline_execute.hpp"
 #include "test_pipeline_scheduler.hpp"
+#include "test_stats.hpp"
+#include "test_trace.hpp"
 #include "llvm/Support/TargetSelect.h"
 #include <iostream>
 
@@ -18,16 +20,44 @@ int main() {
   test_data_memory_load_store();
   test_instr_memory();
   test_coalesce_latency();
+  test_l1_cache();
+  test_l1_cache_latency();
+  test_banked_dram();
+  test_load_scoreboard();
+  test_atomic_combining();
+  test_write_combining();
+  test_sram_banks();
 
   test_host_register_file();
+  test_register_shapes();
   test_host_gpu_control();
+  test_launch_queue();
+  test_block_dispatch();
 
   test_instr_fetch_latch();
   test_ats_latch();
   test_op_fetch_latch();
   test_writeback_latch();
+  test_ipdom_reconvergence();
   test_warp_scheduler();
+  test_random_scheduler_seed();
+  test_warp_policies();
   test_execution_unit();
+  test_fpu_execution();
+  test_bitmanip_execution();
+
+  test_trace_ring_buffer();
+  test_trace_binary_roundtrip();
+  test_trace_lz_codec();
+  test_trace_compact_roundtrip();
+  test_trace_compare();
+
+  test_pc_profiler();
+  test_stall_breakdown();
+  test_active_lanes_histogram();
+  test_stats_sampler();
+  test_launch_report();
+  test_self_profiler();
 
   std::cout << "All tests passed!" << std::endl;
   return 0;
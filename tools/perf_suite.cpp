@@ -0,0 +1,422 @@
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "disassembler/llvm_disasm.hpp"
+#include "host/host_register_file.hpp"
+#include "gpu/pipeline_execute.hpp"
+#include "mem/mem_coalesce.hpp"
+#include "mem/mem_data.hpp"
+#include "mem/mem_instr.hpp"
+#include "stats/launch_report.hpp"
+#include "simulator.hpp"
+#include "llvm/Support/TargetSelect.h"
+
+/*
+ * End-to-end performance regression suite.
+ *
+ * Runs every Samples/ and InHouse/ app.elf through the simulator core and
+ * compares simulated cycles, instructions and DRAM accesses (fidelity)
+ * and wall time and peak RSS (simulator performance) against a checked-in
+ * baseline with per-metric tolerances. Each app runs in a forked child of
+ * this process, so one app's state cannot leak into the next and the
+ * child's peak RSS is its own.
+ */
+
+struct AppResult {
+  uint64_t cycles = 0;
+  uint64_t instrs = 0;
+  uint64_t dram_accs = 0;
+  uint64_t launches = 0;
+  bool self_test_passed = false;
+  double wall_time_ms = 0.0;
+  uint64_t peak_rss_kb = 0;
+  bool ok = false;
+};
+
+struct Tolerances {
+  // Allowed relative increase (or, for the fidelity metrics, change) in percent
+  double cycles_pct = 0.5;
+  double instrs_pct = 0.0;
+  double dram_accs_pct = 0.5;
+  double wall_time_pct = 25.0;
+  double peak_rss_pct = 25.0;
+};
+
+struct Baseline {
+  Tolerances tolerances;
+  std::map<std::string, AppResult> apps;
+};
+
+/*
+ * Just enough JSON for the baseline file: objects, strings and numbers.
+ * Calls leaf(path, number) for every numeric value.
+ */
+class JsonReader {
+public:
+  using Leaf = std::function<void(const std::vector<std::string> &, double)>;
+
+  JsonReader(const std::string &text, Leaf leaf) : text(text), leaf(std::move(leaf)) {}
+
+  bool parse() {
+    std::vector<std::string> path;
+    return value(path) && (skip_ws(), pos == text.size());
+  }
+
+private:
+  void skip_ws() {
+    while (pos < text.size() && isspace(static_cast<unsigned char>(text[pos]))) pos++;
+  }
+
+  bool string(std::string &out) {
+    skip_ws();
+    if (pos >= text.size() || text[pos] != '"') return false;
+    pos++;
+    while (pos < text.size() && text[pos] != '"') {
+      if (text[pos] == '\\' && pos + 1 < text.size()) pos++;
+      out += text[pos++];
+    }
+    return pos++ < text.size();
+  }
+
+  bool value(std::vector<std::string> &path) {
+    skip_ws();
+    if (pos >= text.size()) return false;
+    if (text[pos] == '{') {
+      pos++;
+      skip_ws();
+      if (pos < text.size() && text[pos] == '}') return ++pos, true;
+      while (true) {
+        std::string key;
+        if (!string(key)) return false;
+        skip_ws();
+        if (pos >= text.size() || text[pos++] != ':') return false;
+        path.push_back(key);
+        if (!value(path)) return false;
+        path.pop_back();
+        skip_ws();
+        if (pos < text.size() && text[pos] == ',') {
+          pos++;
+          continue;
+        }
+        return pos < text.size() && text[pos++] == '}';
+      }
+    }
+    if (text[pos] == '"') {
+      std::string ignored;
+      return string(ignored);
+    }
+    if (text.compare(pos, 4, "true") == 0 || text.compare(pos, 4, "null") == 0) {
+      pos += 4;
+      return true;
+    }
+    if (text.compare(pos, 5, "false") == 0) {
+      pos += 5;
+      return true;
+    }
+    char *end = nullptr;
+    double number = strtod(text.c_str() + pos, &end);
+    if (end == text.c_str() + pos) return false;
+    pos = end - text.c_str();
+    leaf(path, number);
+    return true;
+  }
+
+  const std::string &text;
+  Leaf leaf;
+  size_t pos = 0;
+};
+
+static bool read_baseline(const std::string &file, Baseline &baseline) {
+  std::ifstream in(file);
+  if (!in) return false;
+  std::stringstream ss;
+  ss << in.rdbuf();
+  std::string text = ss.str();
+
+  std::map<std::string, double *> tolerance_fields = {
+      {"cycles_pct", &baseline.tolerances.cycles_pct},
+      {"instrs_pct", &baseline.tolerances.instrs_pct},
+      {"dram_accs_pct", &baseline.tolerances.dram_accs_pct},
+      {"wall_time_pct", &baseline.tolerances.wall_time_pct},
+      {"peak_rss_pct", &baseline.tolerances.peak_rss_pct},
+  };
+  JsonReader reader(text, [&](const std::vector<std::string> &path, double number) {
+    if (path.size() == 2 && path[0] == "tolerances" && tolerance_fields.count(path[1])) {
+      *tolerance_fields[path[1]] = number;
+    } else if (path.size() == 3 && path[0] == "apps") {
+      AppResult &app = baseline.apps[path[1]];
+      app.ok = true;
+      const std::string &field = path[2];
+      if (field == "cycles") app.cycles = static_cast<uint64_t>(number);
+      if (field == "instrs") app.instrs = static_cast<uint64_t>(number);
+      if (field == "dram_accs") app.dram_accs = static_cast<uint64_t>(number);
+      if (field == "launches") app.launches = static_cast<uint64_t>(number);
+      if (field == "wall_time_ms") app.wall_time_ms = number;
+      if (field == "peak_rss_kb") app.peak_rss_kb = static_cast<uint64_t>(number);
+      if (field == "self_test_passed") app.self_test_passed = number != 0;
+    }
+  });
+  if (!reader.parse()) {
+    std::cout << "Malformed baseline " << file << std::endl;
+    return false;
+  }
+  return true;
+}
+
+static void write_results(std::ostream &out, const Tolerances &tolerances,
+                          const std::map<std::string, AppResult> &results) {
+  char buf[256];
+  out << "{\n";
+  snprintf(buf, sizeof(buf),
+           "  \"tolerances\": {\"cycles_pct\": %g, \"instrs_pct\": %g, \"dram_accs_pct\": %g, "
+           "\"wall_time_pct\": %g, \"peak_rss_pct\": %g},\n",
+           tolerances.cycles_pct, tolerances.instrs_pct, tolerances.dram_accs_pct,
+           tolerances.wall_time_pct, tolerances.peak_rss_pct);
+  out << buf;
+  out << "  \"apps\": {";
+  bool first = true;
+  for (const auto &[name, r] : results) {
+    if (!r.ok) continue;
+    snprintf(buf, sizeof(buf),
+             "%s\n    \"%s\": {\"cycles\": %llu, \"instrs\": %llu, \"dram_accs\": %llu, "
+             "\"launches\": %llu, \"self_test_passed\": %d, \"wall_time_ms\": %.0f, "
+             "\"peak_rss_kb\": %llu}",
+             first ? "" : ",", name.c_str(), static_cast<unsigned long long>(r.cycles),
+             static_cast<unsigned long long>(r.instrs),
+             static_cast<unsigned long long>(r.dram_accs),
+             static_cast<unsigned long long>(r.launches), r.self_test_passed ? 1 : 0,
+             r.wall_time_ms, static_cast<unsigned long long>(r.peak_rss_kb));
+    out << buf;
+    first = false;
+  }
+  out << "\n  }\n}\n";
+}
+
+/*
+ * Runs one app to completion in this process; called in the forked child
+ */
+static bool simulate(const std::string &elf, AppResult &result) {
+  LLVMInitializeRISCVTargetInfo();
+  LLVMInitializeRISCVTargetMC();
+  LLVMInitializeRISCVDisassembler();
+  Config::instance().setStatsOnly(true);
+
+  LLVMDisassembler disasm("riscv64-unknown-elf", "generic-rv64", "+m,+a,+zfinx,+zbb");
+  parse_output out;
+  if (parse_binary(elf, disasm, &out) != PARSE_SUCCESS) {
+    return false;
+  }
+  InstructionMemory tcim(&out);
+  DataMemory scratchpad_mem;
+  load_data_sections(out, &scratchpad_mem);
+
+  CoalescingUnit cu(&scratchpad_mem);
+  RegisterFile rf(NUM_REGISTERS, NUM_LANES);
+  HostRegisterFile hrf(&rf, NUM_REGISTERS);
+  HostGPUControl gpu_controller;
+  Pipeline *gpu_pipeline = initialize_pipeline(&tcim, &cu, &rf, &disasm, &gpu_controller, false);
+  Pipeline *cpu_pipeline = initialize_pipeline(&tcim, &cu, &hrf, &disasm, &gpu_controller, true);
+  gpu_pipeline->set_debug(false);
+  cpu_pipeline->set_debug(false);
+  connect_gpu_controller(&gpu_controller, gpu_pipeline, &cu);
+
+  SimulationHooks hooks;
+  hooks.launch_report = &LaunchReport::instance();
+  run_simulation(cpu_pipeline, gpu_pipeline, cu, &gpu_controller, hooks);
+
+  for (const LaunchRecord &launch : LaunchReport::instance().get_launches()) {
+    result.cycles += launch.cycles;
+    result.instrs += launch.instrs;
+    result.dram_accs += launch.dram_accs;
+    result.launches++;
+  }
+  std::string output = gpu_controller.get_buffer();
+  result.self_test_passed = output.find("PASSED") != std::string::npos &&
+                            output.find("FAILED") == std::string::npos;
+
+  delete cpu_pipeline;
+  delete gpu_pipeline;
+  return true;
+}
+
+static AppResult run_app(const std::string &elf) {
+  AppResult result;
+  int fds[2];
+  if (pipe(fds) != 0) return result;
+
+  auto start = std::chrono::steady_clock::now();
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+    AppResult child;
+    child.ok = simulate(elf, child);
+    ssize_t written = write(fds[1], &child, sizeof(child));
+    _exit(written == sizeof(child) ? 0 : 1);
+  }
+  close(fds[1]);
+  if (pid < 0) {
+    close(fds[0]);
+    return result;
+  }
+
+  AppResult child;
+  ssize_t got = read(fds[0], &child, sizeof(child));
+  close(fds[0]);
+  int status = 0;
+  struct rusage usage;
+  wait4(pid, &status, 0, &usage);
+  double wall_ms =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  if (got == sizeof(child) && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+    result = child;
+    result.wall_time_ms = wall_ms;
+    result.peak_rss_kb = usage.ru_maxrss;  // KiB on Linux
+  }
+  return result;
+}
+
+static std::vector<std::string> find_apps(const std::string &root) {
+  namespace fs = std::filesystem;
+  std::vector<std::string> apps;
+  for (const char *dir : {"Samples", "InHouse"}) {
+    fs::path base = fs::path(root) / dir;
+    if (!fs::is_directory(base)) continue;
+    for (const auto &entry : fs::directory_iterator(base)) {
+      if (fs::exists(entry.path() / "app.elf")) {
+        apps.push_back(std::string(dir) + "/" + entry.path().filename().string());
+      }
+    }
+  }
+  std::sort(apps.begin(), apps.end());
+  return apps;
+}
+
+static double change_pct(double now, double base) {
+  return base != 0 ? (now - base) / base * 100.0 : (now != 0 ? 100.0 : 0.0);
+}
+
+static void usage() {
+  std::cout << "Usage: perf_suite [options] [filter]" << std::endl;
+  std::cout << "  --root <dir>          Directory containing Samples/ and InHouse/ (default .)" << std::endl;
+  std::cout << "  --baseline <file>     Baseline to compare against (default perf/baseline.json)" << std::endl;
+  std::cout << "  --json <file>         Also write this run's results as a baseline file" << std::endl;
+  std::cout << "  --update-baseline     Rewrite the baseline with this run's results" << std::endl;
+  std::cout << "  --timing              Also fail on wall time and peak RSS regressions (host-dependent)" << std::endl;
+}
+
+int main(int argc, char **argv) {
+  std::string root = ".";
+  std::string baseline_file = "perf/baseline.json";
+  std::string json_file;
+  std::string filter;
+  bool update_baseline = false;
+  bool check_timing = false;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--root" && i + 1 < argc) {
+      root = argv[++i];
+    } else if (arg == "--baseline" && i + 1 < argc) {
+      baseline_file = argv[++i];
+    } else if (arg == "--json" && i + 1 < argc) {
+      json_file = argv[++i];
+    } else if (arg == "--update-baseline") {
+      update_baseline = true;
+    } else if (arg == "--timing") {
+      check_timing = true;
+    } else if (arg == "-h" || arg == "--help") {
+      usage();
+      return 0;
+    } else {
+      filter = arg;
+    }
+  }
+
+  Baseline baseline;
+  bool have_baseline = read_baseline(baseline_file, baseline);
+  if (!have_baseline && !update_baseline) {
+    std::cout << "No baseline at " << baseline_file << ", only reporting results" << std::endl;
+  }
+  const Tolerances &tol = baseline.tolerances;
+
+  std::map<std::string, AppResult> results = update_baseline ? baseline.apps
+                                                             : std::map<std::string, AppResult>{};
+  int fidelity_regressions = 0;
+  int perf_regressions = 0;
+  int failures = 0;
+
+  printf("%-28s %10s %8s %12s %8s %8s %10s %8s %10s %8s  %s\n", "App", "Cycles", "Cyc%",
+         "Instrs", "Ins%", "DRAM%", "Wall ms", "Wall%", "RSS KiB", "RSS%", "Status");
+  for (const std::string &app : find_apps(root)) {
+    if (!filter.empty() && app.find(filter) == std::string::npos) continue;
+
+    AppResult r = run_app(root + "/" + app + "/app.elf");
+    if (!r.ok) {
+      printf("%-28s %s\n", app.c_str(), "FAILED TO RUN");
+      failures++;
+      continue;
+    }
+    results[app] = r;
+
+    auto it = baseline.apps.find(app);
+    std::string status;
+    double cyc = 0, ins = 0, dram = 0, wall = 0, rss = 0;
+    if (it == baseline.apps.end()) {
+      status = "new";
+    } else {
+      const AppResult &b = it->second;
+      cyc = change_pct(r.cycles, b.cycles);
+      ins = change_pct(r.instrs, b.instrs);
+      dram = change_pct(r.dram_accs, b.dram_accs);
+      wall = change_pct(r.wall_time_ms, b.wall_time_ms);
+      rss = change_pct(r.peak_rss_kb, b.peak_rss_kb);
+      if (std::fabs(cyc) > tol.cycles_pct || std::fabs(ins) > tol.instrs_pct ||
+          std::fabs(dram) > tol.dram_accs_pct || r.launches != b.launches ||
+          (b.self_test_passed && !r.self_test_passed)) {
+        status += "FIDELITY ";
+        fidelity_regressions++;
+      }
+      if (check_timing && (wall > tol.wall_time_pct || rss > tol.peak_rss_pct)) {
+        status += wall > tol.wall_time_pct ? "SLOWER " : "";
+        status += rss > tol.peak_rss_pct ? "MEMORY " : "";
+        perf_regressions++;
+      }
+      if (status.empty()) status = "ok";
+    }
+    if (!r.self_test_passed) status += " (self test failed)";
+
+    printf("%-28s %10llu %+7.2f%% %12llu %+7.2f%% %+7.2f%% %10.0f %+7.1f%% %10llu %+7.1f%%  %s\n",
+           app.c_str(), static_cast<unsigned long long>(r.cycles), cyc,
+           static_cast<unsigned long long>(r.instrs), ins, dram, r.wall_time_ms, wall,
+           static_cast<unsigned long long>(r.peak_rss_kb), rss, status.c_str());
+    fflush(stdout);
+  }
+
+  printf("\n%d fidelity regression(s), %d performance regression(s), %d failure(s)\n",
+         fidelity_regressions, perf_regressions, failures);
+
+  if (!json_file.empty()) {
+    std::ofstream out(json_file);
+    write_results(out, tol, results);
+  }
+  if (update_baseline) {
+    std::ofstream out(baseline_file);
+    write_results(out, tol, results);
+    std::cout << "Updated " << baseline_file << std::endl;
+    return failures ? 1 : 0;
+  }
+  return (fidelity_regressions || perf_regressions || failures) ? 1 : 0;
+}
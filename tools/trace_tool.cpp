@@ -0,0 +1,91 @@
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include "trace/trace.hpp"
+#include "trace/trace_compact.hpp"
+
+/*
+ * Offline utilities for traces written by the simulator
+ */
+static void usage() {
+  std::cout << "Usage:" << std::endl;
+  std::cout << "  trace_tool csv <trace> <trace.csv>            Convert a binary or compact trace to CSV" << std::endl;
+  std::cout << "  trace_tool window <trace> <from> <to> [out]   Dump events in cycles [from, to] of a compact trace as CSV" << std::endl;
+  std::cout << "  trace_tool info <trace>                       Print the block index of a compact trace" << std::endl;
+}
+
+static int window(const std::string &in_file, uint64_t from, uint64_t to, const std::string &out_file) {
+  CompactTraceReader reader;
+  if (!reader.open(in_file)) {
+    std::cout << "Failed to open " << in_file << " (not a compact trace?)" << std::endl;
+    return 1;
+  }
+
+  std::ofstream out_stream;
+  if (!out_file.empty()) {
+    out_stream.open(out_file);
+  }
+  std::ostream &out = out_file.empty() ? std::cout : out_stream;
+
+  TraceCsvFormatter formatter;
+  std::string text;
+  bool ok = reader.read_window(from, to, [&](const TraceEvent &event) {
+    formatter.format(event, text);
+    out << text;
+    text.clear();
+  });
+  if (!ok) {
+    std::cout << "Corrupt block in " << in_file << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+static int info(const std::string &in_file) {
+  CompactTraceReader reader;
+  if (!reader.open(in_file)) {
+    std::cout << "Failed to open " << in_file << " (not a compact trace?)" << std::endl;
+    return 1;
+  }
+
+  uint64_t events = 0, stored = 0, raw = 0;
+  std::cout << "block,offset,min_cycle,max_cycle,events,stored_bytes,raw_bytes" << std::endl;
+  for (size_t i = 0; i < reader.blocks().size(); i++) {
+    const CompactBlockInfo &block = reader.blocks()[i];
+    std::cout << i << "," << block.offset << "," << block.min_cycle << "," << block.max_cycle << ","
+              << block.event_count << "," << block.stored_size << "," << block.raw_size << std::endl;
+    events += block.event_count;
+    stored += block.stored_size;
+    raw += block.raw_size;
+  }
+  std::cout << "Total: " << events << " events, " << stored << " bytes stored ("
+            << (events ? static_cast<double>(stored) / events : 0.0) << " bytes/event, "
+            << (stored ? static_cast<double>(raw) / stored : 0.0) << "x block compression)" << std::endl;
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    usage();
+    return 1;
+  }
+
+  std::string command = argv[1];
+  if (command == "csv" && argc == 4) {
+    if (!convert_trace_to_csv(argv[2], argv[3])) {
+      std::cout << "Failed to convert " << argv[2] << " (not a binary or compact trace?)" << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+  if (command == "window" && (argc == 5 || argc == 6)) {
+    return window(argv[2], std::stoull(argv[3], nullptr, 0), std::stoull(argv[4], nullptr, 0),
+                  argc == 6 ? argv[5] : "");
+  }
+  if (command == "info" && argc == 3) {
+    return info(argv[2]);
+  }
+
+  usage();
+  return 1;
+}